@@ -0,0 +1,56 @@
+// test UDP send throughput of send() versus sendBatch()
+'use strict';
+
+const common = require('../common.js');
+const dgram = require('dgram');
+const PORT = common.PORT;
+
+// `num` is the number of datagrams to queue up each time, either as separate
+// send() calls or as a single sendBatch() call.
+const bench = common.createBenchmark(main, {
+  len: [64, 256, 1024],
+  num: [16, 64],
+  method: ['send', 'sendBatch'],
+  dur: [5]
+});
+
+function main({ dur, len, num, method }) {
+  const chunk = Buffer.allocUnsafe(len);
+  const messages = [];
+  for (var i = 0; i < num; i++)
+    messages.push({ msg: chunk, port: PORT, address: '127.0.0.1' });
+
+  var sent = 0;
+  const socket = dgram.createSocket('udp4');
+
+  function onsend() {
+    if (sent++ % num === 0) {
+      for (var i = 0; i < num; i++) {
+        socket.send(chunk, PORT, '127.0.0.1', onsend);
+      }
+    }
+  }
+
+  function onsendbatch(err) {
+    if (err)
+      throw err;
+    sent += num;
+    socket.sendBatch(messages, onsendbatch);
+  }
+
+  socket.on('listening', function() {
+    bench.start();
+    if (method === 'send')
+      onsend();
+    else
+      socket.sendBatch(messages, onsendbatch);
+
+    setTimeout(function() {
+      const gbits = (sent * chunk.length * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+      process.exit(0);
+    }, dur * 1000);
+  });
+
+  socket.bind(PORT);
+}
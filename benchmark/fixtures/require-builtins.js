@@ -0,0 +1,19 @@
+'use strict';
+// Requires every public built-in module that has not been loaded during
+// startup and prints how many there were and how many nanoseconds it took.
+
+const { builtinModules } = require('module');
+
+const ids = builtinModules.filter((id) => !id.includes('/') &&
+                                          !process.moduleLoadList.includes(
+                                            `NativeModule ${id}`));
+const start = process.hrtime();
+for (const id of ids) {
+  try {
+    require(id);
+  } catch (err) {
+    // e.g. inspector when node was built without it.
+  }
+}
+const [seconds, nanoseconds] = process.hrtime(start);
+console.log(`${ids.length} ${seconds * 1e9 + nanoseconds}`);
@@ -13,15 +13,19 @@ const assert = require('assert');
 const bench = common.createBenchmark(main, {
   dur: [5],
   len: [1024, 16 * 1024 * 1024],
-  concurrent: [1, 10]
+  concurrent: [1, 10],
+  encoding: ['buffer', 'utf8']
 });
 
-function main({ len, dur, concurrent }) {
+function main({ len, dur, concurrent, encoding }) {
   try { fs.unlinkSync(filename); } catch (e) {}
   var data = Buffer.alloc(len, 'x');
   fs.writeFileSync(filename, data);
   data = null;
 
+  if (encoding === 'buffer')
+    encoding = undefined;
+
   var reads = 0;
   var benchEnded = false;
   bench.start();
@@ -33,7 +37,7 @@ function main({ len, dur, concurrent }) {
   }, dur * 1000);
 
   function read() {
-    fs.readFile(filename, afterRead);
+    fs.readFile(filename, encoding, afterRead);
   }
 
   function afterRead(er, data) {
@@ -0,0 +1,87 @@
+'use strict';
+
+const common = require('../common');
+const fs = require('fs');
+const path = require('path');
+
+const root = path.resolve(__dirname, '../../lib/');
+
+const bench = common.createBenchmark(main, {
+  method: ['walk', 'walk-stats', 'readdir-lstat', 'readdir-types'],
+  n: [100]
+});
+
+// Recursive readdir() with an lstat() per entry.
+function readdirLstat(dir, callback) {
+  fs.readdir(dir, (err, names) => {
+    if (err) throw err;
+    let pending = names.length + 1;
+    const done = () => {
+      if (--pending === 0)
+        callback();
+    };
+    for (const name of names) {
+      const file = path.join(dir, name);
+      fs.lstat(file, (err, stats) => {
+        if (err) throw err;
+        if (stats.isDirectory())
+          readdirLstat(file, done);
+        else
+          done();
+      });
+    }
+    done();
+  });
+}
+
+// Recursive readdir() with `withFileTypes`.
+function readdirTypes(dir, callback) {
+  fs.readdir(dir, { withFileTypes: true }, (err, entries) => {
+    if (err) throw err;
+    let pending = 1;
+    const done = () => {
+      if (--pending === 0)
+        callback();
+    };
+    for (const entry of entries) {
+      if (entry.isDirectory()) {
+        pending++;
+        readdirTypes(path.join(dir, entry.name), done);
+      }
+    }
+    done();
+  });
+}
+
+function walk(stats, callback) {
+  fs.walk(root, { stats })
+    .on('data', () => {})
+    .on('end', callback);
+}
+
+function main({ method, n }) {
+  let run;
+  switch (method) {
+    case 'walk':
+      run = (callback) => walk(false, callback);
+      break;
+    case 'walk-stats':
+      run = (callback) => walk(true, callback);
+      break;
+    case 'readdir-lstat':
+      run = (callback) => readdirLstat(root, callback);
+      break;
+    case 'readdir-types':
+      run = (callback) => readdirTypes(root, callback);
+      break;
+    default:
+      throw new Error(`Unexpected method "${method}"`);
+  }
+
+  bench.start();
+  (function next(i) {
+    if (i === n)
+      return bench.end(n);
+    run(() => next(i + 1));
+  })(0);
+}
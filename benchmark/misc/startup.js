@@ -3,12 +3,27 @@ const common = require('../common.js');
 const spawn = require('child_process').spawn;
 const path = require('path');
 const emptyJsFile = path.resolve(__dirname, '../../test/fixtures/semicolon.js');
+const requireBuiltinsFile =
+  path.resolve(__dirname, '../fixtures/require-builtins.js');
 
-const bench = common.createBenchmark(startNode, {
+// mode=process measures how many processes start and exit per second.
+// mode=require measures how many built-in modules are required per second
+// of the time that the require() calls take in a new process.
+const bench = common.createBenchmark(main, {
+  mode: ['process', 'require'],
+  snapshot: ['true', 'false'],
   dur: [1]
 });
 
-function startNode({ dur }) {
+function main({ mode, snapshot, dur }) {
+  const execArgv = snapshot === 'true' ? [] : ['--no-node-snapshot'];
+  if (mode === 'process')
+    startNode(execArgv, dur);
+  else
+    requireBuiltins(execArgv, dur);
+}
+
+function startNode(execArgv, dur) {
   var go = true;
   var starts = 0;
 
@@ -20,7 +35,8 @@ function startNode({ dur }) {
   start();
 
   function start() {
-    const node = spawn(process.execPath || process.argv[0], [emptyJsFile]);
+    const node = spawn(process.execPath || process.argv[0],
+                       execArgv.concat([emptyJsFile]));
     node.on('exit', function(exitCode) {
       if (exitCode !== 0) {
         throw new Error('Error during node startup');
@@ -34,3 +50,36 @@ function startNode({ dur }) {
     });
   }
 }
+
+function requireBuiltins(execArgv, dur) {
+  const end = Date.now() + dur * 1000;
+  var modules = 0;
+  var time = 0;
+
+  start();
+
+  function start() {
+    const node = spawn(process.execPath || process.argv[0],
+                       execArgv.concat([requireBuiltinsFile]),
+                       { stdio: ['ignore', 'pipe', 'ignore'] });
+    var out = '';
+    node.stdout.setEncoding('utf8');
+    node.stdout.on('data', (chunk) => out += chunk);
+    node.on('exit', function(exitCode) {
+      if (exitCode !== 0) {
+        throw new Error('Error during node startup');
+      }
+      const [count, ns] = out.trim().split(' ').map(Number);
+      modules += count;
+      time += ns;
+
+      if (Date.now() < end) {
+        start();
+      } else {
+        const seconds = time / 1e9;
+        bench.report(modules / seconds,
+                     [Math.floor(seconds), Math.round(time % 1e9)]);
+      }
+    });
+  }
+}
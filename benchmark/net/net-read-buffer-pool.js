@@ -0,0 +1,61 @@
+// Measure how fast many sockets can deliver small reads to JS, with and
+// without the per-Environment read buffer pool.
+'use strict';
+
+const common = require('../common.js');
+const net = require('net');
+const PORT = common.PORT;
+
+const bench = common.createBenchmark(main, {
+  pool: ['true', 'false'],
+  conns: [1, 100],
+  len: [64, 1024],
+  dur: [5]
+});
+
+const streamWrap = process.binding('stream_wrap');
+
+function main({ pool, conns, len, dur }) {
+  streamWrap.setReadBufferPoolEnabled(pool === 'true');
+
+  const chunk = Buffer.alloc(len, 'x');
+  const clients = [];
+  var reads = 0;
+  var connected = 0;
+
+  const server = net.createServer(function(socket) {
+    socket.on('data', function() {
+      reads++;
+    });
+  });
+
+  server.listen(PORT, function() {
+    for (var i = 0; i < conns; i++) {
+      const socket = net.connect(PORT, onConnect);
+      socket.setNoDelay(true);
+      clients.push(socket);
+    }
+  });
+
+  function onConnect() {
+    if (++connected !== conns)
+      return;
+
+    bench.start();
+    for (const socket of clients)
+      write(socket);
+
+    setTimeout(function() {
+      bench.end(reads);
+      process.exit(0);
+    }, dur * 1000);
+  }
+
+  function write(socket) {
+    // Keep each socket busy with one small write at a time so that every
+    // write turns into (at least) one read on the server side.
+    socket.write(chunk, function() {
+      write(socket);
+    });
+  }
+}
@@ -0,0 +1,56 @@
+// Measure how fast a file can be served over a socket with socket.sendFile()
+// compared to piping an fs.ReadStream into it.
+'use strict';
+
+const common = require('../common.js');
+const fs = require('fs');
+const net = require('net');
+const path = require('path');
+const PORT = common.PORT;
+
+const filename = path.resolve(process.env.NODE_TMPDIR || __dirname,
+                              `.removeme-benchmark-garbage-${process.pid}`);
+
+const bench = common.createBenchmark(main, {
+  method: ['sendFile', 'pipe'],
+  len: [64 * 1024, 16 * 1024 * 1024],
+  dur: [5]
+});
+
+function main({ method, len, dur }) {
+  try { fs.unlinkSync(filename); } catch (e) {}
+  fs.writeFileSync(filename, Buffer.alloc(len, 'x'));
+  process.on('exit', () => {
+    try { fs.unlinkSync(filename); } catch (e) {}
+  });
+
+  const fd = fs.openSync(filename, 'r');
+  var received = 0;
+
+  const server = net.createServer(function(socket) {
+    (function send() {
+      if (method === 'sendFile') {
+        socket.sendFile(fd, 0, len, send);
+      } else {
+        fs.createReadStream(null, { fd, start: 0, autoClose: false })
+          .on('end', send)
+          .pipe(socket, { end: false });
+      }
+    })();
+  });
+
+  server.listen(PORT, function() {
+    const socket = net.connect(PORT);
+    socket.on('data', function(chunk) {
+      received += chunk.length;
+    });
+    socket.on('connect', function() {
+      bench.start();
+      setTimeout(function() {
+        const gbits = (received * 8) / (1024 * 1024 * 1024);
+        bench.end(gbits);
+        process.exit(0);
+      }, dur * 1000);
+    });
+  });
+}
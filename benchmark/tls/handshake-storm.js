@@ -0,0 +1,78 @@
+// Measure a server under a storm of full handshakes, run by a child process:
+// either the handshakes it completes per second, or the 1ms timers that fire
+// per second in the meantime, which drops when the event loop is blocked.
+'use strict';
+if (process.argv[2] === 'child') {
+  const tls = require('tls');
+  const port = +process.argv[3];
+  const concurrency = +process.argv[4];
+
+  const connect = () => {
+    // No session is passed in, so every handshake is a full one.
+    const conn = tls.connect({ port, rejectUnauthorized: false }, () => {
+      conn.destroy();
+      connect();
+    });
+    conn.on('error', () => {
+      conn.destroy();
+      connect();
+    });
+  };
+  for (var i = 0; i < concurrency; i++)
+    connect();
+} else {
+  const common = require('../common.js');
+  const bench = common.createBenchmark(main, {
+    measure: ['handshakes', 'timers'],
+    asyncHandshake: ['true', 'false'],
+    concurrency: [16],
+    dur: [5]
+  });
+  const fs = require('fs');
+  const path = require('path');
+  const spawn = require('child_process').spawn;
+  const tls = require('tls');
+
+  function main({ measure, asyncHandshake, concurrency, dur }) {
+    const keys = path.resolve(__dirname, '../../test/fixtures/keys');
+    const options = {
+      key: fs.readFileSync(`${keys}/agent8-key.pem`),
+      cert: fs.readFileSync(`${keys}/agent8-cert.pem`),
+      // The ServerKeyExchange is signed with the 2048-bit RSA key.
+      ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+      asyncHandshake: asyncHandshake === 'true'
+    };
+
+    var handshakes = 0;
+    const server = tls.createServer(options, (conn) => {
+      handshakes++;
+      conn.on('error', () => {});
+    });
+    server.on('tlsClientError', () => {});
+
+    server.listen(0, () => {
+      const child = spawn(process.argv[0],
+                          [process.argv[1], 'child',
+                           server.address().port, concurrency],
+                          { stdio: 'inherit' });
+
+      var timers = 0;
+      var running = true;
+      const tick = () => {
+        timers++;
+        if (running)
+          setTimeout(tick, 1);
+      };
+
+      bench.start();
+      setTimeout(tick, 1);
+      setTimeout(() => {
+        running = false;
+        child.kill();
+        server.close();
+        bench.end(measure === 'handshakes' ? handshakes : timers);
+        process.exit(0);
+      }, dur * 1000);
+    });
+  }
+}
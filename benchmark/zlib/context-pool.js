@@ -0,0 +1,35 @@
+// Measure the cost of creating a zlib stream per message, with and without
+// the per-Environment pool of reusable contexts.
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+const bench = common.createBenchmark(main, {
+  pool: ['true', 'false'],
+  method: ['deflate', 'deflateSync', 'gzip', 'gzipSync'],
+  inputLen: [1024],
+  n: [1e5]
+});
+
+function main({ n, pool, method, inputLen }) {
+  process.binding('zlib').setContextPoolEnabled(pool === 'true');
+  const chunk = Buffer.alloc(inputLen, 'a');
+  const fn = zlib[method];
+
+  var i = 0;
+  bench.start();
+  if (method.endsWith('Sync')) {
+    for (; i < n; ++i)
+      fn(chunk);
+    bench.end(n);
+    return;
+  }
+
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(n);
+    fn(chunk, next);
+  })();
+}
@@ -0,0 +1,52 @@
+// Measure gzip throughput in MB/s as more blocks are compressed at once.
+'use strict';
+
+// The threadpool is created on first use, make room for the largest `parallel`
+// value before that happens.
+if (!process.env.UV_THREADPOOL_SIZE)
+  process.env.UV_THREADPOOL_SIZE = 8;
+
+const common = require('../common.js');
+const zlib = require('zlib');
+
+const bench = common.createBenchmark(main, {
+  parallel: [1, 2, 4, 8],
+  level: [1, 6],
+  mb: [64]
+});
+
+// Text with some redundancy, so that the compressor has work to do.
+function createInput(length) {
+  const words = ['alpha', 'bravo', 'charlie', 'delta', 'echo', 'foxtrot',
+                 'golf', 'hotel', 'india', 'juliet', 'kilo', 'lima'];
+  const buf = Buffer.allocUnsafe(length);
+  var seed = 42;
+  var offset = 0;
+  while (offset < length) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    const word = `${words[seed % words.length]}${seed % 1000} `;
+    offset += buf.write(word, offset);
+  }
+  return buf;
+}
+
+function main({ parallel, level, mb }) {
+  const chunk = createInput(1024 * 1024);
+  const gzip = zlib.createGzip({ parallel, level });
+  var written = 0;
+
+  gzip.resume();
+  gzip.on('end', () => {
+    bench.end(mb);
+  });
+
+  bench.start();
+  (function write() {
+    while (written < mb) {
+      written++;
+      if (!gzip.write(chunk))
+        return gzip.once('drain', write);
+    }
+    gzip.end();
+  })();
+}
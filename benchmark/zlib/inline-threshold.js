@@ -0,0 +1,26 @@
+// Measure how many small responses per second can be gzipped, with and
+// without processing them on the main thread.
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+const bench = common.createBenchmark(main, {
+  inlineThreshold: [0, 16384],
+  inputLen: [200, 2000],
+  n: [1e5]
+});
+
+function main({ n, inlineThreshold, inputLen }) {
+  const chunk = Buffer.alloc(inputLen, '{"id":42,"name":"response"}');
+  const opts = { inlineThreshold };
+
+  var i = 0;
+  bench.start();
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(n);
+    zlib.gzip(chunk, opts, next);
+  })();
+}
@@ -990,10 +990,49 @@ struct uv_work_s {
   UV_WORK_PRIVATE_FIELDS
 };
 
+/*
+ * The threadpool keeps a separate queue for each kind of work, and limits
+ * how many threads may run work of a kind at the same time.
+ */
+typedef enum {
+  UV_WORK_CPU,
+  UV_WORK_FAST_IO,
+  UV_WORK_SLOW_IO,
+  UV_WORK_KIND_COUNT
+} uv_work_kind;
+
+typedef struct {
+  unsigned int max_running;
+  unsigned int running;
+  unsigned int queued;
+  uint64_t completed;
+  /* Time between queueing and starting the work, in nanoseconds. */
+  uint64_t wait_time_total;
+  uint64_t wait_time_max;
+} uv_threadpool_stats_t;
+
+typedef struct {
+  /* uv_hrtime() when the work was queued, started and finished. */
+  uint64_t queued_at;
+  uint64_t started_at;
+  uint64_t finished_at;
+  /* Work of the same kind that was already waiting when it was queued. */
+  unsigned int queue_depth;
+} uv_work_timing_t;
+
 UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_t* req,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_queue_work_kind(uv_loop_t* loop,
+                                 uv_work_t* req,
+                                 uv_work_kind kind,
+                                 uv_work_cb work_cb,
+                                 uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_threadpool_stats(uv_work_kind kind,
+                                  uv_threadpool_stats_t* stats);
+UV_EXTERN int uv_req_get_work_timing(const uv_req_t* req,
+                                     uv_work_timing_t* timing);
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
@@ -29,6 +29,21 @@
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* Every kind of work has its own queue and a limit on the number of threads
+ * that may run it at the same time, so that a burst of slow work can not
+ * occupy all threads while fast work is waiting. Idle threads take work
+ * from the queues in turn, skipping those that are at their limit.
+ */
+struct uv__work_lane {
+  QUEUE wq;
+  unsigned int max_running;
+  unsigned int running;
+  unsigned int queued;
+  uint64_t completed;
+  uint64_t wait_time_total;
+  uint64_t wait_time_max;
+};
+
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
 static uv_mutex_t mutex;
@@ -37,7 +52,139 @@ static unsigned int nthreads;
 static uv_thread_t* threads;
 static uv_thread_t default_threads[4];
 static QUEUE exit_message;
-static QUEUE wq;
+static struct uv__work_lane lanes[UV_WORK_KIND_COUNT];
+static unsigned int next_lane;
+
+/* The kind and timing of the work that is queued, running or being completed
+ * are kept here rather than in struct uv__work, which is embedded in public
+ * request types whose size must not change. Open addressing with linear
+ * probing, keyed by the address of the struct uv__work. An entry is removed
+ * once the done callback of its work returned, so that the timing can be
+ * read from there. Must be accessed with the global mutex held.
+ */
+struct uv__work_info {
+  const struct uv__work* w;
+  unsigned int kind;
+  unsigned int queue_depth;
+  int completing;
+  uint64_t queued_at;
+  uint64_t started_at;
+  uint64_t finished_at;
+};
+
+static struct uv__work_info* infos;
+static unsigned int infos_size;  /* Always a power of two, or 0. */
+static unsigned int infos_count;
+
+
+static unsigned int info_hash(const struct uv__work* w) {
+  return (unsigned int) (((uintptr_t) w >> 3) * 2654435761u);
+}
+
+
+static struct uv__work_info* info_find(const struct uv__work* w) {
+  struct uv__work_info* info;
+  unsigned int i;
+
+  if (infos_size == 0)
+    return NULL;
+
+  for (i = info_hash(w);; i++) {
+    info = infos + (i & (infos_size - 1));
+    if (info->w == w)
+      return info;
+    if (info->w == NULL)
+      return NULL;
+  }
+}
+
+
+static int info_grow(void) {
+  struct uv__work_info* old_infos;
+  struct uv__work_info* info;
+  unsigned int old_size;
+  unsigned int i;
+  unsigned int j;
+
+  old_infos = infos;
+  old_size = infos_size;
+
+  infos_size = old_size == 0 ? 64 : 2 * old_size;
+  infos = uv__calloc(infos_size, sizeof(infos[0]));
+  if (infos == NULL) {
+    infos = old_infos;
+    infos_size = old_size;
+    return UV_ENOMEM;
+  }
+
+  for (i = 0; i < old_size; i++) {
+    if (old_infos[i].w == NULL)
+      continue;
+    for (j = info_hash(old_infos[i].w);; j++) {
+      info = infos + (j & (infos_size - 1));
+      if (info->w == NULL)
+        break;
+    }
+    *info = old_infos[i];
+  }
+
+  uv__free(old_infos);
+  return 0;
+}
+
+
+/* Returns the existing entry for `w`, which is reset, or a new one. */
+static struct uv__work_info* info_insert(const struct uv__work* w) {
+  struct uv__work_info* info;
+  unsigned int i;
+
+  info = info_find(w);
+  if (info == NULL) {
+    /* Keep the table at most half full. If it can not grow, the remaining
+     * free slots are used up before giving up.
+     */
+    if (2 * (infos_count + 1) > infos_size)
+      if (info_grow() != 0 && infos_count + 1 >= infos_size)
+        abort();
+
+    for (i = info_hash(w);; i++) {
+      info = infos + (i & (infos_size - 1));
+      if (info->w == NULL)
+        break;
+    }
+    infos_count += 1;
+  }
+
+  memset(info, 0, sizeof(*info));
+  info->w = w;
+  return info;
+}
+
+
+static void info_remove(struct uv__work_info* info) {
+  struct uv__work_info* next;
+  unsigned int hole;
+  unsigned int home;
+  unsigned int i;
+
+  /* Move later entries of the same probe sequence into the hole, so that
+   * lookups do not stop early.
+   */
+  hole = info - infos;
+  for (i = hole + 1;; i++) {
+    next = infos + (i & (infos_size - 1));
+    if (next->w == NULL)
+      break;
+    home = info_hash(next->w) & (infos_size - 1);
+    if (((i - home) & (infos_size - 1)) >= ((i - hole) & (infos_size - 1))) {
+      infos[hole] = *next;
+      hole = i & (infos_size - 1);
+    }
+  }
+
+  infos[hole].w = NULL;
+  infos_count -= 1;
+}
 
 
 static void uv__cancelled(struct uv__work* w) {
@@ -45,11 +192,45 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+/* Returns the next work item to run, or NULL if there is none that may run
+ * now. The exit message is always returned. Must be called with the global
+ * mutex held.
+ */
+static QUEUE* next_work(void) {
+  struct uv__work_lane* lane;
+  unsigned int kind;
+  unsigned int i;
+  QUEUE* q;
+
+  for (i = 0; i < ARRAY_SIZE(lanes); i++) {
+    kind = (next_lane + i) % ARRAY_SIZE(lanes);
+    lane = lanes + kind;
+
+    if (QUEUE_EMPTY(&lane->wq))
+      continue;
+
+    q = QUEUE_HEAD(&lane->wq);
+    if (q != &exit_message && lane->running >= lane->max_running)
+      continue;
+
+    next_lane = kind + 1;
+    return q;
+  }
+
+  return NULL;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct uv__work_info* info;
+  struct uv__work_lane* lane;
   struct uv__work* w;
+  uint64_t started_at;
+  uint64_t finished_at;
+  uint64_t wait_time;
   QUEUE* q;
 
   uv_sem_post((uv_sem_t*) arg);
@@ -58,29 +239,48 @@ static void worker(void* arg) {
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq)) {
+    while ((q = next_work()) == NULL) {
       idle_threads += 1;
       uv_cond_wait(&cond, &mutex);
       idle_threads -= 1;
     }
 
-    q = QUEUE_HEAD(&wq);
-
-    if (q == &exit_message)
+    if (q == &exit_message) {
       uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
+      uv_mutex_unlock(&mutex);
+      break;
     }
 
-    uv_mutex_unlock(&mutex);
-
-    if (q == &exit_message)
-      break;
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
+                       executing. */
 
     w = QUEUE_DATA(q, struct uv__work, wq);
+    info = info_find(w);
+    assert(info != NULL);
+    lane = lanes + info->kind;
+    lane->queued -= 1;
+    lane->running += 1;
+    started_at = uv_hrtime();
+    info->started_at = started_at;
+    wait_time = started_at - info->queued_at;
+    lane->wait_time_total += wait_time;
+    if (wait_time > lane->wait_time_max)
+      lane->wait_time_max = wait_time;
+
+    uv_mutex_unlock(&mutex);
+
     w->work(w);
+    finished_at = uv_hrtime();
+
+    uv_mutex_lock(&mutex);
+    info_find(w)->finished_at = finished_at;
+    lane->running -= 1;
+    lane->completed += 1;
+    /* The lane may have been at its limit while other threads were idle. */
+    if (!QUEUE_EMPTY(&lane->wq) && idle_threads > 0)
+      uv_cond_signal(&cond);
+    uv_mutex_unlock(&mutex);
 
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
@@ -92,9 +292,18 @@ static void worker(void* arg) {
 }
 
 
-static void post(QUEUE* q) {
+static void post(QUEUE* q, uv_work_kind kind, uint64_t queued_at) {
+  struct uv__work_info* info;
+
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
+  QUEUE_INSERT_TAIL(&lanes[kind].wq, q);
+  if (q != &exit_message) {
+    info = info_insert(QUEUE_DATA(q, struct uv__work, wq));
+    info->kind = kind;
+    info->queue_depth = lanes[kind].queued;
+    info->queued_at = queued_at;
+    lanes[kind].queued += 1;
+  }
   if (idle_threads > 0)
     uv_cond_signal(&cond);
   uv_mutex_unlock(&mutex);
@@ -108,7 +317,7 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (nthreads == 0)
     return;
 
-  post(&exit_message);
+  post(&exit_message, UV_WORK_FAST_IO, 0);
 
   for (i = 0; i < nthreads; i++)
     if (uv_thread_join(threads + i))
@@ -126,6 +335,23 @@ UV_DESTRUCTOR(static void cleanup(void)) {
 #endif
 
 
+/* Reads a thread count from the environment, limited to 1..nthreads. */
+static unsigned int threads_from_env(const char* name, unsigned int def) {
+  const char* val;
+  unsigned int n;
+
+  n = def;
+  val = getenv(name);
+  if (val != NULL)
+    n = atoi(val);
+  if (n == 0)
+    n = 1;
+  if (n > nthreads)
+    n = nthreads;
+  return n;
+}
+
+
 static void init_threads(void) {
   unsigned int i;
   const char* val;
@@ -155,7 +381,26 @@ static void init_threads(void) {
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  memset(lanes, 0, sizeof(lanes));
+  for (i = 0; i < ARRAY_SIZE(lanes); i++)
+    QUEUE_INIT(&lanes[i].wq);
+  next_lane = 0;
+
+  /* After a fork, the work of the parent is gone as well. */
+  uv__free(infos);
+  infos = NULL;
+  infos_size = 0;
+  infos_count = 0;
+
+  /* By default CPU-bound work leaves one thread for I/O, and slow I/O such
+   * as DNS lookups can use at most half of the threads.
+   */
+  lanes[UV_WORK_CPU].max_running =
+      threads_from_env("UV_THREADPOOL_CPU_THREADS", nthreads - 1);
+  lanes[UV_WORK_FAST_IO].max_running =
+      threads_from_env("UV_THREADPOOL_FAST_IO_THREADS", nthreads);
+  lanes[UV_WORK_SLOW_IO].max_running =
+      threads_from_env("UV_THREADPOOL_SLOW_IO_THREADS", (nthreads + 1) / 2);
 
   if (uv_sem_init(&sem, 0))
     abort();
@@ -194,13 +439,59 @@ static void init_once(void) {
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     uv_work_kind kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  post(&w->wq, kind, uv_hrtime());
+}
+
+
+void uv__work_timing_start(struct uv__work* w, unsigned int queue_depth) {
+  struct uv__work_info* info;
+  uint64_t now;
+
+  uv_once(&once, init_once);
+  now = uv_hrtime();
+
+  uv_mutex_lock(&mutex);
+  info = info_insert(w);
+  info->kind = UV_WORK_FAST_IO;
+  info->queue_depth = queue_depth;
+  info->queued_at = now;
+  info->started_at = now;
+  uv_mutex_unlock(&mutex);
+}
+
+
+void uv__work_timing_finish(struct uv__work* w) {
+  struct uv__work_info* info;
+  uint64_t now;
+
+  now = uv_hrtime();
+
+  uv_mutex_lock(&mutex);
+  info = info_find(w);
+  if (info != NULL) {
+    info->finished_at = now;
+    info->completing = 1;
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+
+void uv__work_timing_release(struct uv__work* w) {
+  struct uv__work_info* info;
+
+  uv_mutex_lock(&mutex);
+  info = info_find(w);
+  /* Not if the done callback submitted `w` again. */
+  if (info != NULL && info->completing)
+    info_remove(info);
+  uv_mutex_unlock(&mutex);
 }
 
 
@@ -211,8 +502,10 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    lanes[info_find(w)->kind].queued -= 1;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -248,7 +541,13 @@ void uv__work_done(uv_async_t* handle) {
 
     w = container_of(q, struct uv__work, wq);
     err = (w->work == uv__cancelled) ? UV_ECANCELED : 0;
+
+    uv_mutex_lock(&mutex);
+    info_find(w)->completing = 1;
+    uv_mutex_unlock(&mutex);
+
     w->done(w, err);
+    uv__work_timing_release(w);
   }
 }
 
@@ -277,14 +576,48 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_kind(loop, req, UV_WORK_CPU, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_kind(uv_loop_t* loop,
+                       uv_work_t* req,
+                       uv_work_kind kind,
+                       uv_work_cb work_cb,
+                       uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if (kind < 0 || kind >= UV_WORK_KIND_COUNT)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop, &req->work_req, kind, uv__queue_work, uv__queue_done);
+  return 0;
+}
+
+
+int uv_threadpool_stats(uv_work_kind kind, uv_threadpool_stats_t* stats) {
+  struct uv__work_lane* lane;
+
+  if (kind < 0 || kind >= UV_WORK_KIND_COUNT || stats == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+
+  uv_mutex_lock(&mutex);
+  lane = lanes + kind;
+  stats->max_running = lane->max_running;
+  stats->running = lane->running;
+  stats->queued = lane->queued;
+  stats->completed = lane->completed;
+  stats->wait_time_total = lane->wait_time_total;
+  stats->wait_time_max = lane->wait_time_max;
+  uv_mutex_unlock(&mutex);
+
   return 0;
 }
 
@@ -316,3 +649,46 @@ int uv_cancel(uv_req_t* req) {
 
   return uv__work_cancel(loop, req, wreq);
 }
+
+
+int uv_req_get_work_timing(const uv_req_t* req, uv_work_timing_t* timing) {
+  const struct uv__work_info* info;
+  const struct uv__work* w;
+  int err;
+
+  if (req == NULL || timing == NULL)
+    return UV_EINVAL;
+
+  switch (req->type) {
+    case UV_WORK:
+      w = &((const uv_work_t*) req)->work_req;
+      break;
+    case UV_FS:
+      w = &((const uv_fs_t*) req)->work_req;
+      break;
+    case UV_GETADDRINFO:
+      w = &((const uv_getaddrinfo_t*) req)->work_req;
+      break;
+    case UV_GETNAMEINFO:
+      w = &((const uv_getnameinfo_t*) req)->work_req;
+      break;
+    default:
+      return UV_EINVAL;
+  }
+
+  uv_once(&once, init_once);
+
+  err = UV_ENOENT;
+  uv_mutex_lock(&mutex);
+  info = info_find(w);
+  if (info != NULL) {
+    timing->queued_at = info->queued_at;
+    timing->started_at = info->started_at;
+    timing->finished_at = info->finished_at;
+    timing->queue_depth = info->queue_depth;
+    err = 0;
+  }
+  uv_mutex_unlock(&mutex);
+
+  return err;
+}
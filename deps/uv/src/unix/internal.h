@@ -255,6 +255,15 @@ int uv__platform_loop_init(uv_loop_t* loop);
 void uv__platform_loop_delete(uv_loop_t* loop);
 void uv__platform_invalidate_fd(uv_loop_t* loop, int fd);
 
+/* io_uring, see linux-iouring.c */
+#if defined(__linux__)
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req);
+void uv__iou_delete(uv_loop_t* loop);
+void uv__iou_forget(uv_loop_t* loop);
+#else
+# define uv__iou_fs_submit(loop, req) 0
+#endif
+
 /* various */
 void uv__async_close(uv_async_t* handle);
 void uv__check_close(uv_check_t* handle);
@@ -0,0 +1,555 @@
+/* Copyright libuv contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* File system requests over io_uring.
+ *
+ * When UV_USE_IO_URING=1 is set in the environment and the kernel supports
+ * the operations (Linux 5.6 or newer), read, write, fsync, fdatasync, open,
+ * close and the stat calls are submitted from the loop thread to a ring that
+ * belongs to the loop, instead of being run as blocking system calls on the
+ * threadpool. The kernel signals completions on an eventfd that is polled
+ * like any other file descriptor, and the callbacks run from there.
+ *
+ * Whenever a request can not be submitted, because io_uring is unavailable,
+ * the ring is full or the request has more buffers than fit into one
+ * system call, it is queued on the threadpool as before.
+ *
+ * The rings are kept in a list keyed by their loop rather than in uv_loop_t,
+ * whose size is part of the ABI.
+ */
+
+#include "uv.h"
+#include "internal.h"
+#include "linux-syscalls.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#define UV__IOU_ENTRIES 64
+
+struct uv__iou {
+  uv_loop_t* loop;
+  struct uv__iou* next;
+  int ringfd;  /* -1 if the threadpool is used. */
+  int eventfd;
+  uv__io_t watcher;
+  void* ring;
+  size_t ringlen;
+  struct uv__io_uring_sqe* sqes;
+  size_t sqeslen;
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t sqmask;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_cqe* cqes;
+  unsigned int in_flight;
+  unsigned int max_in_flight;
+};
+
+
+static void uv__iou_on_eventfd(uv_loop_t* loop,
+                               uv__io_t* w,
+                               unsigned int events);
+
+static uv_once_t uv__iou_once = UV_ONCE_INIT;
+static uv_mutex_t uv__iou_mutex;
+static struct uv__iou* uv__iou_list;
+
+
+static void uv__iou_init_once(void) {
+  if (uv_mutex_init(&uv__iou_mutex))
+    abort();
+}
+
+
+static struct uv__iou* uv__iou_find(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  uv_once(&uv__iou_once, uv__iou_init_once);
+  uv_mutex_lock(&uv__iou_mutex);
+  for (iou = uv__iou_list; iou != NULL; iou = iou->next)
+    if (iou->loop == loop)
+      break;
+  uv_mutex_unlock(&uv__iou_mutex);
+
+  return iou;
+}
+
+
+/* Removes the ring of `loop` from the list and returns it. */
+static struct uv__iou* uv__iou_unlink(uv_loop_t* loop) {
+  struct uv__iou** link;
+  struct uv__iou* iou;
+
+  uv_once(&uv__iou_once, uv__iou_init_once);
+  uv_mutex_lock(&uv__iou_mutex);
+  for (link = &uv__iou_list; *link != NULL; link = &(*link)->next)
+    if ((*link)->loop == loop)
+      break;
+  iou = *link;
+  if (iou != NULL)
+    *link = iou->next;
+  uv_mutex_unlock(&uv__iou_mutex);
+
+  return iou;
+}
+
+
+static void uv__iou_free(struct uv__iou* iou) {
+  if (iou->ringfd != -1) {
+    uv__close(iou->eventfd);
+    munmap(iou->sqes, iou->sqeslen);
+    munmap(iou->ring, iou->ringlen);
+    uv__close(iou->ringfd);
+  }
+
+  uv__free(iou);
+}
+
+
+static int uv__iou_enabled(void) {
+  const char* val;
+
+  val = getenv("UV_USE_IO_URING");
+  return val != NULL && atoi(val) > 0;
+}
+
+
+static int uv__iou_probe(int ringfd) {
+  static const uint8_t ops[] = {
+    UV__IORING_OP_READV,
+    UV__IORING_OP_WRITEV,
+    UV__IORING_OP_FSYNC,
+    UV__IORING_OP_OPENAT,
+    UV__IORING_OP_CLOSE,
+    UV__IORING_OP_STATX
+  };
+  struct uv__io_uring_probe* probe;
+  unsigned int i;
+  int ok;
+
+  probe = uv__calloc(1, sizeof(*probe));
+  if (probe == NULL)
+    return 0;
+
+  ok = 0;
+  if (uv__io_uring_register(ringfd,
+                            UV__IORING_REGISTER_PROBE,
+                            probe,
+                            ARRAY_SIZE(probe->ops)) == 0) {
+    ok = 1;
+    for (i = 0; i < ARRAY_SIZE(ops); i++)
+      if (ops[i] >= probe->ops_len ||
+          !(probe->ops[ops[i]].flags & UV__IO_URING_OP_SUPPORTED))
+        ok = 0;
+  }
+
+  uv__free(probe);
+  return ok;
+}
+
+
+static void uv__iou_init(uv_loop_t* loop, struct uv__iou* iou) {
+  struct uv__io_uring_params params;
+  uint32_t required;
+  size_t sqlen;
+  size_t cqlen;
+  char* ring;
+  void* sqes;
+  int ringfd;
+  int efd;
+
+  memset(&params, 0, sizeof(params));
+  ringfd = uv__io_uring_setup(UV__IOU_ENTRIES, &params);
+  if (ringfd == -1)
+    return;
+
+  /* Linux 5.6 and newer. */
+  required = UV__IORING_FEAT_SINGLE_MMAP |
+             UV__IORING_FEAT_NODROP |
+             UV__IORING_FEAT_RW_CUR_POS;
+  if ((params.features & required) != required || !uv__iou_probe(ringfd))
+    goto fail_ring;
+
+  sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqlen = params.cq_off.cqes +
+          params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  if (cqlen > sqlen)
+    sqlen = cqlen;
+
+  ring = mmap(NULL,
+              sqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              ringfd,
+              UV__IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED)
+    goto fail_ring;
+
+  sqes = mmap(NULL,
+              params.sq_entries * sizeof(struct uv__io_uring_sqe),
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              ringfd,
+              UV__IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    goto fail_ring_mmap;
+
+  efd = uv__eventfd2(0, UV__EFD_CLOEXEC | UV__EFD_NONBLOCK);
+  if (efd == -1)
+    goto fail_sqes_mmap;
+
+  if (uv__io_uring_register(ringfd, UV__IORING_REGISTER_EVENTFD, &efd, 1))
+    goto fail_eventfd;
+
+  iou->ringfd = ringfd;
+  iou->eventfd = efd;
+  iou->ring = ring;
+  iou->ringlen = sqlen;
+  iou->sqes = sqes;
+  iou->sqeslen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+  iou->sqhead = (uint32_t*) (ring + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (ring + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) (ring + params.sq_off.array);
+  iou->sqmask = *(uint32_t*) (ring + params.sq_off.ring_mask);
+  iou->cqhead = (uint32_t*) (ring + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (ring + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (ring + params.cq_off.ring_mask);
+  iou->cqes = (struct uv__io_uring_cqe*) (ring + params.cq_off.cqes);
+  /* Never more requests in flight than there are completion entries, so the
+   * kernel never has to hold completions back.
+   */
+  iou->max_in_flight = params.cq_entries;
+
+  uv__io_init(&iou->watcher, uv__iou_on_eventfd, efd);
+  uv__io_start(loop, &iou->watcher, POLLIN);
+  return;
+
+fail_eventfd:
+  uv__close(efd);
+fail_sqes_mmap:
+  munmap(sqes, params.sq_entries * sizeof(struct uv__io_uring_sqe));
+fail_ring_mmap:
+  munmap(ring, sqlen);
+fail_ring:
+  uv__close(ringfd);
+}
+
+
+/* Returns NULL if requests go to the threadpool. */
+static struct uv__iou* uv__iou_get(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = uv__iou_find(loop);
+  if (iou == NULL) {
+    iou = uv__malloc(sizeof(*iou));
+    if (iou == NULL)
+      return NULL;
+
+    iou->loop = loop;
+    iou->ringfd = -1;
+    iou->eventfd = -1;
+    iou->in_flight = 0;
+
+    if (uv__iou_enabled())
+      uv__iou_init(loop, iou);
+
+    /* Only the thread of the loop adds its ring. */
+    uv_mutex_lock(&uv__iou_mutex);
+    iou->next = uv__iou_list;
+    uv__iou_list = iou;
+    uv_mutex_unlock(&uv__iou_mutex);
+  }
+
+  if (iou->ringfd == -1)
+    return NULL;
+
+  return iou;
+}
+
+
+void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = uv__iou_unlink(loop);
+  if (iou == NULL)
+    return;
+
+  if (iou->ringfd != -1)
+    uv__io_stop(loop, &iou->watcher, POLLIN);
+  uv__iou_free(iou);
+}
+
+
+void uv__iou_forget(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  /* Left behind by a loop at the same address that was never closed; its
+   * watcher belongs to that loop.
+   */
+  iou = uv__iou_unlink(loop);
+  if (iou != NULL)
+    uv__iou_free(iou);
+}
+
+
+static void uv__iou_statx_to_stat(const struct uv__statx* src,
+                                  uv_stat_t* dst) {
+  dst->st_dev = makedev(src->stx_dev_major, src->stx_dev_minor);
+  dst->st_mode = src->stx_mode;
+  dst->st_nlink = src->stx_nlink;
+  dst->st_uid = src->stx_uid;
+  dst->st_gid = src->stx_gid;
+  dst->st_rdev = makedev(src->stx_rdev_major, src->stx_rdev_minor);
+  dst->st_ino = src->stx_ino;
+  dst->st_size = src->stx_size;
+  dst->st_blksize = src->stx_blksize;
+  dst->st_blocks = src->stx_blocks;
+  dst->st_atim.tv_sec = src->stx_atime.tv_sec;
+  dst->st_atim.tv_nsec = src->stx_atime.tv_nsec;
+  dst->st_mtim.tv_sec = src->stx_mtime.tv_sec;
+  dst->st_mtim.tv_nsec = src->stx_mtime.tv_nsec;
+  dst->st_ctim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_ctim.tv_nsec = src->stx_ctime.tv_nsec;
+  /* The same as uv__to_stat() on Linux, so that the result does not depend
+   * on whether the threadpool or io_uring ran the request.
+   */
+  dst->st_birthtim = dst->st_ctim;
+  dst->st_flags = 0;
+  dst->st_gen = 0;
+}
+
+
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__statx* statxbuf;
+  struct uv__iou* iou;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t slot;
+  int rc;
+
+  switch (req->fs_type) {
+    case UV_FS_CLOSE:
+    case UV_FS_FDATASYNC:
+    case UV_FS_FSTAT:
+    case UV_FS_FSYNC:
+    case UV_FS_LSTAT:
+    case UV_FS_OPEN:
+    case UV_FS_STAT:
+      break;
+    case UV_FS_READ:
+    case UV_FS_WRITE:
+      if (req->nbufs > (unsigned int) uv__getiovmax())
+        return 0;
+      break;
+    default:
+      return 0;
+  }
+
+  iou = uv__iou_get(loop);
+  if (iou == NULL || iou->in_flight >= iou->max_in_flight)
+    return 0;
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  tail = *iou->sqtail;
+  if (tail - head > iou->sqmask)
+    return 0;  /* Full. */
+
+  statxbuf = NULL;
+  if (req->fs_type == UV_FS_STAT ||
+      req->fs_type == UV_FS_LSTAT ||
+      req->fs_type == UV_FS_FSTAT) {
+    statxbuf = uv__malloc(sizeof(*statxbuf));
+    if (statxbuf == NULL)
+      return 0;
+  }
+
+  slot = tail & iou->sqmask;
+  sqe = &iou->sqes[slot];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = (uintptr_t) req;
+
+  switch (req->fs_type) {
+    case UV_FS_CLOSE:
+      sqe->opcode = UV__IORING_OP_CLOSE;
+      sqe->fd = req->file;
+      break;
+    case UV_FS_FDATASYNC:
+      sqe->opcode = UV__IORING_OP_FSYNC;
+      sqe->fd = req->file;
+      sqe->rw_flags = UV__IORING_FSYNC_DATASYNC;
+      break;
+    case UV_FS_FSYNC:
+      sqe->opcode = UV__IORING_OP_FSYNC;
+      sqe->fd = req->file;
+      break;
+    case UV_FS_OPEN:
+      sqe->opcode = UV__IORING_OP_OPENAT;
+      sqe->fd = AT_FDCWD;
+      sqe->addr = (uintptr_t) req->path;
+      sqe->len = req->mode;
+      sqe->rw_flags = req->flags | O_CLOEXEC;
+      break;
+    case UV_FS_READ:
+    case UV_FS_WRITE:
+      sqe->opcode = req->fs_type == UV_FS_READ ? UV__IORING_OP_READV
+                                               : UV__IORING_OP_WRITEV;
+      sqe->fd = req->file;
+      sqe->addr = (uintptr_t) req->bufs;  /* uv_buf_t is a struct iovec. */
+      sqe->len = req->nbufs;
+      sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+      break;
+    case UV_FS_FSTAT:
+      sqe->opcode = UV__IORING_OP_STATX;
+      sqe->fd = req->file;
+      sqe->addr = (uintptr_t) "";
+      sqe->rw_flags = AT_EMPTY_PATH;
+      break;
+    case UV_FS_LSTAT:
+    case UV_FS_STAT:
+      sqe->opcode = UV__IORING_OP_STATX;
+      sqe->fd = AT_FDCWD;
+      sqe->addr = (uintptr_t) req->path;
+      if (req->fs_type == UV_FS_LSTAT)
+        sqe->rw_flags = AT_SYMLINK_NOFOLLOW;
+      break;
+    default:
+      abort();
+  }
+
+  if (statxbuf != NULL) {
+    sqe->len = UV__STATX_BASIC_STATS;
+    sqe->off = (uintptr_t) statxbuf;
+  }
+
+  iou->sqarray[slot] = slot;
+  __atomic_store_n(iou->sqtail, tail + 1, __ATOMIC_RELEASE);
+
+  do
+    rc = uv__io_uring_enter(iou->ringfd, 1, 0, 0);
+  while (rc == -1 && errno == EINTR);
+
+  if (rc != 1) {
+    /* Nothing was consumed, the kernel only reads the ring while inside
+     * io_uring_enter().
+     */
+    __atomic_store_n(iou->sqtail, tail, __ATOMIC_RELEASE);
+    uv__free(statxbuf);
+    return 0;
+  }
+
+  req->ptr = statxbuf;
+
+  /* Not on the threadpool; uv_cancel() returns UV_EBUSY. The timing covers
+   * the time in the kernel.
+   */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  req->work_req.done = NULL;
+  QUEUE_INIT(&req->work_req.wq);
+  uv__work_timing_start(&req->work_req, iou->in_flight);
+
+  iou->in_flight++;
+  return 1;
+}
+
+
+static void uv__iou_fs_done(uv_fs_t* req, int result) {
+  struct uv__statx* statxbuf;
+  struct uv__work* w;
+
+  uv__work_timing_finish(&req->work_req);
+
+  switch (req->fs_type) {
+    case UV_FS_READ:
+    case UV_FS_WRITE:
+      if (req->bufs != req->bufsml)
+        uv__free(req->bufs);
+      req->bufs = NULL;
+      req->nbufs = 0;
+      break;
+    case UV_FS_FSTAT:
+    case UV_FS_LSTAT:
+    case UV_FS_STAT:
+      statxbuf = req->ptr;
+      req->ptr = NULL;
+      if (result == 0) {
+        uv__iou_statx_to_stat(statxbuf, &req->statbuf);
+        req->ptr = &req->statbuf;
+      }
+      uv__free(statxbuf);
+      break;
+    default:
+      break;
+  }
+
+  req->result = result;
+  uv__req_unregister(req->loop, req);
+  w = &req->work_req;
+  req->cb(req);
+  uv__work_timing_release(w);
+}
+
+
+static void uv__iou_on_eventfd(uv_loop_t* loop,
+                               uv__io_t* w,
+                               unsigned int events) {
+  struct uv__io_uring_cqe* cqe;
+  struct uv__iou* iou;
+  uint64_t count;
+  uint32_t head;
+  uint32_t tail;
+  uv_fs_t* req;
+  int result;
+
+  iou = container_of(w, struct uv__iou, watcher);
+
+  while (read(iou->eventfd, &count, sizeof(count)) == -1 && errno == EINTR)
+    ;
+
+  /* Callbacks may submit new requests, which can complete right away. */
+  head = *iou->cqhead;
+  for (;;) {
+    tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+    if (head == tail)
+      break;
+
+    cqe = &iou->cqes[head & iou->cqmask];
+    req = (uv_fs_t*) (uintptr_t) cqe->user_data;
+    result = cqe->res;
+    head++;
+    __atomic_store_n(iou->cqhead, head, __ATOMIC_RELEASE);
+
+    assert(iou->in_flight > 0);
+    iou->in_flight--;
+    uv__iou_fs_done(req, result);
+  }
+}
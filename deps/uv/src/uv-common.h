@@ -115,11 +115,19 @@ int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     uv_work_kind kind,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
 void uv__work_done(uv_async_t* handle);
 
+/* For work that is not run on the threadpool but reports its timing through
+ * uv_req_get_work_timing(). The timing is released after the callback.
+ */
+void uv__work_timing_start(struct uv__work* w, unsigned int queue_depth);
+void uv__work_timing_finish(struct uv__work* w);
+void uv__work_timing_release(struct uv__work* w);
+
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
 
 int uv__socket_sockopt(uv_handle_t* handle, int optname, int* value);
@@ -0,0 +1,183 @@
+/* Copyright libuv contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* With UV_USE_IO_URING=1, the requests below are submitted to io_uring where
+ * the kernel supports it, and queued on the threadpool otherwise. Either way
+ * they must behave the same.
+ */
+
+#if !defined(_WIN32)
+
+static const char test_buf[] = "test-buffer\n";
+static char read_buf[sizeof(test_buf)];
+static uv_loop_t loop;
+static uv_fs_t req;
+static uv_file file;
+static int steps;
+
+static void close_cb(uv_fs_t* r);
+
+
+static void check_timing(uv_fs_t* r) {
+  uv_work_timing_t timing;
+
+  ASSERT(0 == uv_req_get_work_timing((uv_req_t*) r, &timing));
+  ASSERT(timing.queued_at > 0);
+  ASSERT(timing.finished_at >= timing.started_at);
+  ASSERT(timing.started_at >= timing.queued_at);
+}
+
+
+static void stat_cb(uv_fs_t* r) {
+  uv_stat_t* s;
+
+  ASSERT(r->result == 0);
+  s = r->ptr;
+  ASSERT(s == &r->statbuf);
+  ASSERT(s->st_size == sizeof(test_buf) - 1);
+  ASSERT((s->st_mode & S_IFMT) == S_IFREG);
+  /* As reported by the threadpool on Linux. */
+  ASSERT(s->st_birthtim.tv_sec == s->st_ctim.tv_sec);
+  ASSERT(s->st_birthtim.tv_nsec == s->st_ctim.tv_nsec);
+  check_timing(r);
+  uv_fs_req_cleanup(r);
+  steps++;
+
+  if (r->fs_type == UV_FS_STAT)
+    ASSERT(0 == uv_fs_lstat(&loop, &req, "test_file", stat_cb));
+}
+
+
+static void fdatasync_cb(uv_fs_t* r) {
+  ASSERT(r->result == 0);
+  uv_fs_req_cleanup(r);
+  steps++;
+  ASSERT(0 == uv_fs_close(&loop, &req, file, close_cb));
+}
+
+
+static void read_cb(uv_fs_t* r) {
+  ASSERT(r->result == sizeof(test_buf) - 1);
+  ASSERT(0 == memcmp(read_buf, test_buf, sizeof(test_buf) - 1));
+  check_timing(r);
+  uv_fs_req_cleanup(r);
+  steps++;
+  ASSERT(0 == uv_fs_fdatasync(&loop, &req, file, fdatasync_cb));
+}
+
+
+static void fstat_cb(uv_fs_t* r) {
+  uv_buf_t buf;
+
+  ASSERT(r->result == 0);
+  ASSERT(r->statbuf.st_size == sizeof(test_buf) - 1);
+  uv_fs_req_cleanup(r);
+  steps++;
+  buf = uv_buf_init(read_buf, sizeof(read_buf));
+  ASSERT(0 == uv_fs_read(&loop, &req, file, &buf, 1, 0, read_cb));
+}
+
+
+static void fsync_cb(uv_fs_t* r) {
+  ASSERT(r->result == 0);
+  uv_fs_req_cleanup(r);
+  steps++;
+  ASSERT(0 == uv_fs_fstat(&loop, &req, file, fstat_cb));
+}
+
+
+static void write_cb(uv_fs_t* r) {
+  ASSERT(r->result == sizeof(test_buf) - 1);
+  check_timing(r);
+  uv_fs_req_cleanup(r);
+  steps++;
+  ASSERT(0 == uv_fs_fsync(&loop, &req, file, fsync_cb));
+}
+
+
+static void open_cb(uv_fs_t* r) {
+  uv_buf_t bufs[2];
+
+  ASSERT(r->result >= 0);
+  file = r->result;
+  uv_fs_req_cleanup(r);
+  steps++;
+  /* Two buffers at the current position. */
+  bufs[0] = uv_buf_init((char*) test_buf, 4);
+  bufs[1] = uv_buf_init((char*) test_buf + 4, sizeof(test_buf) - 1 - 4);
+  ASSERT(0 == uv_fs_write(&loop, &req, file, bufs, 2, -1, write_cb));
+}
+
+
+static void close_cb(uv_fs_t* r) {
+  ASSERT(r->result == 0);
+  uv_fs_req_cleanup(r);
+  steps++;
+  ASSERT(0 == uv_fs_stat(&loop, &req, "test_file", stat_cb));
+}
+
+
+static void open_noent_cb(uv_fs_t* r) {
+  ASSERT(r->result == UV_ENOENT);
+  uv_fs_req_cleanup(r);
+  steps++;
+}
+
+#endif
+
+
+TEST_IMPL(fs_iouring) {
+#if defined(_WIN32)
+  RETURN_SKIP("Not implemented on Windows.");
+#else
+  uv_fs_t unlink_req;
+
+  ASSERT(0 == setenv("UV_USE_IO_URING", "1", 1));
+  unlink("test_file");
+  ASSERT(0 == uv_loop_init(&loop));
+
+  ASSERT(0 == uv_fs_open(&loop, &req, "test_file",
+                         O_RDWR | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR,
+                         open_cb));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(steps == 9);
+
+  ASSERT(0 == uv_fs_open(&loop, &req, "test_file_noent", O_RDONLY, 0,
+                         open_noent_cb));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(steps == 10);
+
+  uv_fs_unlink(NULL, &unlink_req, "test_file", NULL);
+  uv_fs_req_cleanup(&unlink_req);
+  ASSERT(0 == uv_loop_close(&loop));
+  ASSERT(0 == unsetenv("UV_USE_IO_URING"));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
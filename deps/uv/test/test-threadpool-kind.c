@@ -0,0 +1,164 @@
+/* Copyright libuv contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_CPU_WORK 4
+
+static uv_sem_t cpu_sem;
+static uv_work_t cpu_reqs[NUM_CPU_WORK];
+static uv_work_t io_req;
+static int cpu_done_count;
+static int io_done_count;
+
+
+static void cpu_work_cb(uv_work_t* req) {
+  uv_sem_wait(&cpu_sem);
+}
+
+
+static void io_work_cb(uv_work_t* req) {
+  int i;
+
+  for (i = 0; i < NUM_CPU_WORK; i++)
+    uv_sem_post(&cpu_sem);
+}
+
+
+static void cpu_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  cpu_done_count++;
+}
+
+
+static void io_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  io_done_count++;
+}
+
+
+TEST_IMPL(threadpool_work_kind_einval) {
+  uv_threadpool_stats_t stats;
+  int r;
+
+  r = uv_queue_work_kind(uv_default_loop(),
+                         &io_req,
+                         UV_WORK_KIND_COUNT,
+                         io_work_cb,
+                         io_done_cb);
+  ASSERT(r == UV_EINVAL);
+
+  r = uv_threadpool_stats(UV_WORK_KIND_COUNT, &stats);
+  ASSERT(r == UV_EINVAL);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+/* Work that blocks all threads that CPU-bound work may use must not keep
+ * I/O work from running.
+ */
+TEST_IMPL(threadpool_work_kind_lanes) {
+  uv_threadpool_stats_t cpu_stats;
+  uv_threadpool_stats_t io_stats;
+  int i;
+
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_CPU, &cpu_stats));
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_FAST_IO, &io_stats));
+  if (cpu_stats.max_running >= io_stats.max_running)
+    RETURN_SKIP("No threads are reserved for I/O.");
+
+  ASSERT(0 == uv_sem_init(&cpu_sem, 0));
+
+  for (i = 0; i < NUM_CPU_WORK; i++)
+    ASSERT(0 == uv_queue_work_kind(uv_default_loop(),
+                                   cpu_reqs + i,
+                                   UV_WORK_CPU,
+                                   cpu_work_cb,
+                                   cpu_done_cb));
+
+  ASSERT(0 == uv_queue_work_kind(uv_default_loop(),
+                                 &io_req,
+                                 UV_WORK_FAST_IO,
+                                 io_work_cb,
+                                 io_done_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(cpu_done_count == NUM_CPU_WORK);
+  ASSERT(io_done_count == 1);
+
+  ASSERT(0 == uv_threadpool_stats(UV_WORK_CPU, &cpu_stats));
+  ASSERT(cpu_stats.running == 0);
+  ASSERT(cpu_stats.queued == 0);
+  ASSERT(cpu_stats.completed >= NUM_CPU_WORK);
+  ASSERT(cpu_stats.wait_time_max <= cpu_stats.wait_time_total);
+
+  uv_sem_destroy(&cpu_sem);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static void timing_work_cb(uv_work_t* req) {
+  uv_sleep(10);
+}
+
+
+static void timing_done_cb(uv_work_t* req, int status) {
+  uv_work_timing_t timing;
+
+  ASSERT(status == 0);
+  ASSERT(0 == uv_req_get_work_timing((uv_req_t*) req, &timing));
+  ASSERT(timing.queued_at > 0);
+  ASSERT(timing.started_at >= timing.queued_at);
+  ASSERT(timing.finished_at >= timing.started_at + 10 * 1000 * 1000);
+  ASSERT(timing.finished_at <= uv_hrtime());
+  io_done_count++;
+}
+
+
+TEST_IMPL(threadpool_work_timing) {
+  uv_work_timing_t timing;
+  uv_connect_t connect_req;
+
+  ASSERT(0 == uv_queue_work_kind(uv_default_loop(),
+                                 &io_req,
+                                 UV_WORK_FAST_IO,
+                                 timing_work_cb,
+                                 timing_done_cb));
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(io_done_count == 1);
+
+  /* The timing is released once the callback returned. */
+  ASSERT(UV_ENOENT == uv_req_get_work_timing((uv_req_t*) &io_req, &timing));
+
+  /* Only requests that run on the threadpool have a timing. */
+  connect_req.type = UV_CONNECT;
+  ASSERT(UV_EINVAL == uv_req_get_work_timing((uv_req_t*) &connect_req,
+                                             &timing));
+  ASSERT(UV_EINVAL == uv_req_get_work_timing((uv_req_t*) &io_req, NULL));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -230,6 +230,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
             'src/unix/procfs-exepath.c',
@@ -244,6 +245,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
             'src/unix/pthread-fixes.c',
@@ -381,6 +383,7 @@
         'test/test-fs.c',
         'test/test-fs-copyfile.c',
         'test/test-fs-event.c',
+        'test/test-fs-iouring.c',
         'test/test-getters-setters.c',
         'test/test-get-currentexe.c',
         'test/test-get-memory.c',
@@ -467,6 +470,7 @@
         'test/test-tcp-write-queue-order.c',
         'test/test-threadpool.c',
         'test/test-threadpool-cancel.c',
+        'test/test-threadpool-kind.c',
         'test/test-thread-equal.c',
         'test/test-tmpdir.c',
         'test/test-mutexes.c',
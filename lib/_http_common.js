@@ -40,11 +40,8 @@ const kOnBody = HTTPParser.kOnBody | 0;
 const kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
 const kOnExecute = HTTPParser.kOnExecute | 0;
 
-// Only called in the slow case where slow means
-// that the request headers were either fragmented
-// across multiple TCP packets or too large to be
-// processed in a single run. This method is also
-// called to process trailing HTTP headers.
+// Only called to process trailing HTTP headers, the headers of the message
+// itself are all passed to parserOnHeadersComplete().
 function parserOnHeaders(headers, url) {
   // Once we exceeded headers limit - stop collecting them
   // 
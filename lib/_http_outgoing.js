@@ -36,6 +36,7 @@ const { nextTick } = require('internal/process/next_tick');
 const errors = require('internal/errors');
 
 const { CRLF, debug } = common;
+const { serializeHeaders } = process.binding('http_serializer');
 const { utcDate } = internalHttp;
 
 const kIsCorked = Symbol('isCorked');
@@ -300,15 +301,20 @@ function _storeHeader(firstLine, headers) {
     expect: false,
     trailer: false,
     upgrade: false,
-    header: firstLine
+    header: ''
   };
 
+  // Flat list of names and values, serialized by the native side in one go.
+  var fields = [];
+  var validate = true;
   var field;
   var key;
   var value;
   var i;
   var j;
   if (headers === this[outHeadersKey]) {
+    // Already validated by setHeader().
+    validate = false;
     for (key in headers) {
       var entry = headers[key];
       field = entry[0];
@@ -317,12 +323,12 @@ function _storeHeader(firstLine, headers) {
       if (value instanceof Array) {
         if (value.length < 2 || !isCookieField(field)) {
           for (j = 0; j < value.length; j++)
-            storeHeader(this, state, field, value[j], false);
+            fields.push(field, value[j]);
           continue;
         }
         value = value.join('; ');
       }
-      storeHeader(this, state, field, value, false);
+      fields.push(field, value);
     }
   } else if (headers instanceof Array) {
     for (i = 0; i < headers.length; i++) {
@@ -330,11 +336,10 @@ function _storeHeader(firstLine, headers) {
       value = headers[i][1];
 
       if (value instanceof Array) {
-        for (j = 0; j < value.length; j++) {
-          storeHeader(this, state, field, value[j], true);
-        }
+        for (j = 0; j < value.length; j++)
+          fields.push(field, value[j]);
       } else {
-        storeHeader(this, state, field, value, true);
+        fields.push(field, value);
       }
     }
   } else if (headers) {
@@ -346,15 +351,29 @@ function _storeHeader(firstLine, headers) {
       if (value instanceof Array) {
         if (value.length < 2 || !isCookieField(field)) {
           for (j = 0; j < value.length; j++)
-            storeHeader(this, state, field, value[j], true);
+            fields.push(field, value[j]);
           continue;
         }
         value = value.join('; ');
       }
-      storeHeader(this, state, field, value, true);
+      fields.push(field, value);
     }
   }
 
+  var matched = [];
+  var header = serializeHeaders(firstLine, fields, validate, matched);
+  if (typeof header === 'number') {
+    // The field at that index is invalid. validateHeader() throws the more
+    // specific error, and if it does not agree, the index must still never
+    // be sent as the header.
+    const name = fields[header];
+    validateHeader(name, fields[header + 1]);
+    throw new errors.TypeError('ERR_INVALID_CHAR', 'header content', name);
+  }
+  for (i = 0; i < matched.length; i++)
+    matchHeader(this, state, fields[matched[i]], fields[matched[i] + 1]);
+  state.header = header;
+
   // Are we upgrading the connection?
   if (state.connUpgrade && state.upgrade)
     this.upgrading = true;
@@ -435,14 +454,6 @@ function _storeHeader(firstLine, headers) {
   if (state.expect) this._send('');
 }
 
-function storeHeader(self, state, key, value, validate) {
-  if (validate) {
-    validateHeader(key, value);
-  }
-  state.header += key + ': ' + escapeHeaderValue(value) + CRLF;
-  matchHeader(self, state, key, value);
-}
-
 function matchConnValue(self, state, value) {
   var sawClose = false;
   var m = RE_CONN_VALUES.exec(value);
@@ -664,10 +675,17 @@ function write_(msg, chunk, encoding, callback, fromEnd) {
     else
       len = chunk.length;
 
-    msg._send(len.toString(16), 'latin1', null);
-    msg._send(crlf_buf, null, null);
-    msg._send(chunk, encoding, null);
-    ret = msg._send(crlf_buf, null, callback);
+    // Frame the chunk with as few writes as possible, strings in an
+    // ASCII-compatible encoding can carry the framing themselves.
+    if (typeof chunk === 'string' &&
+        (encoding === 'utf8' || encoding === 'latin1' || !encoding)) {
+      ret = msg._send(`${len.toString(16)}\r\n${chunk}\r\n`, encoding,
+                      callback);
+    } else {
+      msg._send(`${len.toString(16)}\r\n`, 'latin1', null);
+      msg._send(chunk, encoding, null);
+      ret = msg._send(crlf_buf, null, callback);
+    }
   } else {
     ret = msg._send(chunk, encoding, callback);
   }
@@ -36,13 +36,14 @@ const {
   _checkInvalidHeaderChar: checkInvalidHeaderChar
 } = require('_http_common');
 const { OutgoingMessage } = require('_http_outgoing');
-const { outHeadersKey, ondrain } = require('internal/httnternal/httpp');
+const { outHeadersKey, ondrain } = require('internal/http');
 const {
   defaultTriggerAsyncIdScope,
   getOrSetAsyncId
 } = require('internal/async_hooks');
 const errors = require('internal/errors');
 const Buffer = require('buffer').Buffer;
+const { createSendFileChunk } = require('internal/net');
 
 const STATUS_CODES = {
   100: 'Continue',
@@ -184,6 +185,17 @@ ServerResponse.prototype.writeContinue = function writeContinue(cb) {
   this._sent100 = true;
 };
 
+// Writes `length` bytes of the file `fd`, starting at `offset`, as part of the
+// body. The bytes are queued like a regular write() but go from the file to
+// the socket with sendfile(2), see net.Socket#sendFile().
+ServerResponse.prototype.sendFile = function sendFile(fd, offset, length, cb) {
+  if (typeof length !== 'number') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'length', 'number',
+                               length);
+  }
+  return this.write(createSendFileChunk(fd, offset, length), cb);
+};
+
 ServerResponse.prototype._implicitHeader = function _implicitHeader() {
   this.writeHead(this.statusCode);
 };
@@ -221,6 +233,7 @@ function writeHead(statusCode, reason, obj) {
         if (k) this.setHeader(k, obj[k]);
       }
     }
+    if (k === undefined && this._header) {
       throw new errors.Error('ERR_HTTP_HEADERS_SENT', 'render');
     }
     // only progressive api is used
@@ -40,12 +40,16 @@ const {
   SecureContext: NativeSecureContext
 } = process.binding('crypto');
 const errors = require('internal/errors');
+const kAsyncHandshake = Symbol('async-handshake');
+const kCoalesceWrites = Symbol('coalesce-writes');
 const kConnectOptions = Symbol('connect-options');
 const kDisableRenegotiation = Symbol('disable-renegotiation');
 const kErrorEmitted = Symbol('error-emitted');
 const kHandshakeTimeout = Symbol('handshake-timeout');
+const kKernelTLS = Symbol('kernel-tls');
 const kRes = Symbol('res');
 const kSNICallback = Symbol('snicallback');
+const kSharedSessionCacheSize = 16 * 1024 * 1024;
 
 const noop = () => {};
 
@@ -529,6 +533,15 @@ TLSSocket.prototype._init = function(socket, wrap) {
     ssl.setALPNProtocols(ssl._secureContext.alpnBuffer);
   }
 
+  if (options.coalesceWrites === false)
+    ssl.setCoalesceWrites(false);
+
+  if (options.kernelTLS)
+    ssl.enableKernelTLS();
+
+  if (options.isServer && options.asyncHandshake)
+    ssl.enableAsyncHandshake();
+
   if (options.handshakeTimeout > 0)
     this.setTimeout(options.handshakeTimeout, this._handleTimeout);
 
@@ -591,6 +604,10 @@ TLSSocket.prototype.setMaxSendFragment = function setMaxSendFragment(size) {
   return this._handle.setMaxSendFragment(size) === 1;
 };
 
+TLSSocket.prototype.setCoalesceWrites = function setCoalesceWrites(enable) {
+  this._handle.setCoalesceWrites(enable !== false);
+};
+
 TLSSocket.prototype.getTLSTicket = function getTLSTicket() {
   return this._handle.getTLSTicket();
 };
@@ -721,6 +738,13 @@ TLSSocket.prototype.getProtocol = function() {
   return null;
 };
 
+TLSSocket.prototype.isKernelTLS = function() {
+  if (this._handle)
+    return this._handle.isKernelTLS();
+
+  return false;
+};
+
 // TODO: support anonymous (nocert) and PSK
 
 
@@ -770,6 +794,9 @@ function tlsConnectionListener(rawSocket) {
     requestCert: this.requestCert,
     rejectUnauthorized: this.rejectUnauthorized,
     handshakeTimeout: this[kHandshakeTimeout],
+    coalesceWrites: this[kCoalesceWrites],
+    kernelTLS: this[kKernelTLS],
+    asyncHandshake: this[kAsyncHandshake],
     NPNProtocols: this.NPNProtocols,
     ALPNProtocols: this.ALPNProtocols,
     SNICallback: this[kSNICallback] || SNICallback
@@ -886,6 +913,9 @@ function Server(options, listener) {
 
   this[kHandshakeTimeout] = options.handshakeTimeout || (120 * 1000);
   this[kSNICallback] = options.SNICallback;
+  this[kCoalesceWrites] = options.coalesceWrites !== false;
+  this[kKernelTLS] = options.kernelTLS === true;
+  this[kAsyncHandshake] = options.asyncHandshake === true;
 
   if (typeof this[kHandshakeTimeout] !== 'number') {
     throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'timeout', 'number');
@@ -899,6 +929,26 @@ function Server(options, listener) {
     sharedCreds.context.setTicketKeys(this.ticketKeys);
   }
 
+  if (options.sharedSessionCache != null) {
+    const cache = options.sharedSessionCache;
+    if (typeof cache !== 'object') {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'sharedSessionCache',
+                                 'Object');
+    }
+    if (typeof cache.path !== 'string') {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE',
+                                 'sharedSessionCache.path', 'string');
+    }
+    const size = cache.size === undefined ? kSharedSessionCacheSize :
+      cache.size;
+    if (!Number.isSafeInteger(size) || size <= 0) {
+      throw new errors.RangeError('ERR_OUT_OF_RANGE',
+                                  'sharedSessionCache.size',
+                                  'a positive integer', size);
+    }
+    sharedCreds.context.setSharedSessionCache(cache.path, size);
+  }
+
   // constructor call
   net.Server.call(this, tlsConnectionListener);
 
@@ -936,6 +986,28 @@ Server.prototype.setTicketKeys = function setTicketKeys(keys) {
 };
 
 
+Server.prototype.getSessionCacheStats = function getSessionCacheStats() {
+  const fields =
+    new Float64Array(NativeSecureContext.kSessionCacheStatsFieldsCount);
+  if (!this._sharedCreds.context.getSessionCacheStats(fields))
+    return null;
+  const [
+    hits, misses, stores, evictions, oversized, entries, capacity
+  ] = fields;
+  const lookups = hits + misses;
+  return {
+    hits,
+    misses,
+    stores,
+    evictions,
+    oversized,
+    entries,
+    capacity,
+    hitRatio: lookups > 0 ? hits / lookups : 0
+  };
+};
+
+
 Server.prototype.setOptions = function(options) {
   this.requestCert = options.requestCert === true;
   this.rejectUnauthorized = options.rejectUnauthorized !== false;
@@ -1129,7 +1201,9 @@ exports.connect = function(...args /* [port,] [host,] [options,] [cb] */) {
     session: options.session,
     NPNProtocols: options.NPNProtocols,
     ALPNProtocols: options.ALPNProtocols,
-    requestOCSP: options.requestOCSP
+    requestOCSP: options.requestOCSP,
+    coalesceWrites: options.coalesceWrites,
+    kernelTLS: options.kernelTLS
   });
 
   socket[kConnectOptions] = options;
@@ -27,6 +27,7 @@ const { Buffer } = require('buffer');
 const dns = require('dns');
 const util = require('util');
 const { isUint8Array } = require('internal/util/types');
+const { isIPv4, isIPv6 } = require('internal/net');
 const EventEmitter = require('events');
 const { defaultTriggerAsyncIdScope } = require('internal/async_hooks');
 const { UV_UDP_REUSEADDR } = process.binding('constants').os;
@@ -42,6 +43,9 @@ const BIND_STATE_BOUND = 2;
 const RECV_BUFFER = true;
 const SEND_BUFFER = false;
 
+// Keep in sync with kMaxRecvBatch in src/udp_wrap.cc.
+const MAX_RECV_BATCH = 1024;
+
 // Lazily loaded
 var cluster = null;
 
@@ -76,6 +80,7 @@ function newHandle(type, lookup) {
     handle.lookup = lookup6.bind(handle, lookup);
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -113,6 +118,15 @@ function Socket(type, listener) {
     lookup = options.lookup;
     this[kOptionSymbol].recvBufferSize = options.recvBufferSize;
     this[kOptionSymbol].sendBufferSize = options.sendBufferSize;
+    if (options.recvBatch !== undefined) {
+      const recvBatch = options.recvBatch;
+      if (!Number.isInteger(recvBatch) ||
+          recvBatch < 1 || recvBatch > MAX_RECV_BATCH) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'recvBatch', recvBatch);
+      }
+      this[kOptionSymbol].recvBatch = recvBatch;
+    }
   }
 
   var handle = newHandle(type, lookup);
@@ -141,6 +155,10 @@ function createSocket(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  if (socket[kOptionSymbol].recvBatch > 1) {
+    socket._handle.onmessages = onMessages;
+    socket._handle.setRecvBatch(socket[kOptionSymbol].recvBatch);
+  }
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -162,6 +180,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -496,6 +515,104 @@ function doSend(ex, self, ip, list, address, port, callback) {
   }
 }
 
+Socket.prototype.sendBatch = function(messages, callback) {
+  if (!Array.isArray(messages)) {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'messages', 'Array');
+  }
+
+  const isIP = this.type === 'udp4' ? isIPv4 : isIPv6;
+  const defaultAddress = this.type === 'udp4' ? '127.0.0.1' : '::1';
+  const list = new Array(messages.length);
+  const ports = new Array(messages.length);
+  const addresses = new Array(messages.length);
+  var bytes = 0;
+
+  for (var i = 0; i < messages.length; i++) {
+    const message = messages[i];
+    if (message === null || typeof message !== 'object') {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE',
+                                 `messages[${i}]`, 'Object');
+    }
+
+    var msg = message.msg;
+    if (typeof msg === 'string') {
+      msg = Buffer.from(msg);
+    } else if (!isUint8Array(msg)) {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE',
+                                 `messages[${i}].msg`,
+                                 ['Buffer', 'Uint8Array', 'string']);
+    }
+
+    const port = message.port >>> 0;
+    if (port === 0 || port > 65535)
+      throw new errors.RangeError('ERR_SOCKET_BAD_PORT', message.port);
+
+    // Addresses are not resolved, looking them up one by one would defeat
+    // the purpose of sending the datagrams in a single system call.
+    const address = message.address || defaultAddress;
+    if (typeof address !== 'string' || !isIP(address.split('%')[0]))
+      throw new errors.TypeError('ERR_INVALID_IP_ADDRESS', address);
+
+    list[i] = msg;
+    ports[i] = port;
+    addresses[i] = address;
+    bytes += msg.length;
+  }
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  this._healthCheck();
+
+  if (this._bindState === BIND_STATE_UNBOUND)
+    this.bind({ port: 0, exclusive: true }, null);
+
+  if (this._bindState !== BIND_STATE_BOUND) {
+    enqueue(this, doSendBatch.bind(null, this, list, ports, addresses, bytes,
+                                   callback));
+    return;
+  }
+
+  defaultTriggerAsyncIdScope(
+    this[async_id_symbol],
+    doSendBatch,
+    this, list, ports, addresses, bytes, callback
+  );
+};
+
+function doSendBatch(self, list, ports, addresses, bytes, callback) {
+  if (!self._handle)
+    return;
+
+  if (list.length === 0) {
+    if (callback)
+      process.nextTick(callback, null, 0);
+    return;
+  }
+
+  var req = new SendWrap();
+  req.list = list;  // Keep reference alive.
+  if (callback) {
+    req.callback = callback;
+    req.oncomplete = afterSendBatch;
+  }
+
+  const sent = self._handle.sendBatch(req, list, ports, addresses, !!callback);
+
+  if (sent < 0) {
+    // Like send(), don't emit as error.
+    if (callback)
+      process.nextTick(callback, errnoException(sent, 'sendmmsg'));
+  } else if (sent === list.length && callback) {
+    // Every datagram was written synchronously.
+    process.nextTick(callback, null, bytes);
+  }
+}
+
+function afterSendBatch(err, sent) {
+  this.callback(err ? errnoException(err, 'sendmmsg') : null, sent);
+}
+
 function afterSend(err, sent) {
   if (err) {
     err = exceptionWithHostPort(err, 'send', this.address, this.port);
@@ -662,6 +779,26 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+// `entries` holds (offset, length, rinfo) triples describing the datagrams
+// that were copied into `buf`.
+function onMessages(handle, buf, entries) {
+  var self = handle.owner;
+  for (var i = 0; i < entries.length; i += 3)
+    entries[i + 2].size = entries[i + 1];
+
+  if (self.listenerCount('messages') > 0) {
+    self.emit('messages', buf, entries);
+    return;
+  }
+
+  for (i = 0; i < entries.length && self._handle; i += 3) {
+    const offset = entries[i];
+    self.emit('message', buf.slice(offset, offset + entries[i + 1]),
+              entries[i + 2]);
+  }
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
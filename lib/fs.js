@@ -44,6 +44,9 @@ const { getPathFromURL } = require('internal/url');
 const internalUtil = require('internal/util');
 const {
   assertEncoding,
+  Dirent,
+  getDirents,
+  getDirentsSync,
   stringToFlags
 } = internalFS;
 
@@ -343,13 +346,15 @@ Stats.prototype.isSocket = function() {
 
 const statValues = binding.statValues;
 
-function statsFromValues() {
-  return new Stats(statValues[0], statValues[1], statValues[2], statValues[3],
-                   statValues[4], statValues[5],
-                   statValues[6] < 0 ? undefined : statValues[6], statValues[7],
-                   statValues[8], statValues[9] < 0 ? undefined : statValues[9],
-                   statValues[10], statValues[11], statValues[12],
-                   statValues[13]);
+function statsFromValues(values = statValues, offset = 0) {
+  return new Stats(values[offset + 0], values[offset + 1],
+                   values[offset + 2], values[offset + 3],
+                   values[offset + 4], values[offset + 5],
+                   values[offset + 6] < 0 ? undefined : values[offset + 6],
+                   values[offset + 7], values[offset + 8],
+                   values[offset + 9] < 0 ? undefined : values[offset + 9],
+                   values[offset + 10], values[offset + 11],
+                   values[offset + 12], values[offset + 13]);
 }
 
 // Don't allow mode to accidentally be overwritten.
@@ -461,179 +466,21 @@ fs.readFile = function(path, options, callback) {
   if (!nullCheck(path, callback))
     return;
 
-  var context = new ReadFileContext(callback, options.encoding);
-  // 传进来的是不是文件描述符
-  context.isUserFd = isFd(path); // file descriptor ownership
-  var req = new FSReqWrap();
-  req.context = context;
-  req.oncomplete = readFileAfterOpen;
-  // 如果传进来的是文件描述符，则下一次事件循环直接出发oncomplete事件
-  if (context.isUserFd) {
-    process.nextTick(function() {
-      req.oncomplete(null, path);
-    });
-    return;
+  // 传进来的是文件描述符时从当前位置读起，读完也不关闭
+  if (!isFd(path)) {
+    validatePath(path);
+    path = pathModule.toNamespacedPath(path);
   }
 
-  validatePath(path);
-  // 否则执行open操作
-  binding.open(pathModule.toNamespacedPath(path),
-               stringToFlags(options.flag || 'r'),
-               0o666,
-               req);
-};
-
-const kReadFileBufferLength = 8 * 1024;
-
-function ReadFileContext(callback, encoding) {
-  this.fd = undefined;
-  this.isUserFd = undefined;
-  this.size = undefined;
-  this.callback = callback;
-  this.buffers = null;
-  this.buffer = null;
-  this.pos = 0;
-  this.encoding = encoding;
-  this.err = null;
-}
-
-ReadFileContext.prototype.read = function() {
-  var buffer;
-  var offset;
-  var length;
-
-  if (this.size === 0) {
-    buffer = this.buffer = Buffer.allocUnsafeSlow(kReadFileBufferLength);
-    offset = 0;
-    length = kReadFileBufferLength;
-  } else {
-    buffer = this.buffer;
-    offset = this.pos;
-    length = Math.min(kReadFileBufferLength, this.size - this.pos);
-  }
-  // 发送读数据请求
-  var req = new FSReqWrap();
-  req.oncomplete = readFileAfterRead;
-  req.context = this;
-
-  binding.read(this.fd, buffer, offset, length, -1, req);
-};
-
-ReadFileContext.prototype.close = function(err) {
-  var req = new FSReqWrap();
-  req.oncomplete = readFileAfterClose;
-  req.context = this;
-  this.err = err;
-
-  if (this.isUserFd) {
-    process.nextTick(function() {
-      req.oncomplete(null);
-    });
-    return;
-  }
-
-  binding.close(this.fd, req);
+  // open、fstat、read和close在线程池的同一个任务里完成，完成后只回调一次
+  const req = new FSReqWrap();
+  req.oncomplete = callback;
+  binding.readFile(path,
+                   stringToFlags(options.flag || 'r'),
+                   options.encoding || undefined,
+                   req);
 };
 
-function readFileAfterOpen(err, fd) {
-  var context = this.context;
-  // 出错直接执行业务层回调
-  if (err) {
-    context.callback(err);
-    return;
-  }
-  // 记录打开的文件描述符
-  context.fd = fd;
-  // 发起获取文件属性的请求
-  var req = new FSReqWrap();
-  req.oncomplete = readFileAfterStat;
-  req.context = context;
-  binding.fstat(fd, req);
-}
-
-function readFileAfterStat(err) {
-  var context = this.context;
-
-  if (err)
-    return context.close(err);
-
-  // Use stats array directly to avoid creating an fs.Stats instance just for
-  // our internal use.
-  var size;
-  if ((statValues[1/*mode*/] & S_IFMT) === S_IFREG)
-    size = context.size = statValues[8/*size*/];
-  else
-    size = context.size = 0;
-
-  if (size === 0) {
-    context.buffers = [];
-    context.read();
-    return;
-  }
-  // 文件太大
-  if (size > kMaxLength) {
-    err = new RangeError('File size is greater than possible Buffer: ' +
-                         `0x${kMaxLength.toString(16)} bytes`);
-    return context.close(err);
-  }
-
-  try {
-    context.buffer = Buffer.allocUnsafeSlow(size);
-  } catch (err) {
-    return context.close(err);
-  }
-  // 执行读操作
-  context.read();
-}
-
-function readFileAfterRead(err, bytesRead) {
-  var context = this.context;
-
-  if (err)
-    return context.close(err);
-
-  if (bytesRead === 0)
-    return context.close();
-
-  context.pos += bytesRead;
-
-  if (context.size !== 0) {
-    if (context.pos === context.size)
-      context.close();
-    else
-      context.read();
-  } else {
-    // unknown size, just read until we don't get bytes.
-    context.buffers.push(context.buffer.slice(0, bytesRead));
-    context.read();
-  }
-}
-
-function readFileAfterClose(err) {
-  var context = this.context;
-  var buffer = null;
-  var callback = context.callback;
-
-  if (context.err || err)
-    return callback(context.err || err);
-
-  try {
-    if (context.size === 0)
-      buffer = Buffer.concat(context.buffers, context.pos);
-    else if (context.pos < context.size)
-      buffer = context.buffer.slice(0, context.pos);
-    else
-      buffer = context.buffer;
-
-    if (context.encoding)
-      buffer = buffer.toString(context.encoding);
-  } catch (err) {
-    return callback(err);
-  }
-
-  callback(null, buffer);
-}
-
 function tryStatSync(fd, isUserFd) {
   const ctx = {};
   binding.fstat(fd, undefined, ctx);
@@ -1055,6 +902,73 @@ fs.fsyncSync = function(fd) {
   }
 };
 
+// 顺序和src/node_file.cc里的MMapAdvice一致
+const kMMapAdvice = ['normal', 'random', 'sequential', 'willneed', 'dontneed'];
+const kMMapShared = 1 << 0;
+const kMMapPopulate = 1 << 1;
+const kMMapHugePages = 1 << 2;
+
+// 把文件映射到内存，返回的Buffer直接指向映射的内存，被gc时解除映射
+fs.mmap = function(fd, offset = 0, length, options = {}) {
+  validateUint32(fd, 'fd');
+  if (typeof offset !== 'number')
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'offset', 'number');
+  if (!Number.isSafeInteger(offset) || offset < 0) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'offset',
+                                '>= 0 and <= Number.MAX_SAFE_INTEGER', offset);
+  }
+  if (options === null || typeof options !== 'object')
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'options', 'Object');
+
+  const { readonly = true, populate = false, hugepages = false } = options;
+  const advice = kMMapAdvice.indexOf(
+    options.advice === undefined ? 'normal' : options.advice);
+  if (typeof readonly !== 'boolean')
+    throw new errors.TypeError('ERR_INVALID_OPT_VALUE', 'readonly', readonly);
+  if (typeof populate !== 'boolean')
+    throw new errors.TypeError('ERR_INVALID_OPT_VALUE', 'populate', populate);
+  if (typeof hugepages !== 'boolean')
+    throw new errors.TypeError('ERR_INVALID_OPT_VALUE', 'hugepages', hugepages);
+  if (advice === -1) {
+    throw new errors.TypeError('ERR_INVALID_OPT_VALUE', 'advice',
+                               options.advice);
+  }
+
+  // 默认映射从offset到文件末尾的内容
+  let stats;
+  if (length === undefined) {
+    stats = fs.fstatSync(fd);
+    length = Math.max(stats.size - offset, 0);
+  }
+  if (typeof length !== 'number')
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'length', 'number');
+  if (!Number.isSafeInteger(length) || length < 0 || length > kMaxLength) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'length',
+                                `>= 0 and <= ${kMaxLength}`, length);
+  }
+  if (length === 0)
+    return Buffer.alloc(0);
+  // 访问文件末尾之后的页会触发SIGBUS，普通文件不能映射超出文件大小的部分
+  if (stats === undefined)
+    stats = fs.fstatSync(fd);
+  if (stats.isFile() && offset + length > stats.size) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'offset + length',
+                                `<= ${stats.size}`, offset + length);
+  }
+
+  let flags = 0;
+  if (!readonly) flags |= kMMapShared;
+  if (populate) flags |= kMMapPopulate;
+  if (hugepages) flags |= kMMapHugePages;
+
+  const ctx = {};
+  const buffer = binding.mmap(fd, offset, length, flags, advice, ctx);
+  if (ctx.errno !== undefined) {
+    throw new errors.uvException(ctx);
+  }
+  return buffer;
+};
+
 fs.mkdir = function(path, mode, callback) {
   if (typeof mode === 'function') callback = mode;
   callback = makeCallback(callback);
@@ -1090,8 +1004,19 @@ fs.readdir = function(path, options, callback) {
   validatePath(path);
 
   const req = new FSReqWrap();
-  req.oncomplete = callback;
-  binding.readdir(pathModule.toNamespacedPath(path), options.encoding, req);
+  if (!options.withFileTypes) {
+    req.oncomplete = callback;
+  } else {
+    req.oncomplete = (err, result) => {
+      if (err) {
+        callback(err);
+        return;
+      }
+      getDirents(path, result, callback);
+    };
+  }
+  binding.readdir(pathModule.toNamespacedPath(path), options.encoding,
+                  !!options.withFileTypes, req);
 };
 
 fs.readdirSync = function(path, options) {
@@ -1099,9 +1024,146 @@ fs.readdirSync = function(path, options) {
   handleError((path = getPathFromURL(path)));
   nullCheck(path);
   validatePath(path);
-  return binding.readdir(pathModule.toNamespacedPath(path), options.encoding);
+  const result = binding.readdir(pathModule.toNamespacedPath(path),
+                                 options.encoding, !!options.withFileTypes);
+  return options.withFileTypes ? getDirentsSync(path, result) : result;
+};
+
+fs.Dirent = Dirent;
+
+fs.walk = function(root, options) {
+  return new WalkStream(root, options);
 };
 
+// 每次最多把这么多个待扫描的目录交给一个线程池任务
+const kWalkMaxDirs = 256;
+const kStatsFields = 14;
+
+// 遍历目录树，每个chunk是一批带path属性的Dirent。扫描目录在线程池里进行，
+// 过滤和深度限制在js层，被过滤掉的目录不会被扫描
+function WalkStream(root, options) {
+  if (!(this instanceof WalkStream))
+    return new WalkStream(root, options);
+
+  options = copyObject(getOptions(options, {}));
+  handleError((root = getPathFromURL(root)));
+  nullCheck(root);
+  if (typeof root !== 'string') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'root',
+                               ['string', 'URL']);
+  }
+
+  const { filter } = options;
+  if (filter !== undefined && typeof filter !== 'function') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'options.filter',
+                               'Function', filter);
+  }
+
+  let { maxDepth } = options;
+  if (maxDepth === undefined) {
+    maxDepth = Infinity;
+  } else if (maxDepth !== Infinity &&
+             !(Number.isSafeInteger(maxDepth) && maxDepth >= 0)) {
+    throw new errors.RangeError('ERR_INVALID_OPT_VALUE', 'maxDepth',
+                                maxDepth);
+  }
+
+  options.objectMode = true;
+  options.highWaterMark = options.highWaterMark || 1;
+  Readable.call(this, options);
+
+  this.root = root;
+  this._filter = filter;
+  this._maxDepth = maxDepth;
+  this._followSymlinks = !!options.followSymlinks;
+  this._withStats = !!options.stats;
+
+  // 待扫描的目录和其中条目的深度
+  this._dirs = [root];
+  this._depths = [0];
+  // followSymlinks时用dev和ino检测环路
+  this._visited = this._followSymlinks ? new Set() : null;
+  this._scanning = false;
+}
+util.inherits(WalkStream, Readable);
+fs.WalkStream = WalkStream;
+
+WalkStream.prototype._read = function() {
+  if (this._scanning || this.destroyed)
+    return;
+
+  if (this._dirs.length === 0) {
+    this.push(null);
+    return;
+  }
+
+  this._scanning = true;
+  const dirs = this._dirs.slice(0, kWalkMaxDirs)
+    .map((dir) => pathModule.toNamespacedPath(dir));
+  const req = new FSReqWrap();
+  req.oncomplete = afterScanDirs;
+  req.stream = this;
+  binding.scanDirs(dirs, this._withStats, this._followSymlinks, req);
+};
+
+function afterScanDirs(err, result) {
+  const stream = this.stream;
+  stream._scanning = false;
+  if (stream.destroyed)
+    return;
+  if (err) {
+    stream.destroy(err);
+    return;
+  }
+
+  const [scanned, counts, names, types, stats, ids] = result;
+  const dirs = stream._dirs.splice(0, scanned);
+  const depths = stream._depths.splice(0, scanned);
+  const entries = [];
+  let entry = 0;
+
+  for (var i = 0; i < scanned; i++) {
+    const count = counts[i];
+    if (ids !== undefined) {
+      const id = `${ids[2 * i]}:${ids[2 * i + 1]}`;
+      if (stream._visited.has(id)) {
+        entry += count;
+        continue;
+      }
+      stream._visited.add(id);
+    }
+
+    const depth = depths[i];
+    for (var j = 0; j < count; j++, entry++) {
+      const dirent = new Dirent(names[entry], types[entry]);
+      dirent.path = pathModule.join(dirs[i], dirent.name);
+      if (stats !== undefined)
+        dirent.stats = statsFromValues(stats, entry * kStatsFields);
+      if (stream._filter !== undefined) {
+        let accepted;
+        try {
+          accepted = stream._filter(dirent);
+        } catch (err) {
+          stream.destroy(err);
+          return;
+        }
+        if (!accepted)
+          continue;
+      }
+      entries.push(dirent);
+      if (dirent.isDirectory() && depth < stream._maxDepth) {
+        stream._dirs.push(dirent.path);
+        stream._depths.push(depth + 1);
+      }
+    }
+  }
+
+  if (entries.length > 0)
+    stream.push(entries);
+  else
+    stream._read();
+}
+
 fs.fstat = function(fd, callback) {
   validateUint32(fd, 'fd');
   const req = new FSReqWrap();
@@ -7,7 +7,7 @@
 
 'use strict';
 
-(function(process) {
+(function(process, compiledNatives) {
   
   let internalBinding;
   const exceptionHandlerState = { captureFn: null };
@@ -574,9 +574,18 @@
   // node binary, so they can be loaded faster.
 
   const ContextifyScript = process.binding('contextify').ContextifyScript;
-  function runInThisContext(code, options) {
-    const script = new ContextifyScript(code, options);
-    return script.runInThisContext();
+
+  // When node starts from its startup snapshot, compiledNatives holds the
+  // wrapper functions of the core modules, which were compiled at build time.
+  // See src/node_snapshot.h. Each one is handed out once, so that it can be
+  // garbage collected after the module ran.
+  function takeCompiledNative(id) {
+    if (compiledNatives === undefined)
+      return undefined;
+    const fn = compiledNatives[id];
+    if (fn !== undefined)
+      delete compiledNatives[id];
+    return fn;
   }
 
   function NativeModule(id) {
@@ -671,18 +680,33 @@
     '\n});'
   ];
 
-  NativeModule.prototype.compile = function() {
-    var source = NativeModule.getSource(this.id);
-    source = NativeModule.wrap(source);
+  // The ids of the modules that were compiled from source, and of those for
+  // which V8 accepted the code cache that is built into the binary, see
+  // src/node_code_cache.h. Modules taken from the startup snapshot are in
+  // neither.
+  NativeModule.compiledWithCache = [];
+  NativeModule.compiledWithoutCache = [];
 
+  NativeModule.prototype.compile = function() {
     this.loading = true;
 
     try {
-      const fn = runInThisContext(source, {
-        filename: this.filename,
-        lineOffset: 0,
-        displayErrors: true
-      });
+      let fn = takeCompiledNative(this.id);
+      if (fn === undefined) {
+        const source = NativeModule.wrap(NativeModule.getSource(this.id));
+        const cachedData = internalBinding('code_cache').get(this.id);
+        const script = new ContextifyScript(source, {
+          filename: this.filename,
+          lineOffset: 0,
+          displayErrors: true,
+          cachedData
+        });
+        if (cachedData !== undefined && !script.cachedDataRejected)
+          NativeModule.compiledWithCache.push(this.id);
+        else
+          NativeModule.compiledWithoutCache.push(this.id);
+        fn = script.runInThisContext();
+      }
       const requireFn = this.id.startsWith('internal/deps/') ?
         NativeModule.requireForDeps :
         NativeModule.require;
@@ -700,4 +724,4 @@
   };
 
   startup();
-})(process);
+});
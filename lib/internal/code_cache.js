@@ -0,0 +1,13 @@
+'use strict';
+
+// Which built-in modules were compiled with the code cache that is built into
+// the binary, see src/node_code_cache.h. Used by tests and benchmarks.
+
+const NativeModule = require('native_module');
+const { hasCodeCache } = internalBinding('code_cache');
+
+module.exports = {
+  hasCodeCache,
+  compiledWithCache: NativeModule.compiledWithCache,
+  compiledWithoutCache: NativeModule.compiledWithoutCache
+};
@@ -4,6 +4,7 @@ const { Buffer } = require('buffer');
 const { Writable } = require('stream');
 const errors = require('internal/errors');
 const fs = require('fs');
+const pathModule = require('path');
 const util = require('util');
 
 const {
@@ -14,9 +15,20 @@ const {
   O_RDWR,
   O_SYNC,
   O_TRUNC,
-  O_WRONLY
+  O_WRONLY,
+  UV_DIRENT_UNKNOWN,
+  UV_DIRENT_FILE,
+  UV_DIRENT_DIR,
+  UV_DIRENT_LINK,
+  UV_DIRENT_FIFO,
+  UV_DIRENT_SOCKET,
+  UV_DIRENT_CHAR,
+  UV_DIRENT_BLOCK
 } = process.binding('constants').fs;
 
+const kType = Symbol('type');
+const kStats = Symbol('stats');
+
 function assertEncoding(encoding) {
   if (encoding && !Buffer.isEncoding(encoding)) {
     throw new errors.TypeError('ERR_INVALID_OPT_VALUE_ENCODING', encoding);
@@ -95,8 +107,120 @@ SyncWriteStream.prototype.destroy = function() {
   return true;
 };
 
+// Returned by fs.readdir() with `withFileTypes` and by fs.walk(). The type
+// comes from the directory entry itself, without a stat() per entry.
+class Dirent {
+  constructor(name, type) {
+    this.name = name;
+    this[kType] = type;
+  }
+
+  isDirectory() {
+    return this[kType] === UV_DIRENT_DIR;
+  }
+
+  isFile() {
+    return this[kType] === UV_DIRENT_FILE;
+  }
+
+  isBlockDevice() {
+    return this[kType] === UV_DIRENT_BLOCK;
+  }
+
+  isCharacterDevice() {
+    return this[kType] === UV_DIRENT_CHAR;
+  }
+
+  isSymbolicLink() {
+    return this[kType] === UV_DIRENT_LINK;
+  }
+
+  isFIFO() {
+    return this[kType] === UV_DIRENT_FIFO;
+  }
+
+  isSocket() {
+    return this[kType] === UV_DIRENT_SOCKET;
+  }
+}
+
+// Some file systems do not report the type in the directory entry, in which
+// case it is taken from lstat().
+class DirentFromStats extends Dirent {
+  constructor(name, stats) {
+    super(name, null);
+    this[kStats] = stats;
+  }
+}
+
+for (const name of Reflect.ownKeys(Dirent.prototype)) {
+  if (name === 'constructor') {
+    continue;
+  }
+  DirentFromStats.prototype[name] = function() {
+    return this[kStats][name]();
+  };
+}
+
+function direntPath(path, name) {
+  return pathModule.join(String(path), String(name));
+}
+
+// `result` is the [names, types] pair that binding.readdir() returns when
+// file types are requested.
+function getDirents(path, result, callback) {
+  const [names, types] = result;
+  const dirents = new Array(names.length);
+  let pending = 1;
+  let failed = false;
+
+  function done(err) {
+    if (failed)
+      return;
+    if (err) {
+      failed = true;
+      return callback(err);
+    }
+    if (--pending === 0)
+      callback(null, dirents);
+  }
+
+  for (var i = 0; i < names.length; i++) {
+    const name = names[i];
+    if (types[i] !== UV_DIRENT_UNKNOWN) {
+      dirents[i] = new Dirent(name, types[i]);
+      continue;
+    }
+    const index = i;
+    pending++;
+    fs.lstat(direntPath(path, name), (err, stats) => {
+      if (!err)
+        dirents[index] = new DirentFromStats(name, stats);
+      done(err);
+    });
+  }
+  done(null);
+}
+
+function getDirentsSync(path, result) {
+  const [names, types] = result;
+  const dirents = new Array(names.length);
+  for (var i = 0; i < names.length; i++) {
+    if (types[i] === UV_DIRENT_UNKNOWN) {
+      dirents[i] = new DirentFromStats(
+        names[i], fs.lstatSync(direntPath(path, names[i])));
+    } else {
+      dirents[i] = new Dirent(names[i], types[i]);
+    }
+  }
+  return dirents;
+}
+
 module.exports = {
   assertEncoding,
+  Dirent,
+  getDirents,
+  getDirentsSync,
   stringToFlags,
   SyncWriteStream,
   realpathCacheKey: Symbol('realpathCacheKey')
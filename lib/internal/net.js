@@ -1,6 +1,7 @@
 'use strict';
 
 const Buffer = require('buffer').Buffer;
+const errors = require('internal/errors');
 const { isIPv6 } = process.binding('cares_wrap');
 const { writeBuffer } = process.binding('fs');
 
@@ -46,11 +47,47 @@ function makeSyncWrite(fd) {
   };
 }
 
+const kSendFile = Symbol('sendFile');
+
+// Returns a placeholder chunk for `length` bytes of the file `fd`, starting at
+// `offset`, or for everything up to the end of the file if `length` is
+// undefined. The chunk is queued like any other Buffer so it keeps its place
+// among the surrounding writes; net.Socket turns it into a sendfile(2)
+// transfer once it is written. Its `length` is the size of the file range so
+// that writableLength, bytesWritten and HTTP chunked framing account for the
+// bytes it stands for.
+function createSendFileChunk(fd, offset, length) {
+  let err;
+
+  if (fd !== (fd | 0) || fd < 0) {
+    err = new errors.TypeError('ERR_INVALID_ARG_TYPE', 'fd', 'integer');
+  } else if (!Number.isSafeInteger(offset) || offset < 0) {
+    err = new errors.RangeError('ERR_OUT_OF_RANGE', 'offset');
+  } else if (length !== undefined &&
+             (!Number.isSafeInteger(length) || length < 0)) {
+    err = new errors.RangeError('ERR_OUT_OF_RANGE', 'length');
+  }
+
+  if (err !== undefined) {
+    Error.captureStackTrace(err, createSendFileChunk);
+    throw err;
+  }
+
+  const chunk = Buffer.alloc(0);
+  chunk[kSendFile] = { fd, offset, length };
+  Object.defineProperty(chunk, 'length', {
+    value: length === undefined ? 0 : length
+  });
+  return chunk;
+}
+
 module.exports = {
+  createSendFileChunk,
   isIP,
   isIPv4,
   isIPv6,
   isLegalPort,
   makeSyncWrite,
-  normalizedArgsSymbol: Symbol('normalizedArgs')
+  normalizedArgsSymbol: Symbol('normalizedArgs'),
+  sendFileSymbol: kSendFile
 };
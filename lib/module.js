@@ -33,8 +33,18 @@ const internalFS = require('internal/fs');
 const path = require('path');
 const {
   internalModuleReadJSON,
-  internalModuleStat
+  internalModuleStat,
+  internalModuleProbe,
+  setModuleStatCacheEnabled,
+  moduleResolveCacheAddFile,
+  moduleResolveCacheGet,
+  moduleResolveCacheSet,
+  moduleResolveCacheLoad,
+  moduleResolveCacheSave
 } = process.binding('fs');
+// 设置了--compile-cache-dir时，编译的结果(V8 code cache)保存在该目录，
+// 下次启动时源码没有变化的话就不用再重新编译，见src/compile_cache.h
+const { kCompileCache } = process.binding('contextify');
 const preserveSymlinks = !!process.binding('config').preserveSymlinks;
 const experimentalModules = !!process.binding('config').experimentalModules;
 
@@ -48,18 +58,21 @@ const ModuleJob = require('internal/loader/ModuleJob');
 const createDynamicModule = require('internal/loader/CreateDynamicModule');
 let ESMLoader;
 
+// 结果缓存在c++层，见src/module_resolve_cache.h
 function stat(filename) {
-  filename = path.toNamespacedPath(filename);
-  const cache = stat.cache;
-  if (cache !== null) {
-    const result = cache.get(filename);
-    if (result !== undefined) return result;
-  }
-  const result = internalModuleStat(filename);
-  if (cache !== null) cache.set(filename, result);
-  return result;
+  return internalModuleStat(path.toNamespacedPath(filename));
+}
+
+// 设置了NODE_MODULE_RESOLVE_CACHE时，模块路径的解析结果会保存到这个文件，
+// 下次启动时从文件加载，相关目录没有变化的话就不用再查找文件系统
+const resolveCacheFile = process.env.NODE_MODULE_RESOLVE_CACHE ?
+  path.resolve(process.env.NODE_MODULE_RESOLVE_CACHE) : null;
+if (resolveCacheFile !== null) {
+  moduleResolveCacheLoad(path.toNamespacedPath(resolveCacheFile));
+  process.on('exit', () => {
+    moduleResolveCacheSave(path.toNamespacedPath(resolveCacheFile));
+  });
 }
-stat.cache = null;
 
 function updateChildren(parent, child, scan) {
   var children = parent && parent.children;
@@ -119,8 +132,14 @@ const packageMainCache = Object.create(null);
 
 function readPackage(requestPath) {
   const entry = packageMainCache[requestPath];
-  if (entry)
+  if (entry) {
+    // 缓存的解析结果也依赖这个package.json，它的"main"可能在下次启动前改变
+    if (resolveCacheFile !== null) {
+      const jsonPath = path.resolve(requestPath, 'package.json');
+      moduleResolveCacheAddFile(path.toNamespacedPath(jsonPath));
+    }
     return entry;
+  }
 
   const jsonPath = path.resolve(requestPath, 'package.json');
   const json = internalModuleReadJSON(path.toNamespacedPath(jsonPath));
@@ -164,10 +183,14 @@ const realpathCache = new Map();
 // absolute realpath.
 function tryFile(requestPath, isMain) {
   const rc = stat(requestPath);
+  return rc === 0 && resolvedPath(requestPath, isMain);
+}
+
+function resolvedPath(requestPath, isMain) {
   if (preserveSymlinks && !isMain) {
-    return rc === 0 && path.resolve(requestPath);
+    return path.resolve(requestPath);
   }
-  return rc === 0 && toRealPath(requestPath);
+  return toRealPath(requestPath);
 }
 
 function toRealPath(requestPath) {
@@ -178,14 +201,9 @@ function toRealPath(requestPath) {
 
 // given a path, check if the file exists with any of the set extensions
 function tryExtensions(p, exts, isMain) {
-  for (var i = 0; i < exts.length; i++) {
-    const filename = tryFile(p + exts[i], isMain);
-
-    if (filename) {
-      return filename;
-    }
-  }
-  return false;
+  // 一次binding调用检查所有扩展名
+  const i = internalModuleProbe(path.toNamespacedPath(p), exts);
+  return i !== -1 && resolvedPath(p + exts[i], isMain);
 }
 
 var warned = false;
@@ -202,6 +220,17 @@ Module._findPath = function(request, paths, isMain) {
   if (entry)
     return entry;
 
+  // 解析结果还依赖扩展名和是否保留软链接
+  var resolveCacheKey;
+  if (resolveCacheFile !== null) {
+    resolveCacheKey = cacheKey + '\x00' +
+                      Object.keys(Module._extensions).join('\x00') +
+                      (preserveSymlinks && !isMain ? '\x00p' : '');
+    entry = moduleResolveCacheGet(resolveCacheKey);
+    if (entry !== undefined)
+      return Module._pathCache[cacheKey] = entry;
+  }
+
   var exts;
   var trailingSlash = request.length > 0 &&
                       request.charCodeAt(request.length - 1) === 47/*/*/;
@@ -258,6 +287,8 @@ Module._findPath = function(request, paths, isMain) {
       }
 
       Module._pathCache[cacheKey] = filename;
+      if (resolveCacheKey !== undefined)
+        moduleResolveCacheSet(resolveCacheKey, filename);
       return filename;
     }
   }
@@ -651,7 +682,8 @@ Module.prototype._compile = function(content, filename) {
   var compiledWrapper = vm.runInThisContext(wrapper, {
     filename: filename,
     lineOffset: 0,
-    displayErrors: true
+    displayErrors: true,
+    [kCompileCache]: true
   });
 
   var inspectorWrapper = null;
@@ -674,7 +706,7 @@ Module.prototype._compile = function(content, filename) {
   var dirname = path.dirname(filename);
   var require = internalModule.makeRequireFunction(this);
   var depth = internalModule.requireDepth;
-  if (depth === 0) stat.cache = new Map();
+  if (depth === 0) setModuleStatCacheEnabled(true);
   var result;
   if (inspectorWrapper) {
     result = inspectorWrapper(compiledWrapper, this.exports, this.exports,
@@ -683,7 +715,7 @@ Module.prototype._compile = function(content, filename) {
     result = compiledWrapper.call(this.exports, this.exports, require, this,
                                   filename, dirname);
   }
-  if (depth === 0) stat.cache = null;
+  if (depth === 0) setModuleStatCacheEnabled(false);
   return result;
 };
 
@@ -26,12 +26,14 @@ const stream = require('stream');
 const util = require('util');
 const internalUtil = require('internal/util');
 const {
+  createSendFileChunk,
   isIP,
   isIPv4,
   isIPv6,
   isLegalPort,
   normalizedArgsSymbol,
-  makeSyncWrite
+  makeSyncWrite,
+  sendFileSymbol
 } = require('internal/net');
 const assert = require('assert');
 const {
@@ -46,7 +48,11 @@ const { TCP, constants: TCPConstants } = process.binding('tcp_wrap');
 const { Pipe, constants: PipeConstants } = process.binding('pipe_wrap');
 const { TCPConnectWrap } = process.binding('tcp_wrap');
 const { PipeConnectWrap } = process.binding('pipe_wrap');
-const { ShutdownWrap, WriteWrap } = process.binding('stream_wrap');
+const {
+  SendFileWrap,
+  ShutdownWrap,
+  WriteWrap
+} = process.binding('stream_wrap');
 const { async_id_symbol } = process.binding('async_wrap');
 const { newUid, defaultTriggerAsyncIdScope } = require('internal/async_hooks');
 const { nextTick } = require('internal/process/next_tick');
@@ -55,9 +61,15 @@ const dns = require('dns');
 
 const kLastWriteQueueSize = Symbol('lastWriteQueueSize');
 
+// Size of the reads that feed Socket#sendFile() when the handle cannot do
+// sendfile(2) itself.
+const kSendFileChunkSize = 64 * 1024;
+
 // `cluster` is only used by `listenInCluster` so for startup performance
 // reasons it's lazy loaded.
 var cluster = null;
+// `fs` is only used when Socket#sendFile() has to fall back to read/write.
+var fs = null;
 
 const errnoException = util._errnoException;
 const exceptionWithHostPort = util._exceptionWithHostPort;
@@ -801,6 +813,10 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
     this.destroy(new errors.Error('ERR_SOCKET_CLOSED'), cb);
     return false;
   }
+
+  if (!writev && data[sendFileSymbol] !== undefined)
+    return this._writeFile(data[sendFileSymbol], cb);
+
   // 新建一个写请求
   var req = new WriteWrap();
   req.handle = this._handle;
@@ -857,9 +873,112 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
 
 // 批量写
 Socket.prototype._writev = function(chunks, cb) {
+  for (var i = 0; i < chunks.length; i++) {
+    if (chunks[i].chunk[sendFileSymbol] !== undefined)
+      return writeChunksInOrder(this, chunks, 0, cb);
+  }
   this._writeGeneric(true, chunks, '', cb);
 };
 
+// A corked batch that contains Socket#sendFile() chunks cannot go out with a
+// single writev, write the entries one after the other instead.
+function writeChunksInOrder(socket, chunks, i, cb) {
+  if (i === chunks.length)
+    return cb();
+  const { chunk, encoding } = chunks[i];
+  socket._writeGeneric(false, chunk, encoding, (err) => {
+    if (err)
+      return cb(err);
+    writeChunksInOrder(socket, chunks, i + 1, cb);
+  });
+}
+
+
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  if (typeof offset === 'function') {
+    cb = offset;
+    offset = 0;
+  } else if (typeof length === 'function') {
+    cb = length;
+    length = undefined;
+  }
+  if (offset === undefined)
+    offset = 0;
+  return this.write(createSendFileChunk(fd, offset, length), cb);
+};
+
+
+Socket.prototype._writeFile = function(file, cb) {
+  // Handles that cannot do sendfile(2), like TLS sockets, get the file
+  // through regular writes.
+  if (typeof this._handle.sendFile !== 'function')
+    return writeFileChunk(this, file, file.offset, file.length, cb);
+
+  var req = new SendFileWrap();
+  req.handle = this._handle;
+  req.oncomplete = afterSendFile;
+  req.cb = cb;
+  var length = file.length === undefined ? -1 : file.length;
+  var err = this._handle.sendFile(req, file.fd, file.offset, length);
+  if (err)
+    this.destroy(errnoException(err, 'sendfile'), cb);
+};
+
+
+function afterSendFile(status, bytes) {
+  var self = this.handle.owner;
+  debug('afterSendFile', status, bytes);
+
+  if (self.destroyed)
+    return;
+
+  self._bytesDispatched += bytes;
+
+  if (status < 0) {
+    self.destroy(errnoException(status, 'sendfile'), this.cb);
+    return;
+  }
+
+  self._unrefTimer();
+  this.cb();
+}
+
+
+function writeFileChunk(socket, file, position, remaining, cb) {
+  var size = kSendFileChunkSize;
+  if (remaining !== undefined) {
+    if (remaining === 0)
+      return cb();
+    size = Math.min(remaining, size);
+  }
+
+  if (fs === null) fs = require('fs');
+  fs.read(file.fd, Buffer.allocUnsafe(size), 0, size, position, onread);
+
+  function onread(err, bytesRead, buffer) {
+    if (socket.destroyed)
+      return;
+    if (err)
+      return socket.destroy(err, cb);
+    if (bytesRead === 0) {
+      if (remaining === undefined)
+        return cb();
+      return socket.destroy(errnoException(UV_EOF, 'sendfile'), cb);
+    }
+
+    position += bytesRead;
+    if (remaining !== undefined)
+      remaining -= bytesRead;
+    socket._writeGeneric(false, buffer.slice(0, bytesRead), 'buffer', onwrite);
+  }
+
+  function onwrite(err) {
+    if (err)
+      return cb(err);
+    writeFileChunk(socket, file, position, remaining, cb);
+  }
+}
+
 // 单个写
 Socket.prototype._write = function(data, encoding, cb) {
   this._writeGeneric(false, data, encoding, cb);
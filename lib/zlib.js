@@ -43,6 +43,9 @@ const {
 } = constants;
 const { inherits } = require('util');
 
+// The largest threadpool libuv supports.
+const kMaxParallel = 128;
+
 // translation table for return codes.
 const codes = {
   Z_OK: constants.Z_OK,
@@ -169,6 +172,8 @@ function Zlib(opts, mode) {
   var memLevel = Z_DEFAULT_MEMLEVEL;
   var strategy = Z_DEFAULT_STRATEGY;
   var dictionary;
+  var parallel = 1;
+  var inlineThreshold = 0;
 
   if (typeof mode !== 'number')
     throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'mode', 'number');
@@ -262,6 +267,26 @@ function Zlib(opts, mode) {
       }
     }
 
+    inlineThreshold = opts.inlineThreshold;
+    if (inlineThreshold !== undefined) {
+      if (!Number.isInteger(inlineThreshold) || inlineThreshold < 0 ||
+          inlineThreshold > kMaxLength) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'inlineThreshold', inlineThreshold);
+      }
+    } else {
+      inlineThreshold = 0;
+    }
+
+    if (opts.parallel !== undefined && mode === GZIP) {
+      parallel = opts.parallel;
+      if (!Number.isInteger(parallel) || parallel < 1 ||
+          parallel > kMaxParallel) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'parallel', parallel);
+      }
+    }
+
     if (opts.encoding || opts.objectMode || opts.writableObjectMode) {
       opts = _extend({}, opts);
       opts.encoding = null;
@@ -271,21 +296,38 @@ function Zlib(opts, mode) {
   }
   Transform.call(this, opts);
   this.bytesRead = 0;
-  this._handle = new binding.Zlib(mode);
-  this._handle.jsref = this; // Used by processCallback() and zlibOnError()
-  this._handle.onerror = zlibOnError;
   this._hadError = false;
   this._writeState = new Uint32Array(2);
+  this._parallel = parallel;
+
+  var initialized;
+  if (parallel > 1) {
+    this._handle = new binding.ParallelGzip();
+    initialized = this._handle.init(windowBits,
+                                    level,
+                                    memLevel,
+                                    strategy,
+                                    parallel,
+                                    parallelCallback);
+  } else {
+    this._handle = new binding.Zlib(mode);
+    initialized = this._handle.init(windowBits,
+                                    level,
+                                    memLevel,
+                                    strategy,
+                                    this._writeState,
+                                    processCallback,
+                                    dictionary);
+  }
+  // Used by processCallback(), parallelCallback() and zlibOnError()
+  this._handle.jsref = this;
+  this._handle.onerror = zlibOnError;
 
-  if (!this._handle.init(windowBits,
-                         level,
-                         memLevel,
-                         strategy,
-                         this._writeState,
-                         processCallback,
-                         dictionary)) {
+  if (!initialized)
     throw new errors.Error('ERR_ZLIB_INITIALIZATION_FAILED');
-  }
+
+  if (inlineThreshold > 0 && parallel === 1)
+    this._handle.setInlineThreshold(inlineThreshold);
 
   this._outBuffer = Buffer.allocUnsafe(chunkSize);
   this._outOffset = 0;
@@ -509,6 +551,9 @@ function processChunk(self, chunk, flushFlag, cb) {
   if (!handle)
     return cb(new errors.Error('ERR_ZLIB_BINDING_CLOSED'));
 
+  if (self._parallel > 1)
+    return processChunkParallel(self, chunk, flushFlag, cb);
+
   handle.buffer = chunk;
   handle.cb = cb;
   handle.availOutBefore = self._chunkSize - self._outOffset;
@@ -516,13 +561,15 @@ function processChunk(self, chunk, flushFlag, cb) {
   handle.inOff = 0;
   handle.flushFlag = flushFlag;
 
-  handle.write(flushFlag,
-               chunk, // in
-               0, // in_off
-               handle.availInBefore, // in_len
-               self._outBuffer, // out
-               self._outOffset, // out_off
-               handle.availOutBefore); // out_len
+  var done = handle.write(flushFlag,
+                          chunk, // in
+                          0, // in_off
+                          handle.availInBefore, // in_len
+                          self._outBuffer, // out
+                          self._outOffset, // out_off
+                          handle.availOutBefore); // out_len
+  if (done)
+    processCallback.call(handle);
 }
 
 function processCallback() {
@@ -533,39 +580,44 @@ function processCallback() {
   var self = this.jsref;
   var state = self._writeState;
 
-  if (self._hadError) {
-    this.buffer = null;
-    return;
-  }
+  // Writes of inputs below the inline threshold complete synchronously, keep
+  // going until the chunk is done or a write has been queued.
+  while (true) {
+    if (self._hadError) {
+      this.buffer = null;
+      return;
+    }
 
-  if (self.destroyed) {
-    this.buffer = null;
-    return;
-  }
+    if (self.destroyed) {
+      this.buffer = null;
+      return;
+    }
 
-  var availOutAfter = state[0];
-  var availInAfter = state[1];
+    var availOutAfter = state[0];
+    var availInAfter = state[1];
 
-  var inDelta = (handle.availInBefore - availInAfter);
-  self.bytesRead += inDelta;
+    var inDelta = (handle.availInBefore - availInAfter);
+    self.bytesRead += inDelta;
 
-  var have = handle.availOutBefore - availOutAfter;
-  if (have > 0) {
-    var out = self._outBuffer.slice(self._outOffset, self._outOffset + have);
-    self._outOffset += have;
-    self.push(out);
-  } else if (have < 0) {
-    assert(false, 'have should not go down');
-  }
+    var have = handle.availOutBefore - availOutAfter;
+    if (have > 0) {
+      var out = self._outBuffer.slice(self._outOffset, self._outOffset + have);
+      self._outOffset += have;
+      self.push(out);
+    } else if (have < 0) {
+      assert(false, 'have should not go down');
+    }
 
-  // exhausted the output buffer, or used all the input create a new one.
-  if (availOutAfter === 0 || self._outOffset >= self._chunkSize) {
-    handle.availOutBefore = self._chunkSize;
-    self._outOffset = 0;
-    self._outBuffer = Buffer.allocUnsafe(self._chunkSize);
-  }
+    // exhausted the output buffer, or used all the input create a new one.
+    if (availOutAfter === 0 || self._outOffset >= self._chunkSize) {
+      handle.availOutBefore = self._chunkSize;
+      self._outOffset = 0;
+      self._outBuffer = Buffer.allocUnsafe(self._chunkSize);
+    }
+
+    if (availOutAfter !== 0)
+      break;
 
-  if (availOutAfter === 0) {
     // Not actually done. Need to reprocess.
     // Also, update the availInBefore to the availInAfter value,
     // so that if we have to hit it a third (fourth, etc.) time,
@@ -573,14 +625,15 @@ function processCallback() {
     handle.inOff += inDelta;
     handle.availInBefore = availInAfter;
 
-    this.write(handle.flushFlag,
-               this.buffer, // in
-               handle.inOff, // in_off
-               handle.availInBefore, // in_len
-               self._outBuffer, // out
-               self._outOffset, // out_off
-               self._chunkSize); // out_len
-    return;
+    var done = this.write(handle.flushFlag,
+                          this.buffer, // in
+                          handle.inOff, // in_off
+                          handle.availInBefore, // in_len
+                          self._outBuffer, // out
+                          self._outOffset, // out_off
+                          self._chunkSize); // out_len
+    if (!done)
+      return;
   }
 
   // finished with the chunk.
@@ -588,6 +641,46 @@ function processCallback() {
   this.cb();
 }
 
+// Keep accepting input while there are fewer blocks in flight than threads
+// that may work on them, but only report a flush as done once all of the
+// output it asked for has been pushed.
+function canContinueParallel(self, flushFlag, pending) {
+  return pending === 0 ||
+         (flushFlag === Z_NO_FLUSH && pending < self._parallel);
+}
+
+function processChunkParallel(self, chunk, flushFlag, cb) {
+  var handle = self._handle;
+  var pending = handle.write(chunk, flushFlag);
+  if (self._hadError)
+    return;
+  self.bytesRead += chunk.byteLength;
+
+  if (canContinueParallel(self, flushFlag, pending)) {
+    cb();
+  } else {
+    handle.flushFlag = flushFlag;
+    handle.cb = cb;
+  }
+}
+
+function parallelCallback(chunk, pending) {
+  // This callback's context (`this`) is the `_handle` (ParallelGzip) object.
+  var handle = this;
+  var self = this.jsref;
+
+  if (self._hadError || self.destroyed)
+    return;
+
+  self.push(chunk);
+
+  var cb = handle.cb;
+  if (cb && canContinueParallel(self, handle.flushFlag, pending)) {
+    handle.cb = null;
+    cb();
+  }
+}
+
 function _close(engine, callback) {
   if (callback)
     process.nextTick(callback);
@@ -659,6 +752,10 @@ inherits(Unzip, Zlib);
 function createConvenienceMethod(ctor, sync) {
   if (sync) {
     return function(buffer, opts) {
+      // There is nothing to spread over the threadpool when compressing
+      // synchronously.
+      if (opts && opts.parallel !== undefined)
+        opts = Object.assign({}, opts, { parallel: undefined });
       return zlibBufferSync(new ctor(opts), buffer);
     };
   } else {
@@ -6,6 +6,8 @@
     'node_use_lttng%': 'false',
     'node_use_etw%': 'false',
     'node_use_perfctr%': 'false',
+    'node_use_node_snapshot%': 'false',
+    'node_use_node_code_cache%': 'false',
     'node_no_browser_globals%': 'false',
     'node_use_v8_platform%': 'true',
     'node_use_bundled_v8%': 'true',
@@ -24,6 +26,10 @@
     'node_core_target_name%': 'node',
     'node_lib_target_name%': 'node_lib',
     'node_intermediate_lib_type%': 'static_library',
+    'node_mksnapshot_exec':
+      '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)node_mksnapshot<(EXECUTABLE_SUFFIX)',
+    'node_mkcodecache_exec':
+      '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)node_mkcodecache<(EXECUTABLE_SUFFIX)',
     'library_files': [
       'lib/internal/bootstrap_node.js',
       'lib/async_hooks.js',
@@ -87,6 +93,7 @@
       'lib/internal/cluster/shared_handle.js',
       'lib/internal/cluster/utils.js',
       'lib/internal/cluster/worker.js',
+      'lib/internal/code_cache.js',
       'lib/internal/crypto/certificate.js',
       'lib/internal/crypto/cipher.js',
       'lib/internal/crypto/diffiehellman.js',
@@ -258,6 +265,46 @@
             }],
           ],
         }],
+        [ 'node_use_node_snapshot=="true"', {
+          'dependencies': [ 'node_mksnapshot' ],
+          'defines': [ 'NODE_WANT_INTERNALS=1' ],
+          'actions': [
+            {
+              'action_name': 'node_mksnapshot',
+              'process_outputs_as_sources': 1,
+              'inputs': [
+                '<(node_mksnapshot_exec)',
+              ],
+              'outputs': [
+                '<(SHARED_INTERMEDIATE_DIR)/node_snapshot_blob.cc',
+              ],
+              'action': [
+                '<@(_inputs)',
+                '<@(_outputs)',
+              ],
+            },
+          ],
+        }],
+        [ 'node_use_node_code_cache=="true"', {
+          'dependencies': [ 'node_mkcodecache' ],
+          'defines': [ 'NODE_WANT_INTERNALS=1' ],
+          'actions': [
+            {
+              'action_name': 'node_mkcodecache',
+              'process_outputs_as_sources': 1,
+              'inputs': [
+                '<(node_mkcodecache_exec)',
+              ],
+              'outputs': [
+                '<(SHARED_INTERMEDIATE_DIR)/node_code_cache.cc',
+              ],
+              'action': [
+                '<@(_inputs)',
+                '<@(_outputs)',
+              ],
+            },
+          ],
+        }],
         [ 'node_intermediate_lib_type=="shared_library" and OS=="win"', {
           # On Windows, having the same name for both executable and shared
           # lib causes filename collision. Need a different PRODUCT_NAME for
@@ -288,17 +335,20 @@
         'src/async_wrap.cc',
         'src/cares_wrap.cc',
         'src/connection_wrap.cc',
+        'src/compile_cache.cc',
         'src/connect_wrap.cc',
         'src/env.cc',
         'src/fs_event_wrap.cc',
         'src/handle_wrap.cc',
         'src/js_stream.cc',
+        'src/module_resolve_cache.cc',
         'src/module_wrap.cc',
         'src/node.cc',
         'src/node_api.cc',
         'src/node_api.h',
         'src/node_api_types.h',
         'src/node_buffer.cc',
+        'src/node_code_cache.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
@@ -307,11 +357,13 @@
         'src/node_file.cc',
         'src/node_http2.cc',
         'src/node_http_parser.cc',
+        'src/node_http_serializer.cc',
         'src/node_os.cc',
         'src/node_platform.cc',
         'src/node_perf.cc',
         'src/node_postmortem_metadata.cc',
         'src/node_serdes.cc',
+        'src/node_snapshot.cc',
         'src/node_trace_events.cc',
         'src/node_url.cc',
         'src/node_util.cc',
@@ -322,6 +374,7 @@
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
         'src/process_wrap.cc',
+        'src/read_buffer_pool.cc',
         'src/signal_wrap.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
@@ -329,6 +382,7 @@
         'src/stream_base.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
+        'src/threadpool_stats.cc',
         'src/timer_wrap.cc',
         'src/tracing/agent.cc',
         'src/tracing/node_trace_buffer.cc',
@@ -338,21 +392,25 @@
         'src/udp_wrap.cc',
         'src/util.cc',
         'src/uv.cc',
+        'src/zlib_context_pool.cc',
         # headers to make for a more pleasant IDE experience
         'src/aliased_buffer.h',
         'src/async_wrap.h',
         'src/async_wrap-inl.h',
         'src/base_object.h',
         'src/base_object-inl.h',
+        'src/compile_cache.h',
         'src/connection_wrap.h',
         'src/connect_wrap.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
         'src/js_stream.h',
+        'src/module_resolve_cache.h',
         'src/module_wrap.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_code_cache.h',
         'src/node_constants.h',
         'src/node_contextify.h',
         'src/node_debug_options.h',
@@ -371,9 +429,12 @@
         'src/node_wrap.h',
         'src/node_revert.h',
         'src/node_i18n.h',
+        'src/node_snapshot.h',
         'src/pipe_wrap.h',
+        'src/read_buffer_pool.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
+        'src/threadpool_stats.h',
         'src/udp_wrap.h',
         'src/req_wrap.h',
         'src/req_wrap-inl.h',
@@ -387,6 +448,7 @@
         'src/tracing/trace_event.h',
         'src/util.h',
         'src/util-inl.h',
+        'src/zlib_context_pool.h',
         'deps/http_parser/http_parser.h',
         'deps/v8/include/v8.h',
         'deps/v8/include/v8-debug.h',
@@ -413,6 +475,12 @@
         [ 'node_shared=="true" and node_module_version!="" and OS!="win"', {
           'product_extension': '<(shlib_suffix)',
         }],
+        [ 'node_use_node_snapshot=="false"', {
+          'sources': [ 'src/node_snapshot_stub.cc' ],
+        }],
+        [ 'node_use_node_code_cache=="false"', {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }],
         ['node_shared=="true" and OS=="aix"', {
           'product_name': 'node_base',
         }],
@@ -572,9 +640,13 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_ktls.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_ktls.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
@@ -737,6 +809,74 @@
         },
       ],
     }, # end node_js2c
+    {
+      'target_name': 'node_mksnapshot',
+      'type': 'executable',
+
+      'dependencies': [
+        '<(node_lib_target_name)',
+      ],
+
+      'includes': [
+        'node.gypi'
+      ],
+
+      'include_dirs': [
+        'src',
+        'deps/v8/include',
+        'deps/uv/include',
+      ],
+
+      'defines': [ 'NODE_WANT_INTERNALS=1' ],
+
+      'conditions': [
+        [ 'node_use_node_snapshot=="true"', {
+          # Otherwise node_lib already contains the stub.
+          'sources': [ 'src/node_snapshot_stub.cc' ],
+        }],
+        [ 'node_use_node_code_cache=="true"', {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }],
+      ],
+
+      'sources': [
+        'tools/snapshot/node_mksnapshot.cc',
+      ],
+    }, # end node_mksnapshot
+    {
+      'target_name': 'node_mkcodecache',
+      'type': 'executable',
+
+      'dependencies': [
+        '<(node_lib_target_name)',
+      ],
+
+      'includes': [
+        'node.gypi'
+      ],
+
+      'include_dirs': [
+        'src',
+        'deps/v8/include',
+        'deps/uv/include',
+      ],
+
+      'defines': [ 'NODE_WANT_INTERNALS=1' ],
+
+      'conditions': [
+        [ 'node_use_node_snapshot=="true"', {
+          # Otherwise node_lib already contains the stubs.
+          'sources': [ 'src/node_snapshot_stub.cc' ],
+        }],
+        [ 'node_use_node_code_cache=="true"', {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }],
+      ],
+
+      'sources': [
+        'tools/code_cache/mkcodecache.cc',
+      ],
+    }, # end node_mkcodecache
     {
       'target_name': 'node_dtrace_header',
       'type': 'none',
@@ -972,7 +1112,9 @@
         'test/cctest/test_node_postmortem_metadata.cc',
         'test/cctest/test_environment.cc',
         'test/cctest/test_util.cc',
-        'test/cctest/test_url.cc'
+        'test/cctest/test_url.cc',
+        'src/node_code_cache_stub.cc',
+        'src/node_snapshot_stub.cc',
       ],
 
       'libraries': [
@@ -985,11 +1127,17 @@
         '<(obj_path)<(obj_separator)node_i18n.<(obj_suffix)',
         '<(obj_path)<(obj_separator)node_perf.<(obj_suffix)',
         '<(obj_path)<(obj_separator)node_platform.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)node_snapshot.<(obj_suffix)',
         '<(obj_path)<(obj_separator)node_url.<(obj_suffix)',
         '<(obj_path)<(obj_separator)util.<(obj_suffix)',
         '<(obj_path)<(obj_separator)string_bytes.<(obj_suffix)',
         '<(obj_path)<(obj_separator)string_search.<(obj_suffix)',
         '<(obj_path)<(obj_separator)stream_base.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)read_buffer_pool.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)threadpool_stats.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)module_resolve_cache.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)compile_cache.<(obj_suffix)',
+        '<(obj_path)<(obj_separator)zlib_context_pool.<(obj_suffix)',
         '<(obj_path)<(obj_separator)node_constants.<(obj_suffix)',
         '<(obj_tracing_path)<(obj_separator)agent.<(obj_suffix)',
         '<(obj_tracing_path)<(obj_separator)node_trace_buffer.<(obj_suffix)',
@@ -1006,6 +1154,8 @@
                 '<(obj_path)<(obj_separator)node_crypto.<(obj_suffix)',
                 '<(obj_path)<(obj_separator)node_crypto_bio.<(obj_suffix)',
                 '<(obj_path)<(obj_separator)node_crypto_clienthello.<(obj_suffix)',
+                '<(obj_path)<(obj_separator)node_crypto_ktls.<(obj_suffix)',
+                '<(obj_path)<(obj_separator)node_crypto_session_cache.<(obj_suffix)',
                 '<(obj_path)<(obj_separator)tls_wrap.<(obj_suffix)',
               ],
             }],
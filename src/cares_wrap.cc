@@ -1786,6 +1786,7 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
   Environment* env = req_wrap->env();
+  env->threadpool_stats()->Record(THREADPOOL_JOB_DNS, req);
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -1852,6 +1853,7 @@ void AfterGetNameInfo(uv_getnameinfo_t* req,
                       const char* service) {
   GetNameInfoReqWrap* req_wrap = static_cast<GetNameInfoReqWrap*>(req->data);
   Environment* env = req_wrap->env();
+  env->threadpool_stats()->Record(THREADPOOL_JOB_DNS, req);
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -0,0 +1,247 @@
+#include "compile_cache.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>  // PATH_MAX
+#include <stdio.h>
+#include <string.h>
+
+namespace node {
+
+namespace {
+
+const char kMagic[] = "node-compile-cache\n";
+
+// The header that precedes the data in a cache file.
+struct Header {
+  uint32_t version_tag;
+  uint32_t filename_length;
+  uint64_t source_hash;
+};
+
+bool IsAbsolute(const std::string& path) {
+#ifdef _WIN32
+  return (path.size() >= 2 && path[1] == ':') ||
+         (!path.empty() && (path[0] == '\\' || path[0] == '/'));
+#else
+  return !path.empty() && path[0] == '/';
+#endif
+}
+
+bool ReadFile(uv_loop_t* loop, const char* path, std::string* contents) {
+  uv_fs_t req;
+  const int fd = uv_fs_open(loop, &req, path, O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0)
+    return false;
+
+  const size_t kBlockSize = 64 << 10;
+  ssize_t nread;
+  do {
+    const size_t start = contents->size();
+    contents->resize(start + kBlockSize);
+    uv_buf_t buf = uv_buf_init(&(*contents)[start], kBlockSize);
+    nread = uv_fs_read(loop, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    contents->resize(start + (nread > 0 ? nread : 0));
+  } while (nread > 0);
+  uv_fs_close(loop, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+  return nread == 0;
+}
+
+int WriteFile(uv_loop_t* loop, const char* path, const std::string& contents) {
+  uv_fs_t req;
+  int err = uv_fs_open(loop, &req, path,
+                       O_WRONLY | O_CREAT | O_TRUNC, 0666, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err < 0)
+    return err;
+  const int fd = err;
+
+  size_t written = 0;
+  while (written < contents.size()) {
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(contents.data()) + written,
+                               contents.size() - written);
+    err = uv_fs_write(loop, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      break;
+    written += err;
+    err = 0;
+  }
+  const int close_err = uv_fs_close(loop, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+  return err == 0 ? close_err : err;
+}
+
+}  // anonymous namespace
+
+
+struct CompileCache::WriteJob {
+  uv_work_t req;
+  CompileCache* cache;
+  std::string directory;
+  std::string path;
+  std::string contents;
+  int err;
+};
+
+
+void CompileCache::set_directory(const std::string& directory) {
+  if (directory.empty() || IsAbsolute(directory)) {
+    directory_ = directory;
+    return;
+  }
+#ifdef _WIN32
+  char cwd[MAX_PATH * 4];
+#else
+  char cwd[PATH_MAX];
+#endif
+  size_t cwd_len = sizeof(cwd);
+  if (uv_cwd(cwd, &cwd_len) != 0) {
+    directory_ = directory;
+    return;
+  }
+  directory_ = std::string(cwd, cwd_len) + "/" + directory;
+}
+
+
+uint64_t CompileCache::Hash(const char* data, size_t length) {
+  // 64-bit FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+
+std::string CompileCache::Path(const std::string& filename) const {
+  char name[64];
+  snprintf(name, sizeof(name), "/%016" PRIx64 "-%08x.cache",
+           Hash(filename.data(), filename.size()),
+           v8::ScriptCompiler::CachedDataVersionTag());
+  return directory_ + name;
+}
+
+
+bool CompileCache::Get(uv_loop_t* loop,
+                       const std::string& filename,
+                       uint64_t source_hash,
+                       std::string* data) {
+  CHECK(enabled());
+  std::string contents;
+  const size_t magic_length = sizeof(kMagic) - 1;
+  Header header;
+  if (!ReadFile(loop, Path(filename).c_str(), &contents) ||
+      contents.size() < magic_length + sizeof(header) ||
+      memcmp(contents.data(), kMagic, magic_length) != 0) {
+    misses_++;
+    return false;
+  }
+  memcpy(&header, contents.data() + magic_length, sizeof(header));
+  const size_t offset = magic_length + sizeof(header);
+  // A different file whose name has the same hash, or an older source.
+  if (header.version_tag != v8::ScriptCompiler::CachedDataVersionTag() ||
+      header.source_hash != source_hash ||
+      header.filename_length > contents.size() - offset ||
+      contents.compare(offset, header.filename_length, filename) != 0) {
+    misses_++;
+    return false;
+  }
+  data->assign(contents, offset + header.filename_length, std::string::npos);
+  hits_++;
+  return true;
+}
+
+
+void CompileCache::Put(uv_loop_t* loop,
+                       const std::string& filename,
+                       uint64_t source_hash,
+                       const char* data,
+                       size_t length) {
+  CHECK(enabled());
+  Header header;
+  header.version_tag = v8::ScriptCompiler::CachedDataVersionTag();
+  header.filename_length = static_cast<uint32_t>(filename.size());
+  header.source_hash = source_hash;
+
+  WriteJob* job = new WriteJob();
+  job->req.data = job;
+  job->cache = this;
+  job->directory = directory_;
+  job->path = Path(filename);
+  job->contents.reserve(sizeof(kMagic) - 1 + sizeof(header) +
+                        filename.size() + length);
+  job->contents.append(kMagic, sizeof(kMagic) - 1);
+  job->contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  job->contents.append(filename);
+  job->contents.append(data, length);
+  job->err = 0;
+  CHECK_EQ(0, uv_queue_work_kind(loop, &job->req, UV_WORK_SLOW_IO,
+                                 Write, AfterWrite));
+}
+
+
+// Runs on the threadpool.
+void CompileCache::Write(uv_work_t* req) {
+  WriteJob* job = static_cast<WriteJob*>(req->data);
+  uv_loop_t* loop = req->loop;
+  uv_fs_t fs_req;
+
+  const std::string tmp_path =
+      job->path + "." + std::to_string(uv_os_getpid()) + ".tmp";
+  int err = WriteFile(loop, tmp_path.c_str(), job->contents);
+  if (err == UV_ENOENT) {
+    // Only the last component of the directory is created.
+    uv_fs_mkdir(loop, &fs_req, job->directory.c_str(), 0777, nullptr);
+    uv_fs_req_cleanup(&fs_req);
+    err = WriteFile(loop, tmp_path.c_str(), job->contents);
+  }
+  if (err == 0) {
+    err = uv_fs_rename(loop, &fs_req, tmp_path.c_str(), job->path.c_str(),
+                       nullptr);
+    uv_fs_req_cleanup(&fs_req);
+  }
+  if (err < 0) {
+    uv_fs_unlink(loop, &fs_req, tmp_path.c_str(), nullptr);
+    uv_fs_req_cleanup(&fs_req);
+  }
+  job->err = err;
+}
+
+
+void CompileCache::AfterWrite(uv_work_t* req, int status) {
+  WriteJob* job = static_cast<WriteJob*>(req->data);
+  if (status == 0 && job->err == 0)
+    job->cache->writes_++;
+  else
+    job->cache->write_errors_++;
+  delete job;
+}
+
+
+void CompileCache::Rejected(uv_loop_t* loop, const std::string& filename) {
+  CHECK(enabled());
+  // Get() counted it as a hit.
+  hits_--;
+  rejected_++;
+  uv_fs_t req;
+  uv_fs_unlink(loop, &req, Path(filename).c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+}
+
+
+void CompileCache::GetStats(double* fields) const {
+  fields[kCompileCacheHits] = static_cast<double>(hits_);
+  fields[kCompileCacheMisses] = static_cast<double>(misses_);
+  fields[kCompileCacheRejected] = static_cast<double>(rejected_);
+  fields[kCompileCacheWrites] = static_cast<double>(writes_);
+  fields[kCompileCacheWriteErrors] = static_cast<double>(write_errors_);
+}
+
+}  // namespace node
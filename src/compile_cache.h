@@ -0,0 +1,89 @@
+#ifndef SRC_COMPILE_CACHE_H_
+#define SRC_COMPILE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "uv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace node {
+
+enum CompileCacheStatsFields {
+  kCompileCacheHits,
+  kCompileCacheMisses,
+  kCompileCacheRejected,
+  kCompileCacheWrites,
+  kCompileCacheWriteErrors,
+  kCompileCacheStatsFieldsCount
+};
+
+// A per-Environment store of V8 code cache on disk, enabled by
+// --compile-cache-dir.
+//
+// There is one file per script, named after a hash of its filename and the
+// V8 cache version tag, so that different V8 versions and flags do not
+// overwrite each other's entries. The header of a file holds the filename
+// and a hash of the source the data was produced for; an entry whose source
+// changed is treated like a missing one and overwritten later.
+//
+// Files are written on the threadpool, to a temporary file that is renamed
+// into place, so that processes which share the directory never see a
+// partial entry.
+class CompileCache {
+ public:
+  CompileCache() = default;
+
+  // A relative `directory` is resolved against the current directory.
+  void set_directory(const std::string& directory);
+  bool enabled() const { return !directory_.empty(); }
+
+  // Returns the hash under which the data for `source` is stored.
+  static uint64_t Hash(const char* data, size_t length);
+
+  // Reads the data that was stored for `filename` and `source_hash`.
+  bool Get(uv_loop_t* loop,
+           const std::string& filename,
+           uint64_t source_hash,
+           std::string* data);
+
+  // Stores `data` asynchronously.
+  void Put(uv_loop_t* loop,
+           const std::string& filename,
+           uint64_t source_hash,
+           const char* data,
+           size_t length);
+
+  // Called when V8 did not accept the data that Get() returned. Removes the
+  // entry so that the next process stores a new one.
+  void Rejected(uv_loop_t* loop, const std::string& filename);
+
+  // Fills `fields` with kCompileCacheStatsFieldsCount entries.
+  void GetStats(double* fields) const;
+
+ private:
+  struct WriteJob;
+
+  std::string Path(const std::string& filename) const;
+  static void Write(uv_work_t* req);
+  static void AfterWrite(uv_work_t* req, int status);
+
+  std::string directory_;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t rejected_ = 0;
+  uint64_t writes_ = 0;
+  uint64_t write_errors_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(CompileCache);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_COMPILE_CACHE_H_
@@ -325,7 +325,10 @@ inline Environment::Environment(IsolateData* isolate_data,
 #endif
       handle_cleanup_waiting_(0),
       http_parser_buffer_(nullptr),
+      read_buffer_pool_(context->GetIsolate()),
+      threadpool_stats_(context->GetIsolate()),
       fs_stats_field_array_(isolate_, kFsStatsFieldsLength),
+      zlib_write_stats_(isolate_, kZlibWriteStatsLength),
       context_(context->GetIsolate(), context) {
   // We'll be creating new objects so make sure we've entered the context.
   v8::HandleScope handle_scope(isolate());
@@ -531,11 +534,36 @@ inline void Environment::set_http2_state(
   http2_state_ = std::move(buffer);
 }
 
+inline ReadBufferPool* Environment::read_buffer_pool() {
+  return &read_buffer_pool_;
+}
+
+inline ZlibContextPool* Environment::zlib_context_pool() {
+  return &zlib_context_pool_;
+}
+
+inline ModuleResolveCache* Environment::module_resolve_cache() {
+  return &module_resolve_cache_;
+}
+
+inline CompileCache* Environment::compile_cache() {
+  return &compile_cache_;
+}
+
+inline ThreadpoolStats* Environment::threadpool_stats() {
+  return &threadpool_stats_;
+}
+
 inline AliasedBuffer<double, v8::Float64Array>*
 Environment::fs_stats_field_array() {
   return &fs_stats_field_array_;
 }
 
+inline AliasedBuffer<double, v8::Float64Array>*
+Environment::zlib_write_stats() {
+  return &zlib_write_stats_;
+}
+
 void Environment::CreateImmediate(native_immediate_callback cb,
                                void* data,
                                v8::Local<v8::Object> obj,
@@ -36,6 +36,11 @@
 #include "v8.h"
 #include "node.h"
 #include "node_http2_state.h"
+#include "read_buffer_pool.h"
+#include "compile_cache.h"
+#include "module_resolve_cache.h"
+#include "threadpool_stats.h"
+#include "zlib_context_pool.h"
 
 #include <list>
 #include <map>
@@ -84,7 +89,6 @@ class ModuleWrap;
 // for the sake of convenience.  Strings should be ASCII-only and have a
 // "node:" prefix to avoid name clashes with third-party code.
 #define PER_ISOLATE_PRIVATE_SYMBOL_PROPERTIES(V)                              \
-  V(alpn_buffer_private_symbol, "node:alpnBuffer")                            \
   V(arrow_message_private_symbol, "node:arrowMessage")                        \
   V(contextify_context_private_symbol, "node:contextify:context")             \
   V(contextify_global_private_symbol, "node:contextify:global")               \
@@ -192,6 +196,7 @@ class ModuleWrap;
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onheaders_string, "onheaders")                                            \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessages_string, "onmessages")                                          \
   V(onnewsession_string, "onnewsession")                                      \
   V(onocspresponse_string, "onocspresponse")                                  \
   V(ongoawaydata_string, "ongoawaydata")                                      \
@@ -306,6 +311,7 @@ class ModuleWrap;
   V(tls_wrap_constructor_function, v8::Function)                              \
   V(tty_constructor_template, v8::FunctionTemplate)                           \
   V(udp_constructor_function, v8::Function)                                   \
+  V(vm_compile_cache_symbol, v8::Symbol)                                      \
   V(vm_parsing_context_symbol, v8::Symbol)                                    \
   V(url_constructor_function, v8::Function)                                   \
   V(write_wrap_constructor_function, v8::Function)                            \
@@ -333,6 +339,8 @@ class IsolateData {
 #undef VP
 
   std::unordered_map<nghttp2_rcbuf*, v8::Eternal<v8::String>> http2_static_strs;
+  // Indexed like HeaderStringTable in node_http_parser.cc.
+  std::vector<v8::Eternal<v8::String>> http_parser_strs;
   inline v8::Isolate* isolate() const;
 
  private:
@@ -607,7 +615,14 @@ class Environment {
   inline http2::http2_state* http2_state() const;
   inline void set_http2_state(std::unique_ptr<http2::http2_state> state);
 
+  inline ReadBufferPool* read_buffer_pool();
+  inline ZlibContextPool* zlib_context_pool();
+  inline ModuleResolveCache* module_resolve_cache();
+  inline CompileCache* compile_cache();
+  inline ThreadpoolStats* threadpool_stats();
+
   inline AliasedBuffer<double, v8::Float64Array>* fs_stats_field_array();
+  inline AliasedBuffer<double, v8::Float64Array>* zlib_write_stats();
 
   inline performance::performance_state* performance_state();
   inline std::map<std::string, uint64_t>* performance_marks();
@@ -779,11 +794,22 @@ class Environment {
   char* http_parser_buffer_;
   std::unique_ptr<http2::http2_state> http2_state_;
 
+  ReadBufferPool read_buffer_pool_;
+  ZlibContextPool zlib_context_pool_;
+  ModuleResolveCache module_resolve_cache_;
+  CompileCache compile_cache_;
+  ThreadpoolStats threadpool_stats_;
+
   // stat fields contains twice the number of entries because `fs.StatWatcher`
   // needs room to store data for *two* `fs.Stats` instances.
   static const int kFsStatsFieldsLength = 2 * 14;
   AliasedBuffer<double, v8::Float64Array> fs_stats_field_array_;
 
+  // Counters of zlib writes that ran on the loop thread and on the
+  // threadpool, see ZCtx::Write() in node_zlib.cc.
+  static const int kZlibWriteStatsLength = 4;
+  AliasedBuffer<double, v8::Float64Array> zlib_write_stats_;
+
   struct BeforeExitCallback {
     void (*cb_)(void* arg);
     void* arg_;
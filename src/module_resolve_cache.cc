@@ -0,0 +1,407 @@
+#include "module_resolve_cache.h"
+#include "node_version.h"
+#include "util-inl.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace node {
+
+namespace {
+
+// The version is part of the header because resolution rules may change
+// between releases. The number before it is the version of the format.
+const char kMagic[] = "node-module-resolve-cache 2 " NODE_VERSION "\n";
+const uint32_t kByteOrderMark = 0x01020304;
+
+std::string Dirname(const std::string& path) {
+#ifdef _WIN32
+  const size_t pos = path.find_last_of("/\\");
+#else
+  const size_t pos = path.find_last_of('/');
+#endif
+  if (pos == std::string::npos)
+    return ".";
+  if (pos == 0 || path[pos - 1] == ':')
+    return path.substr(0, pos + 1);
+  return path.substr(0, pos);
+}
+
+class Writer {
+ public:
+  void U32(uint32_t value) { Bytes(&value, sizeof(value)); }
+  void U64(uint64_t value) { Bytes(&value, sizeof(value)); }
+  void I64(int64_t value) { Bytes(&value, sizeof(value)); }
+  void String(const std::string& value) {
+    U32(static_cast<uint32_t>(value.size()));
+    Bytes(value.data(), value.size());
+  }
+  void Bytes(const void* data, size_t size) {
+    out_.append(static_cast<const char*>(data), size);
+  }
+  const std::string& out() const { return out_; }
+
+ private:
+  std::string out_;
+};
+
+class Reader {
+ public:
+  Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+  bool U32(uint32_t* value) { return Bytes(value, sizeof(*value)); }
+  bool U64(uint64_t* value) { return Bytes(value, sizeof(*value)); }
+  bool I64(int64_t* value) { return Bytes(value, sizeof(*value)); }
+  bool String(std::string* value) {
+    uint32_t size;
+    if (!U32(&size) || size > size_ - pos_)
+      return false;
+    value->assign(data_ + pos_, size);
+    pos_ += size;
+    return true;
+  }
+  bool Bytes(void* out, size_t size) {
+    if (size > size_ - pos_)
+      return false;
+    memcpy(out, data_ + pos_, size);
+    pos_ += size;
+    return true;
+  }
+  bool done() const { return pos_ == size_; }
+
+ private:
+  const char* const data_;
+  const size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // anonymous namespace
+
+
+int ModuleResolveCache::Stat(uv_loop_t* loop, const char* path) {
+  std::string key(path);
+  if (recording_)
+    AddDependency(loop, Dirname(key));
+
+  if (stat_cache_enabled_) {
+    auto it = stat_cache_.find(key);
+    if (it != stat_cache_.end()) {
+      stat_hits_++;
+      return it->second;
+    }
+  }
+
+  uv_fs_t req;
+  int rc = uv_fs_stat(loop, &req, path, nullptr);
+  if (rc == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    rc = !!(s->st_mode & S_IFDIR);
+  }
+  uv_fs_req_cleanup(&req);
+  stats_++;
+
+  if (stat_cache_enabled_)
+    stat_cache_.emplace(std::move(key), rc);
+  return rc;
+}
+
+
+int ModuleResolveCache::Probe(uv_loop_t* loop,
+                              const std::string& base,
+                              const std::vector<std::string>& exts) {
+  for (size_t i = 0; i < exts.size(); i++) {
+    if (Stat(loop, (base + exts[i]).c_str()) == 0)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+
+void ModuleResolveCache::AddFileDependency(uv_loop_t* loop, const char* path) {
+  if (recording_)
+    AddDependency(loop, path);
+}
+
+
+void ModuleResolveCache::set_stat_cache_enabled(bool value) {
+  stat_cache_enabled_ = value;
+  if (!value)
+    stat_cache_.clear();
+}
+
+
+bool ModuleResolveCache::Get(uv_loop_t* loop,
+                             const std::string& key,
+                             std::string* filename) {
+  recording_ = false;
+
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    bool valid = true;
+    for (uint32_t index : it->second.deps) {
+      if (!IsValid(loop, &deps_[index])) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid) {
+      hits_++;
+      *filename = it->second.filename;
+      return true;
+    }
+    stale_++;
+    entries_.erase(it);
+    dirty_ = true;
+  } else {
+    misses_++;
+  }
+
+  recording_ = true;
+  recording_key_ = key;
+  recorded_deps_.clear();
+  return false;
+}
+
+
+void ModuleResolveCache::Set(const std::string& key,
+                             const std::string& filename) {
+  if (!recording_ || key != recording_key_)
+    return;
+  recording_ = false;
+
+  Entry& entry = entries_[key];
+  entry.filename = filename;
+  entry.deps.assign(recorded_deps_.begin(), recorded_deps_.end());
+  dirty_ = true;
+}
+
+
+void ModuleResolveCache::AddDependency(uv_loop_t* loop,
+                                       const std::string& path) {
+  recorded_deps_.insert(DependencyIndex(loop, path));
+}
+
+
+uint32_t ModuleResolveCache::DependencyIndex(uv_loop_t* loop,
+                                             const std::string& path) {
+  auto it = dep_indexes_.find(path);
+  if (it != dep_indexes_.end() && IsValid(loop, &deps_[it->second]))
+    return it->second;
+
+  // A stale dependency stays around for the entries that refer to it, new
+  // entries refer to a new one with the current mtime.
+  Dependency dep(path, kValid);
+  StatDependency(loop, &dep);
+  const uint32_t index = static_cast<uint32_t>(deps_.size());
+  deps_.push_back(std::move(dep));
+  dep_indexes_[path] = index;
+  return index;
+}
+
+
+bool ModuleResolveCache::IsValid(uv_loop_t* loop, Dependency* dep) {
+  if (dep->state == kUnknown) {
+    Dependency current(dep->path, kUnknown);
+    StatDependency(loop, &current);
+    dep->state = current.SameAs(*dep) ? kValid : kStale;
+  }
+  return dep->state == kValid;
+}
+
+
+void ModuleResolveCache::StatDependency(uv_loop_t* loop, Dependency* dep) {
+  uv_fs_t req;
+  const int rc = uv_fs_stat(loop, &req, dep->path.c_str(), nullptr);
+  dep->exists = rc == 0;
+  if (dep->exists) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    dep->dev = s->st_dev;
+    dep->ino = s->st_ino;
+    dep->mtime_sec = s->st_mtim.tv_sec;
+    dep->mtime_nsec = s->st_mtim.tv_nsec;
+    dep->ctime_sec = s->st_ctim.tv_sec;
+    dep->ctime_nsec = s->st_ctim.tv_nsec;
+  } else {
+    *dep = Dependency(dep->path, dep->state);
+  }
+  uv_fs_req_cleanup(&req);
+  stats_++;
+}
+
+
+bool ModuleResolveCache::Load(uv_loop_t* loop, const char* path) {
+  uv_fs_t req;
+  const int fd = uv_fs_open(loop, &req, path, O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0)
+    return false;
+
+  std::vector<char> data;
+  const size_t kBlockSize = 64 << 10;
+  ssize_t nread;
+  do {
+    const size_t start = data.size();
+    data.resize(start + kBlockSize);
+    uv_buf_t buf = uv_buf_init(&data[start], kBlockSize);
+    nread = uv_fs_read(loop, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    data.resize(start + (nread > 0 ? nread : 0));
+  } while (nread > 0);
+  uv_fs_close(loop, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (nread < 0)
+    return false;
+
+  const size_t magic_length = sizeof(kMagic) - 1;
+  if (data.size() < magic_length || memcmp(data.data(), kMagic, magic_length))
+    return false;
+
+  Reader reader(data.data() + magic_length, data.size() - magic_length);
+  std::vector<Dependency> deps;
+  std::unordered_map<std::string, Entry> entries;
+  uint32_t byte_order_mark;
+  uint32_t count;
+  if (!reader.U32(&byte_order_mark) || byte_order_mark != kByteOrderMark ||
+      !reader.U32(&count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    Dependency dep("", kUnknown);
+    uint32_t exists;
+    if (!reader.String(&dep.path) ||
+        !reader.U32(&exists) ||
+        !reader.U64(&dep.dev) ||
+        !reader.U64(&dep.ino) ||
+        !reader.I64(&dep.mtime_sec) ||
+        !reader.I64(&dep.mtime_nsec) ||
+        !reader.I64(&dep.ctime_sec) ||
+        !reader.I64(&dep.ctime_nsec)) {
+      return false;
+    }
+    dep.exists = exists != 0;
+    deps.push_back(std::move(dep));
+  }
+  if (!reader.U32(&count))
+    return false;
+  for (uint32_t i = 0; i < count; i++) {
+    std::string key;
+    Entry entry;
+    uint32_t ndeps;
+    if (!reader.String(&key) ||
+        !reader.String(&entry.filename) ||
+        !reader.U32(&ndeps)) {
+      return false;
+    }
+    for (uint32_t j = 0; j < ndeps; j++) {
+      uint32_t index;
+      if (!reader.U32(&index) || index >= deps.size())
+        return false;
+      entry.deps.push_back(index);
+    }
+    entries.emplace(std::move(key), std::move(entry));
+  }
+  if (!reader.done())
+    return false;
+
+  deps_ = std::move(deps);
+  entries_ = std::move(entries);
+  dep_indexes_.clear();
+  for (uint32_t i = 0; i < deps_.size(); i++)
+    dep_indexes_[deps_[i].path] = i;
+  dirty_ = false;
+  return true;
+}
+
+
+int ModuleResolveCache::Save(uv_loop_t* loop, const char* path) {
+  if (!dirty_)
+    return 0;
+
+  // Only write the dependencies that are still referred to.
+  std::vector<uint32_t> new_indexes(deps_.size(), UINT32_MAX);
+  std::vector<uint32_t> used;
+  for (const auto& it : entries_) {
+    for (uint32_t index : it.second.deps) {
+      if (new_indexes[index] == UINT32_MAX) {
+        new_indexes[index] = static_cast<uint32_t>(used.size());
+        used.push_back(index);
+      }
+    }
+  }
+
+  Writer writer;
+  writer.Bytes(kMagic, sizeof(kMagic) - 1);
+  writer.U32(kByteOrderMark);
+  writer.U32(static_cast<uint32_t>(used.size()));
+  for (uint32_t index : used) {
+    const Dependency& dep = deps_[index];
+    writer.String(dep.path);
+    writer.U32(dep.exists);
+    writer.U64(dep.dev);
+    writer.U64(dep.ino);
+    writer.I64(dep.mtime_sec);
+    writer.I64(dep.mtime_nsec);
+    writer.I64(dep.ctime_sec);
+    writer.I64(dep.ctime_nsec);
+  }
+  writer.U32(static_cast<uint32_t>(entries_.size()));
+  for (const auto& it : entries_) {
+    writer.String(it.first);
+    writer.String(it.second.filename);
+    writer.U32(static_cast<uint32_t>(it.second.deps.size()));
+    for (uint32_t index : it.second.deps)
+      writer.U32(new_indexes[index]);
+  }
+
+  // Write to a temporary file first, several processes may share the file.
+  const std::string tmp_path =
+      std::string(path) + "." + std::to_string(uv_os_getpid()) + ".tmp";
+  uv_fs_t req;
+  int err = uv_fs_open(loop, &req, tmp_path.c_str(),
+                       O_WRONLY | O_CREAT | O_TRUNC, 0666, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err < 0)
+    return err;
+  const int fd = err;
+
+  const std::string& out = writer.out();
+  size_t written = 0;
+  while (written < out.size()) {
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(out.data()) + written,
+                               out.size() - written);
+    err = uv_fs_write(loop, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      break;
+    written += err;
+    err = 0;
+  }
+  const int close_err = uv_fs_close(loop, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err == 0)
+    err = close_err;
+  if (err == 0) {
+    err = uv_fs_rename(loop, &req, tmp_path.c_str(), path, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+  if (err < 0) {
+    uv_fs_unlink(loop, &req, tmp_path.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    return err;
+  }
+
+  dirty_ = false;
+  return 0;
+}
+
+
+void ModuleResolveCache::GetStats(double* fields) const {
+  fields[kModuleResolveCacheHits] = static_cast<double>(hits_);
+  fields[kModuleResolveCacheMisses] = static_cast<double>(misses_);
+  fields[kModuleResolveCacheStale] = static_cast<double>(stale_);
+  fields[kModuleResolveCacheStats] = static_cast<double>(stats_);
+  fields[kModuleResolveCacheStatHits] = static_cast<double>(stat_hits_);
+}
+
+}  // namespace node
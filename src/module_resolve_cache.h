@@ -0,0 +1,134 @@
+#ifndef SRC_MODULE_RESOLVE_CACHE_H_
+#define SRC_MODULE_RESOLVE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "uv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace node {
+
+enum ModuleResolveCacheStatsFields {
+  kModuleResolveCacheHits,
+  kModuleResolveCacheMisses,
+  kModuleResolveCacheStale,
+  kModuleResolveCacheStats,
+  kModuleResolveCacheStatHits,
+  kModuleResolveCacheStatsFieldsCount
+};
+
+// A per-Environment cache for the file system lookups of require().
+//
+// While the stat cache is enabled, which lib/module.js does while the main
+// module and the modules it requires synchronously are loaded, the results of
+// internalModuleStat() are kept, including ENOENT and other errors.
+//
+// Independently of that, resolved filenames can be kept in a table keyed by
+// the request and the directories it was looked up in, and the table can be
+// saved to and loaded from a file so that later processes skip the lookups.
+// While a resolution is recorded, the directories that were probed and the
+// package.json files that were read are remembered together with their
+// device, inode, mtime and ctime. A loaded entry is only used while none of
+// them changed, which catches files that were added, removed or renamed in
+// those directories, and symbolic links on their paths that now point
+// elsewhere.
+class ModuleResolveCache {
+ public:
+  ModuleResolveCache() = default;
+
+  // Returns 0 for a file, 1 for a directory or a negative error code.
+  int Stat(uv_loop_t* loop, const char* path);
+
+  // Returns the index of the first `base + exts[i]` that is a file, or -1.
+  int Probe(uv_loop_t* loop,
+            const std::string& base,
+            const std::vector<std::string>& exts);
+
+  // Called for every package.json that is read while recording.
+  void AddFileDependency(uv_loop_t* loop, const char* path);
+
+  void set_stat_cache_enabled(bool value);
+
+  // Returns the filename that `key` was resolved to, if it is still valid.
+  // Otherwise starts recording the lookups for `key` until Set() is called.
+  bool Get(uv_loop_t* loop, const std::string& key, std::string* filename);
+  void Set(const std::string& key, const std::string& filename);
+
+  // Returns false if the file does not exist or is not a valid cache file.
+  bool Load(uv_loop_t* loop, const char* path);
+  // Returns 0 or a negative error code. Does nothing if nothing changed.
+  int Save(uv_loop_t* loop, const char* path);
+
+  // Fills `fields` with kModuleResolveCacheStatsFieldsCount entries.
+  void GetStats(double* fields) const;
+
+ private:
+  enum DependencyState { kUnknown, kValid, kStale };
+
+  struct Dependency {
+    Dependency(const std::string& path, DependencyState state)
+        : path(path), state(state) {}
+
+    // The device and inode tell apart a directory that a symbolic link on
+    // the path now points to from the old one, even if their mtimes match.
+    bool SameAs(const Dependency& other) const {
+      return exists == other.exists &&
+             dev == other.dev && ino == other.ino &&
+             mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec &&
+             ctime_sec == other.ctime_sec && ctime_nsec == other.ctime_nsec;
+    }
+
+    std::string path;
+    bool exists = false;
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    int64_t mtime_sec = 0;
+    int64_t mtime_nsec = 0;
+    int64_t ctime_sec = 0;
+    int64_t ctime_nsec = 0;
+    DependencyState state;
+  };
+
+  struct Entry {
+    std::string filename;
+    std::vector<uint32_t> deps;
+  };
+
+  void AddDependency(uv_loop_t* loop, const std::string& path);
+  uint32_t DependencyIndex(uv_loop_t* loop, const std::string& path);
+  bool IsValid(uv_loop_t* loop, Dependency* dep);
+  void StatDependency(uv_loop_t* loop, Dependency* dep);
+
+  bool stat_cache_enabled_ = false;
+  std::unordered_map<std::string, int> stat_cache_;
+
+  std::unordered_map<std::string, Entry> entries_;
+  std::vector<Dependency> deps_;
+  std::unordered_map<std::string, uint32_t> dep_indexes_;
+  bool dirty_ = false;
+
+  bool recording_ = false;
+  std::string recording_key_;
+  std::unordered_set<uint32_t> recorded_deps_;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t stale_ = 0;
+  uint64_t stats_ = 0;
+  uint64_t stat_hits_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ModuleResolveCache);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_MODULE_RESOLVE_CACHE_H_
@@ -28,6 +28,7 @@
 #include "node_revert.h"
 #include "node_debug_options.h"
 #include "node_perf.h"
+#include "node_snapshot.h"
 
 #if defined HAVE_PERFCTR
 #include "node_counters.h"
@@ -181,6 +182,7 @@ static bool trace_deprecation = false;
 static bool throw_deprecation = false;
 static bool trace_sync_io = false;
 static bool no_force_async_hooks_checks = false;
+static bool no_node_snapshot = false;
 static bool track_heap_objects = false;
 static const char* eval_string = nullptr;
 static std::vector<std::string> preload_modules;
@@ -257,6 +259,9 @@ bool config_pending_deprecation = false;
 // Set in node.cc by ParseArgs when --redirect-warnings= is used.
 std::string config_warning_file;  // NOLINT(runtime/string)
 
+// Set in node.cc by ParseArgs when --compile-cache-dir= is used.
+std::string config_compile_cache_dir;  // NOLINT(runtime/string)
+
 // Set in node.cc by ParseArgs when --expose-internals or --expose_internals is
 // used.
 // Used in node_config.cc to set a constant on process.binding('config')
@@ -3270,7 +3275,11 @@ static void RawDebug(const FunctionCallbackInfo<Value>& args) {
   fflush(stderr);
 }
 
-void LoadEnvironment(Environment* env) {
+// `bootstrap` and `natives` are the functions that were compiled into the
+// startup snapshot, if the context was created from it. See node_snapshot.h.
+static void LoadEnvironment(Environment* env,
+                            Local<Function> bootstrap,
+                            Local<Object> natives) {
   HandleScope handle_scope(env->isolate());
 
   TryCatch try_catch(env->isolate());
@@ -3280,16 +3289,20 @@ void LoadEnvironment(Environment* env) {
   // are not safe to ignore.
   try_catch.SetVerbose(false);
 
-  // Execute the lib/internal/bootstrap_node.js file which was included as a
-  // static C string in node_natives.h by node_js2c.
-  // 'internal_bootstrap_node_native' is the string containing that source code.
-  Local<String> script_name = FIXED_ONE_BYTE_STRING(env->isolate(),
-                                                    "bootstrap_node.js");
-  // 执行bootstrap_node.js导出的函数
-  Local<Value> f_value = ExecuteString(env, MainSource(env), script_name);
-  if (try_catch.HasCaught())  {
-    ReportException(env, try_catch);
-    exit(10);
+  Local<Value> f_value = bootstrap;
+  if (bootstrap.IsEmpty()) {
+    // Execute the lib/internal/bootstrap_node.js file which was included as
+    // a static C string in node_natives.h by node_js2c.
+    // 'internal_bootstrap_node_native' is the string containing that source
+    // code.
+    Local<String> script_name = FIXED_ONE_BYTE_STRING(env->isolate(),
+                                                      "bootstrap_node.js");
+    // 执行bootstrap_node.js导出的函数
+    f_value = ExecuteString(env, MainSource(env), script_name);
+    if (try_catch.HasCaught())  {
+      ReportException(env, try_catch);
+      exit(10);
+    }
   }
   // The bootstrap_node.js file returns a function 'f'
   CHECK(f_value->IsFunction());
@@ -3332,9 +3345,15 @@ void LoadEnvironment(Environment* env) {
   // We start the process this way in order to be more modular. Developers
   // who do not like how bootstrap_node.js sets up the module system but do
   // like Node's I/O bindings may want to replace 'f' with their own function.
-  Local<Value> arg = env->process_object();
+  Local<Value> args[] = {
+    env->process_object(),
+    Undefined(env->isolate())
+  };
+  if (!natives.IsEmpty())
+    args[1] = natives;
   // 执行bootstrap_node.js 
-  auto ret = f->Call(env->context(), Null(env->isolate()), 1, &arg);
+  auto ret = f->Call(env->context(), Null(env->isolate()),
+                     arraysize(args), args);
   // If there was an error during bootstrap then it was either handled by the
   // FatalException handler or it's unrecoverable (e.g. max call stack
   // exceeded). Either way, clear the stack so that the AsyncCallbackScope
@@ -3346,6 +3365,10 @@ void LoadEnvironment(Environment* env) {
     env->async_hooks()->clear_async_id_stack();
 }
 
+void LoadEnvironment(Environment* env) {
+  LoadEnvironment(env, Local<Function>(), Local<Object>());
+}
+
 static void PrintHelp() {
   // XXX: If you add an option here, please also add it to doc/node.1 and
   // doc/api/cli.md
@@ -3386,10 +3409,14 @@ static void PrintHelp() {
          "  --redirect-warnings=file\n"
          "                             write warnings to file instead of\n"
          "                             stderr\n"
+         "  --compile-cache-dir=dir    keep the V8 code cache of loaded\n"
+         "                             modules in dir\n"
          "  --trace-sync-io            show stack trace when use of sync IO\n"
          "                             is detected after the first tick\n"
          "  --no-force-async-hooks-checks\n"
          "                             disable checks for async_hooks\n"
+         "  --no-node-snapshot         start without the built-in startup\n"
+         "                             snapshot\n"
          "  --trace-events-enabled     track trace events\n"
          "  --trace-event-categories   comma separated list of trace event\n"
          "                             categories to record\n"
@@ -3517,8 +3544,10 @@ static void CheckIfAllowedInEnv(const char* exe, bool is_env,
     "--loader",
     "--trace-warnings",
     "--redirect-warnings",
+    "--compile-cache-dir",
     "--trace-sync-io",
     "--no-force-async-hooks-checks",
+    "--no-node-snapshot",
     "--trace-events-enabled",
     "--trace-event-categories",
     "--track-heap-objects",
@@ -3656,12 +3685,16 @@ static void ParseArgs(int* argc,
       trace_warnings = true;
     } else if (strncmp(arg, "--redirect-warnings=", 20) == 0) {
       config_warning_file = arg + 20;
+    } else if (strncmp(arg, "--compile-cache-dir=", 20) == 0) {
+      config_compile_cache_dir = arg + 20;
     } else if (strcmp(arg, "--trace-deprecation") == 0) {
       trace_deprecation = true;
     } else if (strcmp(arg, "--trace-sync-io") == 0) {
       trace_sync_io = true;
     } else if (strcmp(arg, "--no-force-async-hooks-checks") == 0) {
       no_force_async_hooks_checks = true;
+    } else if (strcmp(arg, "--no-node-snapshot") == 0) {
+      no_node_snapshot = true;
     } else if (strcmp(arg, "--trace-events-enabled") == 0) {
       trace_enabled = true;
     } else if (strcmp(arg, "--trace-event-categories") == 0) {
@@ -4349,11 +4382,20 @@ Local<Context> NewContext(Isolate* isolate,
 
 
 inline int Start(Isolate* isolate, IsolateData* isolate_data,
+                 bool use_node_snapshot,
                  int argc, const char* const* argv,
                  int exec_argc, const char* const* exec_argv) {
   // 见v8文档
   HandleScope handle_scope(isolate);
-  Local<Context> context = NewContext(isolate);
+  Local<Context> context;
+  Local<Function> bootstrap;
+  Local<Object> natives;
+  if (use_node_snapshot) {
+    context = snapshot::NewContext(isolate, &bootstrap, &natives)
+        .ToLocalChecked();
+  } else {
+    context = NewContext(isolate);
+  }
   Context::Scope context_scope(context);
   Environment env(isolate_data, context);
   // 创建线程私有化数据的键，每个线程通过该键读写数据，都是对应的内容是独立的
@@ -4374,11 +4416,13 @@ inline int Start(Isolate* isolate, IsolateData* isolate_data,
     env.async_hooks()->no_force_checks();
   }
 
+  env.compile_cache()->set_directory(config_compile_cache_dir);
+
   {
     Environment::AsyncCallbackScope callback_scope(&env);
     env.async_hooks()->push_async_ids(1, 0);
     // 执行js脚步初始化
-    LoadEnvironment(&env);
+    LoadEnvironment(&env, bootstrap, natives);
     env.async_hooks()->pop_async_id(1);
   }
 
@@ -4429,6 +4473,8 @@ inline int Start(uv_loop_t* event_loop,
   Isolate::CreateParams params;
   ArrayBufferAllocator allocator;
   params.array_buffer_allocator = &allocator;
+  if (!no_node_snapshot)
+    params.snapshot_blob = snapshot::GetBlob();
 #ifdef NODE_ENABLE_VTUNE_PROFILING
   params.code_event_handler = vTune::GetVtuneCodeEventHandler();
 #endif
@@ -4462,7 +4508,9 @@ inline int Start(uv_loop_t* event_loop,
       isolate->GetHeapProfiler()->StartTrackingHeapObjects(true);
     }
     // 继续
-    exit_code = Start(isolate, &isolate_data, argc, argv, exec_argc, exec_argv);
+    exit_code = Start(isolate, &isolate_data,
+                      params.snapshot_blob != nullptr,
+                      argc, argv, exec_argc, exec_argv);
   }
 
   {
@@ -17,7 +17,7 @@
 #include <vector>
 #include "node_api.h"
 #include "node_internals.h"
-#include "env.h"
+#include "env-inl.h"
 
 static
 napi_status napi_set_last_error(napi_env env, napi_status error_code,
@@ -3264,6 +3264,7 @@ class Work : public node::AsyncResource {
                     async_resource,
                     *v8::String::Utf8Value(async_resource_name)),
     _env(env),
+    _node_env(node::Environment::GetCurrent(env->isolate)),
     _data(data),
     _execute(execute),
     _complete(complete) {
@@ -3295,6 +3296,8 @@ class Work : public node::AsyncResource {
 
   static void CompleteCallback(uv_work_t* req, int status) {
     Work* work = static_cast<Work*>(req->data);
+    work->_node_env->threadpool_stats()->Record(node::THREADPOOL_JOB_NAPI,
+                                                req);
 
     if (work->_complete != nullptr) {
       napi_env env = work->_env;
@@ -3327,6 +3330,7 @@ class Work : public node::AsyncResource {
 
  private:
   napi_env _env;
+  node::Environment* _node_env;
   void* _data;
   uv_work_t _request;
   napi_async_execute_callback _execute;
@@ -0,0 +1,74 @@
+#include "node_code_cache.h"
+#include "env-inl.h"
+#include "node_internals.h"
+#include "util-inl.h"
+
+#include <string.h>
+
+namespace node {
+namespace code_cache {
+
+using v8::ArrayBuffer;
+using v8::Boolean;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::Uint8Array;
+using v8::Value;
+
+// The cache only helps if V8 runs with the flags it was created with.
+// Early in the bootstrap --allow_natives_syntax is still set, so check
+// every time instead of once.
+static bool IsUsable() {
+  size_t count;
+  return GetEntries(&count) != nullptr &&
+         GetVersionTag() == ScriptCompiler::CachedDataVersionTag();
+}
+
+
+// get(id) returns a Uint8Array with the code cache of the built-in module
+// `id`, or undefined.
+static void Get(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  if (!IsUsable())
+    return;
+
+  node::Utf8Value id(env->isolate(), args[0]);
+  size_t count;
+  const Entry* entries = GetEntries(&count);
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(entries[i].id, *id) != 0)
+      continue;
+    // The data is static and only ever read by V8, so the buffer does not
+    // copy or own it.
+    Local<ArrayBuffer> ab =
+        ArrayBuffer::New(env->isolate(),
+                         const_cast<uint8_t*>(entries[i].data),
+                         entries[i].length);
+    args.GetReturnValue().Set(Uint8Array::New(ab, 0, entries[i].length));
+    return;
+  }
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  size_t count;
+  bool has_code_cache = GetEntries(&count) != nullptr;
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(env->isolate(), "hasCodeCache"),
+              Boolean::New(env->isolate(), has_code_cache)).FromJust();
+  env->SetMethod(target, "get", Get);
+}
+
+}  // namespace code_cache
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_INTERNAL(code_cache, node::code_cache::Initialize)
@@ -0,0 +1,39 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace code_cache {
+
+// V8 code cache for the built-in modules, created at build time by
+// tools/code_cache/mkcodecache.cc and embedded next to their sources.
+//
+// NativeModule.prototype.compile() passes it as cachedData to the
+// ContextifyScript of a module, so that V8 deserializes the bytecode of the
+// module instead of compiling it. V8 rejects the cache of a module whose
+// source does not match; the whole cache is skipped while the flags or the
+// CPU features differ from the build, see CachedDataVersionTag().
+
+struct Entry {
+  const char* id;
+  const uint8_t* data;
+  size_t length;
+};
+
+// Defined in the generated node_code_cache.cc or in node_code_cache_stub.cc,
+// which has no entries.
+const Entry* GetEntries(size_t* count);
+
+// v8::ScriptCompiler::CachedDataVersionTag() when the cache was created.
+uint32_t GetVersionTag();
+
+}  // namespace code_cache
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CODE_CACHE_H_
@@ -0,0 +1,20 @@
+// Used instead of the generated node_code_cache.cc when node is built
+// without a code cache for the built-in modules, and by the tools that run
+// at build time.
+
+#include "node_code_cache.h"
+
+namespace node {
+namespace code_cache {
+
+const Entry* GetEntries(size_t* count) {
+  *count = 0;
+  return nullptr;
+}
+
+uint32_t GetVersionTag() {
+  return 0;
+}
+
+}  // namespace code_cache
+}  // namespace node
@@ -108,6 +108,16 @@ static void InitConfig(Local<Object> target,
         ReadOnly).FromJust();
   }
 
+  if (!config_compile_cache_dir.empty()) {
+    target->DefineOwnProperty(
+        context,
+        FIXED_ONE_BYTE_STRING(isolate, "compileCacheDir"),
+        String::NewFromUtf8(isolate,
+                            config_compile_cache_dir.data(),
+                            v8::NewStringType::kNormal).ToLocalChecked(),
+        ReadOnly).FromJust();
+  }
+
   Local<Object> debugOptions = Object::New(isolate);
 
   target->DefineOwnProperty(
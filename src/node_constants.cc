@@ -1320,6 +1320,15 @@ void DefineConstants(v8::Isolate* isolate, Local<Object> target) {
   NODE_DEFINE_CONSTANT(os_constants, UV_UDP_REUSEADDR);
   NODE_DEFINE_CONSTANT(fs_constants, UV_FS_COPYFILE_EXCL);
 
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_UNKNOWN);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_FILE);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_DIR);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_LINK);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_FIFO);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_SOCKET);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_CHAR);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_DIRENT_BLOCK);
+
   os_constants->Set(OneByteString(isolate, "dlopen"), dlopen_constants);
   os_constants->Set(OneByteString(isolate, "errno"), err_constants);
   os_constants->Set(OneByteString(isolate, "signals"), sig_constants);
@@ -33,6 +33,7 @@ using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::External;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -789,6 +790,22 @@ MaybeLocal<Uint8Array> GetCachedData(Environment* env,
   return value.As<Uint8Array>();
 }
 
+// The option with which lib/module.js asks for the code cache of
+// --compile-cache-dir. It is ignored when that is not set.
+Maybe<bool> GetCompileCacheArg(Environment* env, Local<Value> options) {
+  if (!env->compile_cache()->enabled() || !options->IsObject())
+    return Just(false);
+
+  MaybeLocal<Value> maybe_value =
+      options.As<Object>()->Get(env->context(),
+                                env->vm_compile_cache_symbol());
+  if (maybe_value.IsEmpty())
+    return Nothing<bool>();
+
+  Local<Value> value = maybe_value.ToLocalChecked();
+  return Just(value->IsTrue());
+}
+
 Maybe<bool> GetProduceCachedData(Environment* env,
                                  Local<Value> options) {
   if (!options->IsObject()) {
@@ -811,6 +828,12 @@ class ContextifyScript : public BaseObject {
  private:
   Persistent<UnboundScript> script_;
 
+  // Code cache that was produced for --compile-cache-dir, and is stored
+  // once the script ran.
+  std::string compile_cache_filename_;
+  uint64_t compile_cache_source_hash_ = 0;
+  std::string compile_cache_data_;
+
  public:
   static void Init(Environment* env, Local<Object> target) {
     HandleScope scope(env->isolate());
@@ -835,6 +858,32 @@ class ContextifyScript : public BaseObject {
                 FIXED_ONE_BYTE_STRING(env->isolate(), "kParsingContext"),
                 parsing_context_symbol)
         .FromJust();
+
+    Local<Symbol> compile_cache_symbol =
+        Symbol::New(env->isolate(),
+                    FIXED_ONE_BYTE_STRING(env->isolate(), "compile cache"));
+    env->set_vm_compile_cache_symbol(compile_cache_symbol);
+    target->Set(env->context(),
+                FIXED_ONE_BYTE_STRING(env->isolate(), "kCompileCache"),
+                compile_cache_symbol)
+        .FromJust();
+
+    env->SetMethod(target, "getCompileCacheStats", GetCompileCacheStats);
+    target->Set(env->context(),
+                FIXED_ONE_BYTE_STRING(env->isolate(),
+                                      "kCompileCacheStatsFieldsCount"),
+                Integer::New(env->isolate(), kCompileCacheStatsFieldsCount))
+        .FromJust();
+  }
+
+
+  static void GetCompileCacheStats(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args[0]->IsFloat64Array());
+    Local<Float64Array> array = args[0].As<Float64Array>();
+    CHECK_EQ(array->Length(), kCompileCacheStatsFieldsCount);
+    Local<ArrayBuffer> ab = array->Buffer();
+    double* fields = static_cast<double*>(ab->GetContents().Data());
+    Environment::GetCurrent(args)->compile_cache()->GetStats(fields);
   }
 
 
@@ -860,6 +909,7 @@ class ContextifyScript : public BaseObject {
     MaybeLocal<Integer> columnOffset = GetColumnOffsetArg(env, options);
     MaybeLocal<Uint8Array> cached_data_buf = GetCachedData(env, options);
     Maybe<bool> maybe_produce_cached_data = GetProduceCachedData(env, options);
+    Maybe<bool> maybe_use_compile_cache = GetCompileCacheArg(env, options);
     MaybeLocal<Context> maybe_context = GetContextArg(env, options);
     if (try_catch.HasCaught()) {
       no_abort_scope.Close();
@@ -878,6 +928,30 @@ class ContextifyScript : public BaseObject {
           ui8->ByteLength());
     }
 
+    // Explicit cachedData takes precedence over the compile cache.
+    const bool use_compile_cache =
+        cached_data == nullptr && maybe_use_compile_cache.ToChecked();
+    std::string compile_cache_data;
+    if (use_compile_cache) {
+      node::Utf8Value filename_value(env->isolate(),
+                                     filename.ToLocalChecked());
+      node::TwoByteValue code_value(env->isolate(), code);
+      contextify_script->compile_cache_filename_.assign(
+          *filename_value, filename_value.length());
+      contextify_script->compile_cache_source_hash_ = CompileCache::Hash(
+          reinterpret_cast<const char*>(*code_value),
+          code_value.length() * sizeof(**code_value));
+      if (env->compile_cache()->Get(
+              env->event_loop(),
+              contextify_script->compile_cache_filename_,
+              contextify_script->compile_cache_source_hash_,
+              &compile_cache_data)) {
+        cached_data = new ScriptCompiler::CachedData(
+            reinterpret_cast<const uint8_t*>(compile_cache_data.data()),
+            compile_cache_data.size());
+      }
+    }
+
     ScriptOrigin origin(filename.ToLocalChecked(), lineOffset.ToLocalChecked(),
                         columnOffset.ToLocalChecked());
     ScriptCompiler::Source source(code, origin, cached_data);
@@ -886,6 +960,10 @@ class ContextifyScript : public BaseObject {
 
     if (source.GetCachedData() != nullptr)
       compile_options = ScriptCompiler::kConsumeCodeCache;
+    else if (use_compile_cache)
+      // V8 cannot add lazily compiled functions to the cache later on, so
+      // compile the whole module now rather than only its wrapper.
+      compile_options = ScriptCompiler::kProduceFullCodeCache;
     else if (produce_cached_data)
       compile_options = ScriptCompiler::kProduceCodeCache;
 
@@ -905,7 +983,19 @@ class ContextifyScript : public BaseObject {
     contextify_script->script_.Reset(env->isolate(),
                                      v8_script.ToLocalChecked());
 
-    if (compile_options == ScriptCompiler::kConsumeCodeCache) {
+    if (use_compile_cache) {
+      const ScriptCompiler::CachedData* cached_data = source.GetCachedData();
+      if (compile_options == ScriptCompiler::kConsumeCodeCache) {
+        if (cached_data->rejected) {
+          env->compile_cache()->Rejected(
+              env->event_loop(), contextify_script->compile_cache_filename_);
+        }
+      } else if (cached_data != nullptr) {
+        contextify_script->compile_cache_data_.assign(
+            reinterpret_cast<const char*>(cached_data->data),
+            cached_data->length);
+      }
+    } else if (compile_options == ScriptCompiler::kConsumeCodeCache) {
       args.This()->Set(
           env->cached_data_rejected_string(),
           Boolean::New(env->isolate(), source.GetCachedData()->rejected));
@@ -951,8 +1041,22 @@ class ContextifyScript : public BaseObject {
     bool break_on_sigint = maybe_break_on_sigint.ToChecked();
 
     // Do the eval within this context
-    EvalMachine(env, timeout, display_errors, break_on_sigint, args,
-                &try_catch);
+    if (!EvalMachine(env, timeout, display_errors, break_on_sigint, args,
+                     &try_catch)) {
+      return;
+    }
+
+    // Only lib/module.js uses the compile cache, and only in this context.
+    ContextifyScript* wrapped_script;
+    ASSIGN_OR_RETURN_UNWRAP(&wrapped_script, args.Holder());
+    if (!wrapped_script->compile_cache_data_.empty()) {
+      env->compile_cache()->Put(env->event_loop(),
+                                wrapped_script->compile_cache_filename_,
+                                wrapped_script->compile_cache_source_hash_,
+                                wrapped_script->compile_cache_data_.data(),
+                                wrapped_script->compile_cache_data_.size());
+      std::string().swap(wrapped_script->compile_cache_data_);
+    }
   }
 
   // args: sandbox, [options]
@@ -81,6 +81,7 @@ namespace node {
 namespace crypto {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Boolean;
 using v8::Context;
 using v8::DEFAULT;
@@ -89,6 +90,8 @@ using v8::EscapableHandleScope;
 using v8::Exception;
 using v8::External;
 using v8::False;
+using v8::Float64Array;
+using v8::FunctionCallback;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
@@ -520,6 +523,8 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "setOptions", SetOptions);
   env->SetProtoMethod(t, "setSessionIdContext", SetSessionIdContext);
   env->SetProtoMethod(t, "setSessionTimeout", SetSessionTimeout);
+  env->SetProtoMethod(t, "setSharedSessionCache", SetSharedSessionCache);
+  env->SetProtoMethod(t, "getSessionCacheStats", GetSessionCacheStats);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "loadPKCS12", LoadPKCS12);
 #ifndef OPENSSL_NO_ENGINE
@@ -542,6 +547,10 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
          Integer::NewFromUnsigned(env->isolate(), kTicketKeyNameIndex));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kTicketKeyIVIndex"),
          Integer::NewFromUnsigned(env->isolate(), kTicketKeyIVIndex));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(),
+                               "kSessionCacheStatsFieldsCount"),
+         Integer::NewFromUnsigned(env->isolate(),
+                                  kSessionCacheStatsFieldsCount));
 
   Local<FunctionTemplate> ctx_getter_templ =
       FunctionTemplate::New(env->isolate(),
@@ -1233,6 +1242,47 @@ void SecureContext::SetSessionTimeout(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void SecureContext::SetSharedSessionCache(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+  Environment* env = sc->env();
+
+  CHECK_EQ(args.Length(), 2);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsNumber());
+
+  node::Utf8Value path(env->isolate(), args[0]);
+  int64_t size = args[1]->IntegerValue(env->context()).FromJust();
+  CHECK_GT(size, 0);
+
+  int err;
+  SharedSessionCache* cache = SharedSessionCache::Open(*path, size, &err);
+  if (cache == nullptr)
+    return env->ThrowUVException(err, "open", nullptr, *path);
+  sc->session_cache_.reset(cache);
+}
+
+
+void SecureContext::GetSessionCacheStats(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+
+  if (!sc->session_cache_)
+    return args.GetReturnValue().Set(false);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kSessionCacheStatsFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  sc->session_cache_->GetStats(fields);
+  args.GetReturnValue().Set(true);
+}
+
+
 void SecureContext::Close(const FunctionCallbackInfo<Value>& args) {
   SecureContext* sc;
   ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
@@ -1598,43 +1648,59 @@ void SecureContext::GetCertificate(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+template <class Base>
+template <FunctionCallback F>
+void SSLWrap<Base>::UnlessSSLBusy(const FunctionCallbackInfo<Value>& args) {
+  Base* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+  if (w->is_ssl_busy())
+    return;
+  F(args);
+}
+
+
 template <class Base>
 void SSLWrap<Base>::AddMethods(Environment* env, Local<FunctionTemplate> t) {
   HandleScope scope(env->isolate());
 
-  env->SetProtoMethod(t, "getPeerCertificate", GetPeerCertificate);
-  env->SetProtoMethod(t, "getSession", GetSession);
-  env->SetProtoMethod(t, "setSession", SetSession);
-  env->SetProtoMethod(t, "loadSession", LoadSession);
-  env->SetProtoMethod(t, "isSessionReused", IsSessionReused);
-  env->SetProtoMethod(t, "isInitFinished", IsInitFinished);
-  env->SetProtoMethod(t, "verifyError", VerifyError);
-  env->SetProtoMethod(t, "getCurrentCipher", GetCurrentCipher);
+  env->SetProtoMethod(t, "getPeerCertificate",
+                      UnlessSSLBusy<GetPeerCertificate>);
+  env->SetProtoMethod(t, "getSession", UnlessSSLBusy<GetSession>);
+  env->SetProtoMethod(t, "setSession", UnlessSSLBusy<SetSession>);
+  env->SetProtoMethod(t, "loadSession", UnlessSSLBusy<LoadSession>);
+  env->SetProtoMethod(t, "isSessionReused", UnlessSSLBusy<IsSessionReused>);
+  env->SetProtoMethod(t, "isInitFinished", UnlessSSLBusy<IsInitFinished>);
+  env->SetProtoMethod(t, "verifyError", UnlessSSLBusy<VerifyError>);
+  env->SetProtoMethod(t, "getCurrentCipher", UnlessSSLBusy<GetCurrentCipher>);
   env->SetProtoMethod(t, "endParser", EndParser);
   env->SetProtoMethod(t, "certCbDone", CertCbDone);
-  env->SetProtoMethod(t, "renegotiate", Renegotiate);
-  env->SetProtoMethod(t, "shutdownSSL", Shutdown);
-  env->SetProtoMethod(t, "getTLSTicket", GetTLSTicket);
+  env->SetProtoMethod(t, "renegotiate", UnlessSSLBusy<Renegotiate>);
+  env->SetProtoMethod(t, "shutdownSSL", UnlessSSLBusy<Shutdown>);
+  env->SetProtoMethod(t, "getTLSTicket", UnlessSSLBusy<GetTLSTicket>);
   env->SetProtoMethod(t, "newSessionDone", NewSessionDone);
   env->SetProtoMethod(t, "setOCSPResponse", SetOCSPResponse);
-  env->SetProtoMethod(t, "requestOCSP", RequestOCSP);
-  env->SetProtoMethod(t, "getEphemeralKeyInfo", GetEphemeralKeyInfo);
-  env->SetProtoMethod(t, "getProtocol", GetProtocol);
+  env->SetProtoMethod(t, "requestOCSP", UnlessSSLBusy<RequestOCSP>);
+  env->SetProtoMethod(t, "getEphemeralKeyInfo",
+                      UnlessSSLBusy<GetEphemeralKeyInfo>);
+  env->SetProtoMethod(t, "getProtocol", UnlessSSLBusy<GetProtocol>);
 
 #ifdef SSL_set_max_send_fragment
-  env->SetProtoMethod(t, "setMaxSendFragment", SetMaxSendFragment);
+  env->SetProtoMethod(t, "setMaxSendFragment",
+                      UnlessSSLBusy<SetMaxSendFragment>);
 #endif  // SSL_set_max_send_fragment
 
 #ifndef OPENSSL_NO_NEXTPROTONEG
-  env->SetProtoMethod(t, "getNegotiatedProtocol", GetNegotiatedProto);
+  env->SetProtoMethod(t, "getNegotiatedProtocol",
+                      UnlessSSLBusy<GetNegotiatedProto>);
 #endif  // OPENSSL_NO_NEXTPROTONEG
 
 #ifndef OPENSSL_NO_NEXTPROTONEG
-  env->SetProtoMethod(t, "setNPNProtocols", SetNPNProtocols);
+  env->SetProtoMethod(t, "setNPNProtocols", UnlessSSLBusy<SetNPNProtocols>);
 #endif
 
-  env->SetProtoMethod(t, "getALPNNegotiatedProtocol", GetALPNNegotiatedProto);
-  env->SetProtoMethod(t, "setALPNProtocols", SetALPNProtocols);
+  env->SetProtoMethod(t, "getALPNNegotiatedProtocol",
+                      UnlessSSLBusy<GetALPNNegotiatedProto>);
+  env->SetProtoMethod(t, "setALPNProtocols", UnlessSSLBusy<SetALPNProtocols>);
 }
 
 
@@ -1677,6 +1743,10 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = nullptr;
 
+  // A session from the 'resumeSession' event takes precedence.
+  if (sess == nullptr && w->session_cache_)
+    sess = w->session_cache_->Get(key, len);
+
   return sess;
 }
 
@@ -1688,6 +1758,9 @@ int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  if (w->session_cache_)
+    w->session_cache_->Add(sess);
+
   if (!w->session_callbacks_)
     return 0;
 
@@ -2237,7 +2310,7 @@ void SSLWrap<Base>::SetOCSPResponse(
 
   THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "OCSP response");
 
-  w->ocsp_response_.Reset(args.GetIsolate(), args[0].As<Object>());
+  w->ocsp_response_.assign(Buffer::Data(args[0]), Buffer::Length(args[0]));
 #endif  // NODE__HAVE_TLSEXT_STATUS_CB
 }
 
@@ -2428,26 +2501,10 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               const unsigned char** data,
                                               unsigned int* len,
                                               void* arg) {
+  // Does not call into V8, see TLSWrap::CertCallback().
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-
-  auto npn_buffer =
-      w->object()->GetPrivate(
-          env->context(),
-          env->npn_buffer_private_symbol()).ToLocalChecked();
-
-  if (npn_buffer->IsUndefined()) {
-    // No initialization - no NPN protocols
-    *data = reinterpret_cast<const unsigned char*>("");
-    *len = 0;
-  } else {
-    CHECK(Buffer::HasInstance(npn_buffer));
-    *data = reinterpret_cast<const unsigned char*>(Buffer::Data(npn_buffer));
-    *len = Buffer::Length(npn_buffer);
-  }
-
+  *data = reinterpret_cast<const unsigned char*>(w->npn_protos_.data());
+  *len = w->npn_protos_.size();
   return SSL_TLSEXT_ERR_OK;
 }
 
@@ -2556,11 +2613,15 @@ void SSLWrap<Base>::SetNPNProtocols(const FunctionCallbackInfo<Value>& args) {
 
   THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "NPN protocols");
 
-  CHECK(
-      w->object()->SetPrivate(
-          env->context(),
-          env->npn_buffer_private_symbol(),
-          args[0]).FromJust());
+  if (w->is_server()) {
+    w->npn_protos_.assign(Buffer::Data(args[0]), Buffer::Length(args[0]));
+  } else {
+    CHECK(
+        w->object()->SetPrivate(
+            env->context(),
+            env->npn_buffer_private_symbol(),
+            args[0]).FromJust());
+  }
 }
 #endif  // OPENSSL_NO_NEXTPROTONEG
 
@@ -2572,19 +2633,11 @@ int SSLWrap<Base>::SelectALPNCallback(SSL* s,
                                       const unsigned char* in,
                                       unsigned int inlen,
                                       void* arg) {
+  // Does not call into V8, see TLSWrap::CertCallback().
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-
-  Local<Value> alpn_buffer =
-      w->object()->GetPrivate(
-          env->context(),
-          env->alpn_buffer_private_symbol()).ToLocalChecked();
-  CHECK(Buffer::HasInstance(alpn_buffer));
   const unsigned char* alpn_protos =
-      reinterpret_cast<const unsigned char*>(Buffer::Data(alpn_buffer));
-  unsigned alpn_protos_len = Buffer::Length(alpn_buffer);
+      reinterpret_cast<const unsigned char*>(w->alpn_protos_.data());
+  unsigned alpn_protos_len = w->alpn_protos_.size();
   int status = SSL_select_next_proto(const_cast<unsigned char**>(out), outlen,
                                      alpn_protos, alpn_protos_len, in, inlen);
   // According to 3.2. Protocol Selection of RFC7301, fatal
@@ -2635,11 +2688,7 @@ void SSLWrap<Base>::SetALPNProtocols(
     int r = SSL_set_alpn_protos(w->ssl_, alpn_protos, alpn_protos_len);
     CHECK_EQ(r, 0);
   } else {
-    CHECK(
-        w->object()->SetPrivate(
-          env->context(),
-          env->alpn_buffer_private_symbol(),
-          args[0]).FromJust());
+    w->alpn_protos_.assign(Buffer::Data(args[0]), Buffer::Length(args[0]));
     // Server should select ALPN protocol from list of advertised by client
     SSL_CTX_set_alpn_select_cb(SSL_get_SSL_CTX(w->ssl_), SelectALPNCallback,
                                nullptr);
@@ -2653,9 +2702,10 @@ template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
   Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
 
   if (w->is_client()) {
+    HandleScope handle_scope(env->isolate());
+
     // Incoming response
     const unsigned char* resp;
     int len = SSL_get_tlsext_status_ocsp_resp(s, &resp);
@@ -2673,21 +2723,18 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     // Somehow, client is expecting different return value here
     return 1;
   } else {
-    // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
+    // Outgoing response. Does not call into V8, see TLSWrap::CertCallback().
+    if (w->ocsp_response_.empty())
       return SSL_TLSEXT_ERR_NOACK;
 
-    Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
-    char* resp = Buffer::Data(obj);
-    size_t len = Buffer::Length(obj);
-
     // OpenSSL takes control of the pointer after accepting it
+    const size_t len = w->ocsp_response_.size();
     char* data = node::Malloc(len);
-    memcpy(data, resp, len);
+    memcpy(data, w->ocsp_response_.data(), len);
 
     if (!SSL_set_tlsext_status_ocsp_resp(s, data, len))
       free(data);
-    w->ocsp_response_.Reset();
+    w->ocsp_response_.clear();
 
     return SSL_TLSEXT_ERR_OK;
   }
@@ -4967,6 +5014,7 @@ void PBKDF2Request::After(uv_work_t* work_req, int status) {
   CHECK_EQ(status, 0);
   std::unique_ptr<PBKDF2Request> req(
       ContainerOf(&PBKDF2Request::work_req_, work_req));
+  req->env()->threadpool_stats()->Record(THREADPOOL_JOB_PBKDF2, work_req);
   req->After();
 }
 
@@ -5024,10 +5072,11 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
   if (args[5]->IsFunction()) {
     obj->Set(env->context(), env->ondone_string(), args[5]).FromJust();
 
-    uv_queue_work(env->event_loop(),
-                  req.release()->work_req(),
-                  PBKDF2Request::Work,
-                  PBKDF2Request::After);
+    uv_queue_work_kind(env->event_loop(),
+                       req.release()->work_req(),
+                       UV_WORK_CPU,
+                       PBKDF2Request::Work,
+                       PBKDF2Request::After);
   } else {
     env->PrintSyncTrace();
     req->Work();
@@ -5173,6 +5222,7 @@ void RandomBytesAfter(uv_work_t* work_req, int status) {
   std::unique_ptr<RandomBytesRequest> req(
       ContainerOf(&RandomBytesRequest::work_req_, work_req));
   Environment* env = req->env();
+  env->threadpool_stats()->Record(THREADPOOL_JOB_RANDOM_BYTES, work_req);
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
   Local<Value> argv[2];
@@ -5212,10 +5262,11 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
   if (args[1]->IsFunction()) {
     obj->Set(env->context(), env->ondone_string(), args[1]).FromJust();
 
-    uv_queue_work(env->event_loop(),
-                  req.release()->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    uv_queue_work_kind(env->event_loop(),
+                       req.release()->work_req(),
+                       UV_WORK_CPU,
+                       RandomBytesWork,
+                       RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     Local<Value> argv[2];
@@ -5251,10 +5302,11 @@ void RandomBytesBuffer(const FunctionCallbackInfo<Value>& args) {
   if (args[3]->IsFunction()) {
     obj->Set(env->context(), env->ondone_string(), args[3]).FromJust();
 
-    uv_queue_work(env->event_loop(),
-                  req.release()->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    uv_queue_work_kind(env->event_loop(),
+                       req.release()->work_req(),
+                       UV_WORK_CPU,
+                       RandomBytesWork,
+                       RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     Local<Value> argv[2];
@@ -27,6 +27,7 @@
 #include "node.h"
 // ClientHelloParser
 #include "node_crypto_clienthello.h"
+#include "node_crypto_session_cache.h"
 
 #include "node_buffer.h"
 
@@ -51,6 +52,9 @@
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
 
+#include <memory>
+#include <string>
+
 #if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_set_tlsext_status_cb)
 # define NODE__HAVE_TLSEXT_STATUS_CB
 #endif  // !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_set_tlsext_status_cb)
@@ -99,6 +103,9 @@ class SecureContext : public BaseObject {
 
   static const int kMaxSessionSize = 10 * 1024;
 
+  // Set by setSharedSessionCache(), shared with the SSLWraps of the context.
+  std::shared_ptr<SharedSessionCache> session_cache_;
+
   // See TicketKeyCallback
   static const int kTicketKeyReturnIndex = 0;
   static const int kTicketKeyHMACIndex = 1;
@@ -136,6 +143,10 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSessionTimeout(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSharedSessionCache(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetSessionCacheStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
 #ifndef OPENSSL_NO_ENGINE
@@ -213,7 +224,8 @@ class SSLWrap {
         new_session_wait_(false),
         cert_cb_(nullptr),
         cert_cb_arg_(nullptr),
-        cert_cb_running_(false) {
+        cert_cb_running_(false),
+        session_cache_(sc->session_cache_) {
     ssl_ = SSL_new(sc->ctx_);
     env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
     CHECK_NE(ssl_, nullptr);
@@ -231,7 +243,7 @@ class SSLWrap {
 #endif
 
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
-    ocsp_response_.Reset();
+    ocsp_response_.clear();
 #endif  // NODE__HAVE_TLSEXT_STATUS_CB
   }
 
@@ -275,6 +287,11 @@ class SSLWrap {
   static void OnClientHello(void* arg,
                             const ClientHelloParser::ClientHello& hello);
 
+  // Calls F unless the threadpool owns ssl_, see TLSWrap::CertCallback().
+  // The method then returns undefined.
+  template <v8::FunctionCallback F>
+  static void UnlessSSLBusy(const v8::FunctionCallbackInfo<v8::Value>& args);
+
   static void GetPeerCertificate(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSession(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -352,8 +369,16 @@ class SSLWrap {
 
   ClientHelloParser hello_parser_;
 
+  // The shared cache of the SecureContext the SSL was created for, which is
+  // also the one OpenSSL stores sessions for after an SNI context switch.
+  std::shared_ptr<SharedSessionCache> session_cache_;
+
+  // The server-side protocol lists and OCSP response are kept outside of the
+  // JS heap, so that the callbacks which use them can run on the threadpool.
+  std::string npn_protos_;
+  std::string alpn_protos_;
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
-  v8::Persistent<v8::Object> ocsp_response_;
+  std::string ocsp_response_;
 #endif  // NODE__HAVE_TLSEXT_STATUS_CB
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
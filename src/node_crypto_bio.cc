@@ -65,6 +65,30 @@ void NodeBIO::AssignEnvironment(Environment* env) {
 }
 
 
+void NodeBIO::Detach() {
+  CHECK(!detached_);
+  detached_ = true;
+}
+
+
+void NodeBIO::Attach() {
+  CHECK(detached_);
+  detached_ = false;
+  if (pending_external_memory_ != 0) {
+    AdjustExternalMemory(pending_external_memory_);
+    pending_external_memory_ = 0;
+  }
+}
+
+
+void NodeBIO::AdjustExternalMemory(int64_t delta) {
+  if (detached_)
+    pending_external_memory_ += delta;
+  else
+    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(delta);
+}
+
+
 int NodeBIO::New(BIO* bio) {
   BIO_set_data(bio, new NodeBIO());
 
@@ -469,7 +493,7 @@ void NodeBIO::TryAllocateForWrite(size_t hint) {
                              kThroughputBufferLength;
     if (len < hint)
       len = hint;
-    Buffer* next = new Buffer(env_, len);
+    Buffer* next = new Buffer(this, len);
 
     if (w == nullptr) {
       next->next_ = next;
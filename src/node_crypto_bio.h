@@ -39,7 +39,9 @@ class NodeBIO {
               length_(0),
               eof_return_(-1),
               read_head_(nullptr),
-              write_head_(nullptr) {
+              write_head_(nullptr),
+              detached_(false),
+              pending_external_memory_(0) {
   }
 
   ~NodeBIO();
@@ -52,6 +54,11 @@ class NodeBIO {
 
   void AssignEnvironment(Environment* env);
 
+  // While the BIO is detached, it may be used from another thread: changes to
+  // the amount of memory that it holds are reported to V8 on Attach().
+  void Detach();
+  void Attach();
+
   // Move read head to next buffer if needed
   void TryMoveReadHead();
 
@@ -122,31 +129,33 @@ class NodeBIO {
 
   static const BIO_METHOD* GetMethod();
 
+  void AdjustExternalMemory(int64_t delta);
+
   // Enough to handle the most of the client hellos
   static const size_t kInitialBufferLength = 1024;
   static const size_t kThroughputBufferLength = 16384;
 
   class Buffer {
    public:
-    Buffer(Environment* env, size_t len) : env_(env),
-                                           read_pos_(0),
-                                           write_pos_(0),
-                                           len_(len),
-                                           next_(nullptr) {
+    Buffer(NodeBIO* bio, size_t len) : bio_(bio),
+                                       accounted_(bio->env_ != nullptr),
+                                       read_pos_(0),
+                                       write_pos_(0),
+                                       len_(len),
+                                       next_(nullptr) {
       data_ = new char[len];
-      if (env_ != nullptr)
-        env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
+      if (accounted_)
+        bio_->AdjustExternalMemory(static_cast<int64_t>(len_));
     }
 
     ~Buffer() {
       delete[] data_;
-      if (env_ != nullptr) {
-        const int64_t len = static_cast<int64_t>(len_);
-        env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
-      }
+      if (accounted_)
+        bio_->AdjustExternalMemory(-static_cast<int64_t>(len_));
     }
 
-    Environment* env_;
+    NodeBIO* bio_;
+    bool accounted_;
     size_t read_pos_;
     size_t write_pos_;
     size_t len_;
@@ -160,6 +169,8 @@ class NodeBIO {
   int eof_return_;
   Buffer* read_head_;
   Buffer* write_head_;
+  bool detached_;
+  int64_t pending_external_memory_;
 };
 
 }  // namespace crypto
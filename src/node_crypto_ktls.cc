@@ -0,0 +1,229 @@
+#include "node_crypto_ktls.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace node {
+namespace crypto {
+
+#if defined(__linux__) && OPENSSL_VERSION_NUMBER < 0x10100000L
+
+namespace {
+
+// From <linux/tls.h>, which older build hosts do not have.
+const int kSolTLS = 282;
+const int kTcpUlp = 31;
+const int kTLSTx = 1;
+const int kTLSSetRecordType = 1;
+const uint16_t kTLS12Version = 0x0303;
+const uint16_t kTLSCipherAESGCM128 = 51;
+const uint16_t kTLSCipherAESGCM256 = 52;
+
+const unsigned char kAlertRecordType = 21;
+
+// struct tls12_crypto_info_aes_gcm_{128,256}
+template <size_t kKeyLength>
+struct CryptoInfoAESGCM {
+  uint16_t version;
+  uint16_t cipher_type;
+  unsigned char iv[8];
+  unsigned char key[kKeyLength];
+  unsigned char salt[4];
+  unsigned char rec_seq[8];
+};
+
+static_assert(sizeof(CryptoInfoAESGCM<16>) == 40, "unexpected padding");
+static_assert(sizeof(CryptoInfoAESGCM<32>) == 56, "unexpected padding");
+
+
+// The TLS 1.2 PRF, i.e. P_hash(secret, label + seed) from RFC 5246.
+bool PRF(const EVP_MD* md,
+         const unsigned char* secret,
+         size_t secret_length,
+         const char* label,
+         const unsigned char* seed,
+         size_t seed_length,
+         unsigned char* out,
+         size_t out_length) {
+  const size_t md_size = EVP_MD_size(md);
+  const size_t label_length = strlen(label);
+
+  // A(i), followed by the label and the seed.
+  unsigned char buf[EVP_MAX_MD_SIZE + 32 + 2 * SSL3_RANDOM_SIZE];
+  CHECK_LE(label_length + seed_length, sizeof(buf) - EVP_MAX_MD_SIZE);
+  memcpy(buf + md_size, label, label_length);
+  memcpy(buf + md_size + label_length, seed, seed_length);
+  const size_t data_length = md_size + label_length + seed_length;
+
+  unsigned char chunk[EVP_MAX_MD_SIZE];
+  unsigned int chunk_length;
+  // A(1) = HMAC(secret, label + seed)
+  if (HMAC(md, secret, secret_length, buf + md_size, data_length - md_size,
+           chunk, &chunk_length) == nullptr) {
+    return false;
+  }
+  memcpy(buf, chunk, md_size);
+
+  while (out_length > 0) {
+    if (HMAC(md, secret, secret_length, buf, data_length,
+             chunk, &chunk_length) == nullptr) {
+      return false;
+    }
+    const size_t n = out_length < md_size ? out_length : md_size;
+    memcpy(out, chunk, n);
+    out += n;
+    out_length -= n;
+
+    // A(i + 1) = HMAC(secret, A(i))
+    if (HMAC(md, secret, secret_length, buf, md_size,
+             chunk, &chunk_length) == nullptr) {
+      return false;
+    }
+    memcpy(buf, chunk, md_size);
+  }
+
+  OPENSSL_cleanse(chunk, sizeof(chunk));
+  OPENSSL_cleanse(buf, sizeof(buf));
+  return true;
+}
+
+
+template <size_t kKeyLength>
+int SetTxKeys(int fd,
+              uint16_t cipher_type,
+              const unsigned char* key,
+              const unsigned char* salt,
+              const unsigned char* sequence) {
+  CryptoInfoAESGCM<kKeyLength> info;
+  memset(&info, 0, sizeof(info));
+  info.version = kTLS12Version;
+  info.cipher_type = cipher_type;
+  // The explicit part of the nonce only needs to be unique, so it starts
+  // with the sequence number, like the kernel's own counter.
+  memcpy(info.iv, sequence, sizeof(info.iv));
+  memcpy(info.key, key, sizeof(info.key));
+  memcpy(info.salt, salt, sizeof(info.salt));
+  memcpy(info.rec_seq, sequence, sizeof(info.rec_seq));
+
+  const int rc = setsockopt(fd, kSolTLS, kTLSTx, &info, sizeof(info));
+  const int err = rc == 0 ? 0 : uv_translate_sys_error(errno);
+  OPENSSL_cleanse(&info, sizeof(info));
+  return err;
+}
+
+}  // anonymous namespace
+
+
+int StartKernelTLS(SSL* ssl, int fd) {
+  if (fd < 0 ||
+      SSL_version(ssl) != TLS1_2_VERSION ||
+      ssl->enc_write_ctx == nullptr ||
+      ssl->session == nullptr) {
+    return UV_ENOTSUP;
+  }
+
+  const EVP_MD* md;
+  size_t key_length;
+  uint16_t cipher_type;
+  switch (EVP_CIPHER_CTX_nid(ssl->enc_write_ctx)) {
+    case NID_aes_128_gcm:
+      md = EVP_sha256();
+      key_length = 16;
+      cipher_type = kTLSCipherAESGCM128;
+      break;
+    case NID_aes_256_gcm:
+      md = EVP_sha384();
+      key_length = 32;
+      cipher_type = kTLSCipherAESGCM256;
+      break;
+    default:
+      return UV_ENOTSUP;
+  }
+
+  // OpenSSL does not keep the raw keys around, so derive the key block again.
+  // For AEAD ciphers it holds no MAC keys: the client and server write keys
+  // are followed by the implicit parts of the client and server nonces.
+  unsigned char seed[2 * SSL3_RANDOM_SIZE];
+  memcpy(seed, ssl->s3->server_random, SSL3_RANDOM_SIZE);
+  memcpy(seed + SSL3_RANDOM_SIZE, ssl->s3->client_random, SSL3_RANDOM_SIZE);
+  unsigned char key_block[2 * 32 + 2 * 4];
+  if (!PRF(md,
+           ssl->session->master_key,
+           ssl->session->master_key_length,
+           "key expansion",
+           seed,
+           sizeof(seed),
+           key_block,
+           2 * key_length + 2 * 4)) {
+    return UV_EINVAL;
+  }
+  const unsigned char* key = key_block + (ssl->server ? key_length : 0);
+  const unsigned char* salt =
+      key_block + 2 * key_length + (ssl->server ? 4 : 0);
+
+  int err = 0;
+  if (setsockopt(fd, SOL_TCP, kTcpUlp, "tls", sizeof("tls")) != 0)
+    err = uv_translate_sys_error(errno);
+  else if (key_length == 16)
+    err = SetTxKeys<16>(fd, cipher_type, key, salt, ssl->s3->write_sequence);
+  else
+    err = SetTxKeys<32>(fd, cipher_type, key, salt, ssl->s3->write_sequence);
+
+  OPENSSL_cleanse(key_block, sizeof(key_block));
+  return err;
+}
+
+
+int SendKernelTLSCloseNotify(int fd) {
+  unsigned char alert[] = { 1, 0 };  // warning, close_notify
+  struct iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+
+  char control[CMSG_SPACE(sizeof(kAlertRecordType))];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = kSolTLS;
+  cmsg->cmsg_type = kTLSSetRecordType;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(kAlertRecordType));
+  *CMSG_DATA(cmsg) = kAlertRecordType;
+
+  int rc;
+  do {
+    rc = sendmsg(fd, &msg, MSG_DONTWAIT);
+  } while (rc == -1 && errno == EINTR);
+  return rc == -1 ? uv_translate_sys_error(errno) : 0;
+}
+
+#else  // !defined(__linux__) || OPENSSL_VERSION_NUMBER >= 0x10100000L
+
+int StartKernelTLS(SSL* ssl, int fd) {
+  return UV_ENOTSUP;
+}
+
+
+int SendKernelTLSCloseNotify(int fd) {
+  UNREACHABLE();
+}
+
+#endif  // defined(__linux__) && OPENSSL_VERSION_NUMBER < 0x10100000L
+
+}  // namespace crypto
+}  // namespace node
@@ -0,0 +1,35 @@
+#ifndef SRC_NODE_CRYPTO_KTLS_H_
+#define SRC_NODE_CRYPTO_KTLS_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <openssl/ssl.h>
+
+namespace node {
+namespace crypto {
+
+// Kernel TLS, available on Linux 4.13 and newer: once the handshake is done,
+// the keys of the connection are handed to the socket, and the kernel turns
+// the plaintext that is written to it into records.
+//
+// Only the sending side is moved into the kernel. Received records are still
+// decrypted by OpenSSL, which is also needed for alerts and the handshake.
+
+// Installs the keys that `ssl` encrypts outgoing records with on the socket
+// `fd`. Requires TLS 1.2 with AES-GCM. Returns 0 or a UV_* error code; on
+// failure, the connection can continue to be encrypted by OpenSSL.
+//
+// Afterwards, OpenSSL must not send any more records of its own.
+int StartKernelTLS(SSL* ssl, int fd);
+
+// Sends a close_notify alert on a socket that StartKernelTLS() succeeded
+// for. Does not block: returns UV_EAGAIN while the send buffer of the socket
+// is full, 0 or another UV_* error code otherwise.
+int SendKernelTLSCloseNotify(int fd);
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CRYPTO_KTLS_H_
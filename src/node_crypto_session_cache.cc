@@ -0,0 +1,512 @@
+#include "node_crypto_session_cache.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace crypto {
+
+#ifndef _WIN32
+
+namespace {
+
+const uint32_t kMagic = 0x6e747363;  // "ntsc"
+const uint32_t kVersion = 1;
+const uint32_t kNone = 0xffffffff;
+const size_t kAlignment = 64;
+
+// Limits the file to a few GB, and keeps the slot indices far from kNone.
+const uint32_t kMaxSlotsPerStripe = 1 << 16;
+
+inline size_t Align(size_t length) {
+  return (length + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// FNV-1a. Session IDs are random, unless a client chooses its own, which can
+// at worst fill up one stripe.
+uint32_t Hash(const unsigned char* id, unsigned int id_length) {
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < id_length; i++) {
+    hash ^= id[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // anonymous namespace
+
+
+struct SharedSessionCache::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t stripe_count;
+  uint32_t slot_size;
+  uint32_t slots_per_stripe;
+};
+
+// Followed by slots_per_stripe buckets, the heads of the hash chains, and
+// then by the slots, starting at an aligned offset.
+struct SharedSessionCache::Stripe {
+  pthread_mutex_t mutex;
+  // The LRU list starts with the most recently used slot.
+  uint32_t lru_head;
+  uint32_t lru_tail;
+  uint32_t free_head;
+  uint32_t entries;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t stores;
+  uint64_t evictions;
+  uint64_t oversized;
+};
+
+// Followed by the serialized session.
+struct SharedSessionCache::Slot {
+  // Links the hash chain, or the free list.
+  uint32_t hash_next;
+  uint32_t lru_prev;
+  uint32_t lru_next;
+  uint32_t hash;
+  uint32_t data_length;
+  uint32_t id_length;
+  unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+  int64_t expires;
+};
+
+
+SharedSessionCache::SharedSessionCache(char* base, size_t length)
+    : base_(base),
+      length_(length),
+      header_(reinterpret_cast<Header*>(base)) {
+}
+
+
+SharedSessionCache::~SharedSessionCache() {
+  munmap(base_, length_);
+}
+
+
+size_t SharedSessionCache::StripeLength(uint32_t slots) {
+  return Align(sizeof(Stripe) + slots * sizeof(uint32_t)) + slots * kSlotSize;
+}
+
+
+SharedSessionCache* SharedSessionCache::Open(const char* path,
+                                             size_t size,
+                                             int* err) {
+  // The first process to get here lays out the file, the others use that.
+  int fd;
+  struct stat st;
+  for (;;) {
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) {
+      *err = uv_translate_sys_error(errno);
+      return nullptr;
+    }
+
+    int rc;
+    do {
+      rc = flock(fd, LOCK_EX);
+    } while (rc == -1 && errno == EINTR);
+
+    // Another process may have replaced the file while this one waited for
+    // the lock, see below.
+    struct stat path_st;
+    if (fstat(fd, &st) == -1 || stat(path, &path_st) == -1) {
+      *err = uv_translate_sys_error(errno);
+      close(fd);
+      return nullptr;
+    }
+    if (st.st_dev == path_st.st_dev && st.st_ino == path_st.st_ino)
+      break;
+    close(fd);
+  }
+
+  Header header;
+  bool valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+               header.magic == kMagic &&
+               header.version == kVersion &&
+               header.stripe_count == kStripeCount &&
+               header.slot_size == kSlotSize &&
+               header.slots_per_stripe > 0 &&
+               header.slots_per_stripe <= kMaxSlotsPerStripe;
+  size_t length = 0;
+  if (valid) {
+    length = Align(sizeof(header)) +
+             kStripeCount * StripeLength(header.slots_per_stripe);
+    valid = static_cast<size_t>(st.st_size) == length;
+  }
+
+  // A new file, or one with a different layout, e.g. from another version,
+  // which other processes may still have mapped. Resizing it would make
+  // their accesses fault, so the new layout is built in a temporary file
+  // that then replaces it. Those processes keep using the old file.
+  std::string temp_path;
+  int map_fd = fd;
+  *err = 0;
+  if (!valid) {
+    const size_t slots = size / kSlotSize / kStripeCount;
+    if (slots == 0 || slots > kMaxSlotsPerStripe) {
+      *err = UV_EINVAL;
+    } else {
+      header.magic = kMagic;
+      header.version = kVersion;
+      header.stripe_count = kStripeCount;
+      header.slot_size = kSlotSize;
+      header.slots_per_stripe = slots;
+      length = Align(sizeof(header)) + kStripeCount * StripeLength(slots);
+
+      temp_path = std::string(path) + ".XXXXXX";
+      map_fd = mkstemp(&temp_path[0]);
+      if (map_fd == -1) {
+        *err = uv_translate_sys_error(errno);
+        temp_path.clear();
+      } else if (ftruncate(map_fd, length) == -1) {
+        *err = uv_translate_sys_error(errno);
+      }
+    }
+  }
+
+  char* base = nullptr;
+  if (*err == 0) {
+    void* addr =
+        mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, 0);
+    if (addr == MAP_FAILED)
+      *err = uv_translate_sys_error(errno);
+    else
+      base = static_cast<char*>(addr);
+  }
+
+  if (*err == 0 && !valid) {
+    for (size_t i = 0; i < kStripeCount; i++) {
+      InitStripe(reinterpret_cast<Stripe*>(
+          base + Align(sizeof(header)) +
+          i * StripeLength(header.slots_per_stripe)),
+          header.slots_per_stripe);
+    }
+    memcpy(base, &header, sizeof(header));
+    if (rename(temp_path.c_str(), path) == -1) {
+      *err = uv_translate_sys_error(errno);
+      munmap(base, length);
+    } else {
+      temp_path.clear();
+    }
+  }
+
+  if (!temp_path.empty())
+    unlink(temp_path.c_str());
+  if (map_fd != fd && map_fd != -1)
+    close(map_fd);
+  flock(fd, LOCK_UN);
+  close(fd);
+
+  if (*err != 0)
+    return nullptr;
+  return new SharedSessionCache(base, length);
+}
+
+
+void SharedSessionCache::InitStripe(Stripe* stripe, uint32_t slots) {
+  pthread_mutexattr_t attr;
+  CHECK_EQ(0, pthread_mutexattr_init(&attr));
+  CHECK_EQ(0, pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+#ifdef __linux__
+  // Lets the next process recover the stripe if one dies holding the lock.
+  CHECK_EQ(0, pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST));
+#endif
+  CHECK_EQ(0, pthread_mutex_init(&stripe->mutex, &attr));
+  pthread_mutexattr_destroy(&attr);
+
+  stripe->hits = 0;
+  stripe->misses = 0;
+  stripe->stores = 0;
+  stripe->evictions = 0;
+  stripe->oversized = 0;
+  ResetStripe(stripe, slots);
+}
+
+
+void SharedSessionCache::ResetStripe(Stripe* stripe, uint32_t slots) {
+  uint32_t* buckets = reinterpret_cast<uint32_t*>(stripe + 1);
+  for (uint32_t i = 0; i < slots; i++)
+    buckets[i] = kNone;
+
+  char* first = reinterpret_cast<char*>(stripe) +
+                Align(sizeof(Stripe) + slots * sizeof(uint32_t));
+  for (uint32_t i = 0; i < slots; i++) {
+    Slot* slot = reinterpret_cast<Slot*>(first + i * kSlotSize);
+    slot->hash_next = i + 1 < slots ? i + 1 : kNone;
+  }
+
+  stripe->lru_head = kNone;
+  stripe->lru_tail = kNone;
+  stripe->free_head = 0;
+  stripe->entries = 0;
+}
+
+
+SharedSessionCache::Stripe* SharedSessionCache::GetStripe(
+    uint32_t hash) const {
+  return reinterpret_cast<Stripe*>(
+      base_ + Align(sizeof(Header)) +
+      (hash % kStripeCount) * StripeLength(header_->slots_per_stripe));
+}
+
+
+uint32_t* SharedSessionCache::GetBucket(Stripe* stripe, uint32_t hash) const {
+  uint32_t* buckets = reinterpret_cast<uint32_t*>(stripe + 1);
+  return &buckets[(hash / kStripeCount) % header_->slots_per_stripe];
+}
+
+
+SharedSessionCache::Slot* SharedSessionCache::GetSlot(Stripe* stripe,
+                                                      uint32_t index) const {
+  const uint32_t slots = header_->slots_per_stripe;
+  CHECK_LT(index, slots);
+  return reinterpret_cast<Slot*>(
+      reinterpret_cast<char*>(stripe) +
+      Align(sizeof(Stripe) + slots * sizeof(uint32_t)) + index * kSlotSize);
+}
+
+
+uint32_t SharedSessionCache::Find(Stripe* stripe,
+                                  uint32_t hash,
+                                  const unsigned char* id,
+                                  unsigned int id_length) const {
+  uint32_t index = *GetBucket(stripe, hash);
+  while (index != kNone) {
+    Slot* slot = GetSlot(stripe, index);
+    if (slot->hash == hash &&
+        slot->id_length == id_length &&
+        memcmp(slot->id, id, id_length) == 0) {
+      return index;
+    }
+    index = slot->hash_next;
+  }
+  return kNone;
+}
+
+
+// Moves the slot at `index` from the hash table and the LRU list to the free
+// list.
+void SharedSessionCache::Remove(Stripe* stripe, uint32_t index) {
+  Slot* slot = GetSlot(stripe, index);
+
+  uint32_t* link = GetBucket(stripe, slot->hash);
+  while (*link != index)
+    link = &GetSlot(stripe, *link)->hash_next;
+  *link = slot->hash_next;
+
+  if (slot->lru_prev == kNone)
+    stripe->lru_head = slot->lru_next;
+  else
+    GetSlot(stripe, slot->lru_prev)->lru_next = slot->lru_next;
+  if (slot->lru_next == kNone)
+    stripe->lru_tail = slot->lru_prev;
+  else
+    GetSlot(stripe, slot->lru_next)->lru_prev = slot->lru_prev;
+
+  slot->hash_next = stripe->free_head;
+  stripe->free_head = index;
+  stripe->entries--;
+}
+
+
+void SharedSessionCache::Lock(Stripe* stripe) {
+  int err = pthread_mutex_lock(&stripe->mutex);
+#ifdef __linux__
+  if (err == EOWNERDEAD) {
+    // The stripe may have been left inconsistent, start over with it.
+    ResetStripe(stripe, header_->slots_per_stripe);
+    err = pthread_mutex_consistent(&stripe->mutex);
+  }
+#endif
+  CHECK_EQ(err, 0);
+}
+
+
+void SharedSessionCache::Unlock(Stripe* stripe) {
+  CHECK_EQ(0, pthread_mutex_unlock(&stripe->mutex));
+}
+
+
+SSL_SESSION* SharedSessionCache::Get(const unsigned char* id,
+                                     unsigned int id_length) {
+  if (id_length == 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return nullptr;
+
+  const size_t kSlotDataSize = kSlotSize - sizeof(Slot);
+  const uint32_t hash = Hash(id, id_length);
+  Stripe* stripe = GetStripe(hash);
+  const int64_t now = time(nullptr);
+  unsigned char data[kSlotDataSize];
+  size_t length = 0;
+
+  Lock(stripe);
+  uint32_t index = Find(stripe, hash, id, id_length);
+  if (index != kNone) {
+    Slot* slot = GetSlot(stripe, index);
+    // The file is shared, do not trust it to stay within the slot.
+    if (slot->expires <= now || slot->data_length > kSlotDataSize) {
+      Remove(stripe, index);
+    } else {
+      length = slot->data_length;
+      memcpy(data, slot + 1, length);
+
+      // Move it to the front of the LRU list.
+      if (slot->lru_prev != kNone) {
+        GetSlot(stripe, slot->lru_prev)->lru_next = slot->lru_next;
+        if (slot->lru_next == kNone)
+          stripe->lru_tail = slot->lru_prev;
+        else
+          GetSlot(stripe, slot->lru_next)->lru_prev = slot->lru_prev;
+        slot->lru_prev = kNone;
+        slot->lru_next = stripe->lru_head;
+        GetSlot(stripe, stripe->lru_head)->lru_prev = index;
+        stripe->lru_head = index;
+      }
+    }
+  }
+  if (length != 0)
+    stripe->hits++;
+  else
+    stripe->misses++;
+  Unlock(stripe);
+
+  if (length == 0)
+    return nullptr;
+
+  const unsigned char* p = data;
+  return d2i_SSL_SESSION(nullptr, &p, length);
+}
+
+
+void SharedSessionCache::Add(SSL_SESSION* session) {
+  unsigned int id_length;
+  const unsigned char* id = SSL_SESSION_get_id(session, &id_length);
+  if (id_length == 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return;
+
+  const size_t kSlotDataSize = kSlotSize - sizeof(Slot);
+  const uint32_t hash = Hash(id, id_length);
+  Stripe* stripe = GetStripe(hash);
+
+  const int length = i2d_SSL_SESSION(session, nullptr);
+  if (length <= 0 || static_cast<size_t>(length) > kSlotDataSize) {
+    Lock(stripe);
+    stripe->oversized++;
+    Unlock(stripe);
+    return;
+  }
+
+  unsigned char data[kSlotDataSize];
+  unsigned char* p = data;
+  i2d_SSL_SESSION(session, &p);
+  const int64_t expires =
+      static_cast<int64_t>(SSL_SESSION_get_time(session)) +
+      SSL_SESSION_get_timeout(session);
+
+  Lock(stripe);
+  uint32_t index = Find(stripe, hash, id, id_length);
+  if (index != kNone)
+    Remove(stripe, index);
+
+  if (stripe->free_head == kNone) {
+    Remove(stripe, stripe->lru_tail);
+    stripe->evictions++;
+  }
+  index = stripe->free_head;
+  Slot* slot = GetSlot(stripe, index);
+  stripe->free_head = slot->hash_next;
+
+  slot->hash = hash;
+  slot->id_length = id_length;
+  memcpy(slot->id, id, id_length);
+  slot->data_length = length;
+  memcpy(slot + 1, data, length);
+  slot->expires = expires;
+
+  uint32_t* bucket = GetBucket(stripe, hash);
+  slot->hash_next = *bucket;
+  *bucket = index;
+
+  slot->lru_prev = kNone;
+  slot->lru_next = stripe->lru_head;
+  if (stripe->lru_head == kNone)
+    stripe->lru_tail = index;
+  else
+    GetSlot(stripe, stripe->lru_head)->lru_prev = index;
+  stripe->lru_head = index;
+
+  stripe->entries++;
+  stripe->stores++;
+  Unlock(stripe);
+}
+
+
+void SharedSessionCache::GetStats(double* fields) {
+  for (size_t i = 0; i < kSessionCacheStatsFieldsCount; i++)
+    fields[i] = 0;
+
+  for (size_t i = 0; i < kStripeCount; i++) {
+    Stripe* stripe = GetStripe(i);
+    Lock(stripe);
+    fields[kSessionCacheHits] += stripe->hits;
+    fields[kSessionCacheMisses] += stripe->misses;
+    fields[kSessionCacheStores] += stripe->stores;
+    fields[kSessionCacheEvictions] += stripe->evictions;
+    fields[kSessionCacheOversized] += stripe->oversized;
+    fields[kSessionCacheEntries] += stripe->entries;
+    Unlock(stripe);
+  }
+  fields[kSessionCacheCapacity] =
+      static_cast<double>(kStripeCount) * header_->slots_per_stripe;
+}
+
+#else  // _WIN32
+
+SharedSessionCache::~SharedSessionCache() {}
+
+
+SharedSessionCache* SharedSessionCache::Open(const char* path,
+                                             size_t size,
+                                             int* err) {
+  *err = UV_ENOSYS;
+  return nullptr;
+}
+
+
+SSL_SESSION* SharedSessionCache::Get(const unsigned char* id,
+                                     unsigned int id_length) {
+  UNREACHABLE();
+}
+
+
+void SharedSessionCache::Add(SSL_SESSION* session) {
+  UNREACHABLE();
+}
+
+
+void SharedSessionCache::GetStats(double* fields) {
+  UNREACHABLE();
+}
+
+#endif  // _WIN32
+
+}  // namespace crypto
+}  // namespace node
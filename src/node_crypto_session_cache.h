@@ -0,0 +1,92 @@
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+
+#include <openssl/ssl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace crypto {
+
+enum SessionCacheStatsFields {
+  kSessionCacheHits,
+  kSessionCacheMisses,
+  kSessionCacheStores,
+  kSessionCacheEvictions,
+  kSessionCacheOversized,
+  kSessionCacheEntries,
+  kSessionCacheCapacity,
+  kSessionCacheStatsFieldsCount
+};
+
+// A server-side TLS session cache in a file that is mapped into memory, so
+// that the processes which open the same file, e.g. the workers of a cluster,
+// resume each other's sessions.
+//
+// The file is split into kStripeCount stripes by a hash of the session ID.
+// Every stripe has its own process-shared mutex, hash table and LRU list of
+// fixed-size slots, so that processes only contend for the same stripe. When
+// a stripe is full, its least recently used session is evicted. Sessions
+// whose serialized form does not fit into a slot are not stored.
+//
+// The statistics are kept in the file as well, and cover all processes.
+class SharedSessionCache {
+ public:
+  static const size_t kSlotSize = 4096;
+  static const size_t kStripeCount = 16;
+
+  ~SharedSessionCache();
+
+  // Maps the file at `path`, which is created with room for `size` bytes of
+  // slots if it does not exist yet; an existing file keeps its layout. A file
+  // with a different layout is replaced.
+  // Returns nullptr and sets `*err` to a UV_* error code on failure.
+  static SharedSessionCache* Open(const char* path, size_t size, int* err);
+
+  // Returns a new session, which the caller owns, or nullptr.
+  SSL_SESSION* Get(const unsigned char* id, unsigned int id_length);
+  void Add(SSL_SESSION* session);
+
+  // Fills `fields` with kSessionCacheStatsFieldsCount entries.
+  void GetStats(double* fields);
+
+ private:
+  struct Header;
+  struct Stripe;
+  struct Slot;
+
+  SharedSessionCache(char* base, size_t length);
+
+  static size_t StripeLength(uint32_t slots);
+  static void InitStripe(Stripe* stripe, uint32_t slots);
+  static void ResetStripe(Stripe* stripe, uint32_t slots);
+
+  Stripe* GetStripe(uint32_t hash) const;
+  uint32_t* GetBucket(Stripe* stripe, uint32_t hash) const;
+  Slot* GetSlot(Stripe* stripe, uint32_t index) const;
+  uint32_t Find(Stripe* stripe,
+                uint32_t hash,
+                const unsigned char* id,
+                unsigned int id_length) const;
+  void Remove(Stripe* stripe, uint32_t index);
+  void Lock(Stripe* stripe);
+  void Unlock(Stripe* stripe);
+
+  char* base_;
+  size_t length_;
+  Header* header_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedSessionCache);
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
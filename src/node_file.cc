@@ -40,14 +40,21 @@
 # include <io.h>
 #endif
 
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace node {
 
-void FillStatsArray(AliasedBuffer<double, v8::Float64Array>* fields_ptr,
-                    const uv_stat_t* s, int offset) {
-  AliasedBuffer<double, v8::Float64Array>& fields = *fields_ptr;
+// `Fields` is either a pointer or a reference to an AliasedBuffer.
+template <typename Fields>
+static void FillStatsFields(Fields fields, const uv_stat_t* s, int offset) {
   fields[offset + 0] = s->st_dev;
   fields[offset + 1] = s->st_mode;
   fields[offset + 2] = s->st_nlink;
@@ -81,10 +88,18 @@ void FillStatsArray(AliasedBuffer<double, v8::Float64Array>* fields_ptr,
 #undef X
 }
 
+void FillStatsArray(AliasedBuffer<double, v8::Float64Array>* fields_ptr,
+                    const uv_stat_t* s, int offset) {
+  FillStatsFields<AliasedBuffer<double, v8::Float64Array>&>(
+      *fields_ptr, s, offset);
+}
+
 namespace fs {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
+using v8::Exception;
 using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -98,6 +113,9 @@ using v8::MaybeLocal;
 using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::Uint32;
+using v8::Uint32Array;
+using v8::Uint8Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -156,6 +174,7 @@ FSReqAfterScope::FSReqAfterScope(FSReqWrap* wrap, uv_fs_t* req)
       handle_scope_(wrap->env()->isolate()),
       context_scope_(wrap->env()->context()) {
   CHECK_EQ(wrap_->req(), req);
+  wrap->env()->threadpool_stats()->Record(THREADPOOL_JOB_FS, req);
 }
 
 FSReqAfterScope::~FSReqAfterScope() {
@@ -253,7 +272,23 @@ void AfterStringPtr(uv_fs_t* req) {
   }
 }
 
-void AfterScanDir(uv_fs_t* req) {
+// readdir() with withFileTypes returns [names, types], where types holds one
+// UV_DIRENT_* constant per name.
+static Local<Value> NamesWithTypes(Environment* env,
+                                   Local<Array> names,
+                                   const std::vector<uint8_t>& types) {
+  Local<ArrayBuffer> ab = ArrayBuffer::New(env->isolate(), types.size());
+  if (!types.empty())
+    memcpy(ab->GetContents().Data(), types.data(), types.size());
+  Local<Array> result = Array::New(env->isolate(), 2);
+  result->Set(env->context(), 0, names).FromJust();
+  result->Set(env->context(),
+              1,
+              Uint8Array::New(ab, 0, types.size())).FromJust();
+  return result;
+}
+
+static void AfterScanDirImpl(uv_fs_t* req, bool with_types) {
   FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
   FSReqAfterScope after(req_wrap, req);
 
@@ -265,6 +300,7 @@ void AfterScanDir(uv_fs_t* req) {
     Local<Function> fn = env->push_values_to_array_function();
     Local<Value> name_argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
     size_t name_idx = 0;
+    std::vector<uint8_t> types;
 
     for (int i = 0; ; i++) {
       uv_dirent_t ent;
@@ -287,6 +323,8 @@ void AfterScanDir(uv_fs_t* req) {
         return req_wrap->Reject(error);
 
       name_argv[name_idx++] = filename.ToLocalChecked();
+      if (with_types)
+        types.push_back(ent.type);
 
       if (name_idx >= arraysize(name_argv)) {
         fn->Call(env->context(), names, name_idx, name_argv)
@@ -300,10 +338,21 @@ void AfterScanDir(uv_fs_t* req) {
           .ToLocalChecked();
     }
 
-    req_wrap->Resolve(names);
+    if (with_types)
+      req_wrap->Resolve(NamesWithTypes(env, names, types));
+    else
+      req_wrap->Resolve(names);
   }
 }
 
+void AfterScanDir(uv_fs_t* req) {
+  AfterScanDirImpl(req, false);
+}
+
+void AfterScanDirWithTypes(uv_fs_t* req) {
+  AfterScanDirImpl(req, true);
+}
+
 
 // This struct is only used on sync fs calls.
 // For async calls FSReqWrap is used.
@@ -453,6 +502,8 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
   if (strlen(*path) != path.length())
     return;  // Contains a nul byte.
 
+  env->module_resolve_cache()->AddFileDependency(loop, *path);
+
   uv_fs_t open_req;
   const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
   uv_fs_req_cleanup(&open_req);
@@ -512,15 +563,113 @@ static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());
   node::Utf8Value path(env->isolate(), args[0]);
 
-  uv_fs_t req;
-  int rc = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
-  if (rc == 0) {
-    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
-    rc = !!(s->st_mode & S_IFDIR);
+  int rc = env->module_resolve_cache()->Stat(env->event_loop(), *path);
+  args.GetReturnValue().Set(rc);
+}
+
+// Like calling internalModuleStat(base + exts[i]) for every extension, but in
+// a single call. Returns the index of the first one that is a file, or -1.
+static void InternalModuleProbe(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+  node::Utf8Value base(env->isolate(), args[0]);
+  Local<Array> exts_array = args[1].As<Array>();
+
+  std::vector<std::string> exts;
+  exts.reserve(exts_array->Length());
+  for (uint32_t i = 0; i < exts_array->Length(); i++) {
+    Local<Value> ext = exts_array->Get(env->context(), i).ToLocalChecked();
+    CHECK(ext->IsString());
+    exts.emplace_back(*node::Utf8Value(env->isolate(), ext));
   }
-  uv_fs_req_cleanup(&req);
 
-  args.GetReturnValue().Set(rc);
+  int index = env->module_resolve_cache()->Probe(env->event_loop(),
+                                                 *base, exts);
+  args.GetReturnValue().Set(index);
+}
+
+// The stat cache is enabled while the main module is loaded, see
+// Module.prototype._compile().
+static void SetModuleStatCacheEnabled(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  env->module_resolve_cache()->set_stat_cache_enabled(args[0]->IsTrue());
+}
+
+// moduleResolveCacheAddFile(path) records `path` as a dependency of the
+// resolution that is being recorded, for package.json files whose contents JS
+// has cached and does not read with internalModuleReadJSON() again.
+static void ModuleResolveCacheAddFile(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  env->module_resolve_cache()->AddFileDependency(env->event_loop(), *path);
+}
+
+// moduleResolveCacheGet(key) returns the cached filename or undefined, and in
+// that case starts recording the lookups until moduleResolveCacheSet(key,
+// filename) is called.
+static void ModuleResolveCacheGet(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value key(env->isolate(), args[0]);
+
+  std::string filename;
+  if (env->module_resolve_cache()->Get(env->event_loop(),
+                                       std::string(*key, key.length()),
+                                       &filename)) {
+    args.GetReturnValue().Set(
+        String::NewFromUtf8(env->isolate(), filename.data(),
+                            v8::NewStringType::kNormal,
+                            filename.size()).ToLocalChecked());
+  }
+}
+
+static void ModuleResolveCacheSet(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  node::Utf8Value key(env->isolate(), args[0]);
+  node::Utf8Value filename(env->isolate(), args[1]);
+
+  env->module_resolve_cache()->Set(std::string(*key, key.length()),
+                                   std::string(*filename, filename.length()));
+}
+
+static void ModuleResolveCacheLoad(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  bool loaded = env->module_resolve_cache()->Load(env->event_loop(), *path);
+  args.GetReturnValue().Set(loaded);
+}
+
+static void ModuleResolveCacheSave(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  int err = env->module_resolve_cache()->Save(env->event_loop(), *path);
+  args.GetReturnValue().Set(err);
+}
+
+static void GetModuleResolveCacheStats(
+    const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kModuleResolveCacheStatsFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+  Environment::GetCurrent(args)->module_resolve_cache()->GetStats(fields);
 }
 
 static void Stat(const FunctionCallbackInfo<Value>& args) {
@@ -870,10 +1019,12 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   CHECK_NE(*path, nullptr);
 
   const enum encoding encoding = ParseEncoding(env->isolate(), args[1], UTF8);
+  const bool with_types = args[2]->IsTrue();
 
-  if (args[2]->IsObject()) {
-    CHECK_EQ(args.Length(), 3);
-    AsyncCall(env, args, "scandir", encoding, AfterScanDir,
+  if (args[3]->IsObject()) {
+    CHECK_EQ(args.Length(), 4);
+    AsyncCall(env, args, "scandir", encoding,
+              with_types ? AfterScanDirWithTypes : AfterScanDir,
               uv_fs_scandir, *path, 0 /*flags*/);
   } else {
     SYNC_CALL(scandir, *path, *path, 0 /*flags*/)
@@ -884,6 +1035,7 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
     Local<Function> fn = env->push_values_to_array_function();
     Local<Value> name_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
     size_t name_idx = 0;
+    std::vector<uint8_t> types;
 
     for (int i = 0; ; i++) {
       uv_dirent_t ent;
@@ -905,6 +1057,8 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
       }
 
       name_v[name_idx++] = filename.ToLocalChecked();
+      if (with_types)
+        types.push_back(ent.type);
 
       if (name_idx >= arraysize(name_v)) {
         fn->Call(env->context(), names, name_idx, name_v)
@@ -917,7 +1071,10 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
       fn->Call(env->context(), names, name_idx, name_v).ToLocalChecked();
     }
 
-    args.GetReturnValue().Set(names);
+    if (with_types)
+      args.GetReturnValue().Set(NamesWithTypes(env, names, types));
+    else
+      args.GetReturnValue().Set(names);
   }
 }
 
@@ -1168,6 +1325,529 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// A request that makes several file system calls in a single threadpool job
+// and completes its FSReqWrap once, instead of a round trip between the loop
+// and the threadpool per call.
+class FSWorkJob {
+ public:
+  explicit FSWorkJob(FSReqWrap* req_wrap)
+      : req_wrap_(req_wrap),
+        loop_(req_wrap->env()->event_loop()) {}
+
+  virtual ~FSWorkJob() {}
+
+  // Takes ownership of the job and of the FSReqWrap.
+  void Start() {
+    req_wrap_->Dispatched();
+    CHECK_EQ(0, uv_queue_work_kind(loop_, &work_, UV_WORK_FAST_IO,
+                                   Work, After));
+  }
+
+ protected:
+  // Runs on the threadpool, must not touch any JS objects.
+  virtual void DoWork() = 0;
+  // Runs on the loop thread, resolves or rejects the FSReqWrap.
+  virtual void Finish() = 0;
+
+  FSReqWrap* req_wrap() const { return req_wrap_; }
+  uv_loop_t* loop() const { return loop_; }
+
+ private:
+  static void Work(uv_work_t* work) {
+    FSWorkJob* job = ContainerOf(&FSWorkJob::work_, work);
+    job->DoWork();
+  }
+
+  static void After(uv_work_t* work, int status) {
+    std::unique_ptr<FSWorkJob> job(ContainerOf(&FSWorkJob::work_, work));
+    CHECK_EQ(status, 0);
+    FSReqWrap* req_wrap = job->req_wrap_;
+    Environment* env = req_wrap->env();
+    env->threadpool_stats()->Record(THREADPOOL_JOB_FS, work);
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    job->Finish();
+    delete req_wrap;
+  }
+
+  FSReqWrap* const req_wrap_;
+  uv_loop_t* const loop_;
+  uv_work_t work_;
+
+  DISALLOW_COPY_AND_ASSIGN(FSWorkJob);
+};
+
+
+// fs.readFile(): open, fstat, read until EOF and close.
+class ReadFileJob : public FSWorkJob {
+ public:
+  ReadFileJob(FSReqWrap* req_wrap,
+              const char* path,
+              uv_file fd,
+              int flags,
+              enum encoding encoding)
+      : FSWorkJob(req_wrap),
+        path_(path != nullptr ? path : ""),
+        is_user_fd_(path == nullptr),
+        fd_(fd),
+        flags_(flags),
+        encoding_(encoding) {}
+
+  ~ReadFileJob() override {
+    free(data_);
+  }
+
+ private:
+  // Initial buffer size for files whose size fstat() does not report,
+  // e.g. pipes and files in procfs. The buffer doubles whenever it is full.
+  static const size_t kInitialSize = 8 * 1024;
+
+  void DoWork() override {
+    uv_fs_t req;
+    int err;
+
+    if (!is_user_fd_) {
+      err = uv_fs_open(loop(), &req, path_.c_str(), flags_, 0666, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0)
+        return SetError(err, "open");
+      fd_ = err;
+    }
+
+    ReadAll();
+
+    if (!is_user_fd_) {
+      err = uv_fs_close(loop(), &req, fd_, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0 && err_ == 0 && !too_large_)
+        SetError(err, "close");
+    }
+  }
+
+  void ReadAll() {
+    uv_fs_t req;
+    int err = uv_fs_fstat(loop(), &req, fd_, nullptr);
+    // Only trust the size of regular files. Zero means unknown.
+    uint64_t size = 0;
+    if (err == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFREG)
+      size = req.statbuf.st_size;
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return SetError(err, "fstat");
+
+    if (size > Buffer::kMaxLength) {
+      too_large_ = true;
+      return;
+    }
+
+    size_t capacity = size > 0 ? size : kInitialSize;
+    data_ = UncheckedMalloc(capacity);
+    if (data_ == nullptr)
+      return SetError(UV_ENOMEM, "read");
+
+    for (;;) {
+      if (length_ == capacity) {
+        if (size > 0)
+          break;
+        if (capacity == Buffer::kMaxLength) {
+          too_large_ = true;
+          return;
+        }
+        size_t new_capacity = MIN(capacity * 2, Buffer::kMaxLength);
+        char* new_data = UncheckedRealloc(data_, new_capacity);
+        if (new_data == nullptr)
+          return SetError(UV_ENOMEM, "read");
+        data_ = new_data;
+        capacity = new_capacity;
+      }
+
+      uv_buf_t buf = uv_buf_init(data_ + length_, capacity - length_);
+      err = uv_fs_read(loop(), &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0)
+        return SetError(err, "read");
+      if (err == 0)
+        break;
+      length_ += err;
+    }
+  }
+
+  void SetError(int err, const char* syscall) {
+    err_ = err;
+    syscall_ = syscall;
+  }
+
+  void Finish() override {
+    Isolate* isolate = req_wrap()->env()->isolate();
+
+    if (too_large_) {
+      char message[64];
+      snprintf(message, sizeof(message),
+               "File size is greater than possible Buffer: 0x%x bytes",
+               Buffer::kMaxLength);
+      return req_wrap()->Reject(
+          Exception::RangeError(OneByteString(isolate, message)));
+    }
+
+    if (err_ < 0) {
+      // Like the separate requests, only errors from open() carry the path.
+      const char* path =
+          strcmp(syscall_, "open") == 0 ? path_.c_str() : nullptr;
+      return req_wrap()->Reject(
+          UVException(isolate, err_, syscall_, nullptr, path));
+    }
+
+    if (encoding_ == BUFFER) {
+      // The Buffer takes ownership of the memory. Shrinking it is only an
+      // optimization, keep the larger block if that fails.
+      char* data = nullptr;
+      if (length_ > 0) {
+        data = UncheckedRealloc(data_, length_);
+        if (data == nullptr)
+          data = data_;
+      } else {
+        free(data_);
+      }
+      data_ = nullptr;
+      Local<Object> buffer;
+      if (Buffer::New(req_wrap()->env(), data, length_).ToLocal(&buffer))
+        req_wrap()->Resolve(buffer);
+      return;
+    }
+
+    Local<Value> error;
+    MaybeLocal<Value> string =
+        StringBytes::Encode(isolate, data_, length_, encoding_, &error);
+    if (string.IsEmpty())
+      return req_wrap()->Reject(error);
+    req_wrap()->Resolve(string.ToLocalChecked());
+  }
+
+  const std::string path_;
+  const bool is_user_fd_;
+  uv_file fd_;
+  const int flags_;
+  const enum encoding encoding_;
+
+  char* data_ = nullptr;
+  size_t length_ = 0;
+  int err_ = 0;
+  const char* syscall_ = nullptr;
+  bool too_large_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadFileJob);
+};
+
+
+/*
+ * fs.readFile(path, options, callback)
+ *
+ * 0 path      string, Buffer or integer. the file, or a file descriptor that
+ *             is read from its current position and left open
+ * 1 flags     integer. flags to open the file with
+ * 2 encoding  string. encoding of the result, a Buffer if undefined
+ * 3 req       FSReqWrap. completes with the contents of the file
+ */
+static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_EQ(args.Length(), 4);
+  CHECK(args[1]->IsInt32());
+  CHECK(args[3]->IsObject());
+
+  int flags = args[1].As<Int32>()->Value();
+  const enum encoding encoding = ParseEncoding(env->isolate(), args[2], BUFFER);
+
+  FSReqWrap* req_wrap = Unwrap<FSReqWrap>(args[3].As<Object>());
+  CHECK_NE(req_wrap, nullptr);
+  req_wrap->Init("readFile");
+
+  ReadFileJob* job;
+  if (args[0]->IsUint32()) {
+    job = new ReadFileJob(req_wrap, nullptr, args[0].As<Uint32>()->Value(),
+                          flags, encoding);
+  } else {
+    BufferValue path(env->isolate(), args[0]);
+    CHECK_NE(*path, nullptr);
+    job = new ReadFileJob(req_wrap, *path, -1, flags, encoding);
+  }
+  job->Start();
+  args.GetReturnValue().Set(req_wrap->persistent());
+}
+
+
+// fs.walk(): scans directories until a batch of entries is full. The walk
+// itself, the filter and the depth limit are handled in JS, which passes
+// the directories that are left to scan to the next job.
+class ScanDirsJob : public FSWorkJob {
+ public:
+  ScanDirsJob(FSReqWrap* req_wrap,
+              std::vector<std::string>&& dirs,
+              bool with_stats,
+              bool follow_symlinks)
+      : FSWorkJob(req_wrap),
+        dirs_(std::move(dirs)),
+        with_stats_(with_stats),
+        follow_symlinks_(follow_symlinks) {}
+
+ private:
+  // Directories are scanned as a whole, so a batch can exceed this.
+  static const size_t kBatchSize = 1024;
+  static const size_t kStatsFields = 14;
+#ifdef _WIN32
+  static const char kPathSeparator = '\\';
+#else
+  static const char kPathSeparator = '/';
+#endif
+
+  void DoWork() override {
+    for (const std::string& dir : dirs_) {
+      if (!ScanDir(dir))
+        return;
+      if (names_.size() >= kBatchSize)
+        return;
+    }
+  }
+
+  bool ScanDir(const std::string& dir) {
+    uv_fs_t req;
+    int err;
+
+    if (follow_symlinks_) {
+      // The identity of the directory, for detecting cycles.
+      err = uv_fs_stat(loop(), &req, dir.c_str(), nullptr);
+      if (err == 0) {
+        ids_.push_back(req.statbuf.st_dev);
+        ids_.push_back(req.statbuf.st_ino);
+      }
+      uv_fs_req_cleanup(&req);
+      if (err < 0)
+        return SetError(err, "stat", dir);
+    }
+
+    err = uv_fs_scandir(loop(), &req, dir.c_str(), 0, nullptr);
+    if (err < 0) {
+      uv_fs_req_cleanup(&req);
+      return SetError(err, "scandir", dir);
+    }
+
+    uint32_t count = 0;
+    uv_dirent_t ent;
+    while ((err = uv_fs_scandir_next(&req, &ent)) == 0) {
+      uv_dirent_type_t type = ent.type;
+
+      // Only stat when the type is not known from the directory entry, or
+      // when the caller asked for it.
+      if (with_stats_ || type == UV_DIRENT_UNKNOWN ||
+          (follow_symlinks_ && type == UV_DIRENT_LINK)) {
+        std::string path = dir;
+        if (path.empty() || path.back() != kPathSeparator)
+          path += kPathSeparator;
+        path += ent.name;
+
+        uv_stat_t stat;
+        const char* syscall;
+        int stat_err = StatEntry(path, &stat, &syscall);
+        if (stat_err == UV_ENOENT)
+          continue;  // Removed since the directory was read.
+        if (stat_err < 0) {
+          uv_fs_req_cleanup(&req);
+          return SetError(stat_err, syscall, path);
+        }
+
+        type = TypeFromMode(stat.st_mode);
+        if (with_stats_) {
+          size_t offset = stats_.size();
+          stats_.resize(offset + kStatsFields);
+          FillStatsFields(stats_.data(), &stat, offset);
+        }
+      }
+
+      names_.push_back(ent.name);
+      types_.push_back(type);
+      count++;
+    }
+    uv_fs_req_cleanup(&req);
+    if (err != UV_EOF)
+      return SetError(err, "scandir", dir);
+
+    counts_.push_back(count);
+    return true;
+  }
+
+  int StatEntry(const std::string& path,
+                uv_stat_t* stat,
+                const char** syscall) {
+    uv_fs_t req;
+    int err = UV_ENOENT;
+    if (follow_symlinks_) {
+      *syscall = "stat";
+      err = uv_fs_stat(loop(), &req, path.c_str(), nullptr);
+      if (err == 0)
+        *stat = req.statbuf;
+      uv_fs_req_cleanup(&req);
+    }
+    // Dangling symlinks are reported as links.
+    if (err == UV_ENOENT) {
+      *syscall = "lstat";
+      err = uv_fs_lstat(loop(), &req, path.c_str(), nullptr);
+      if (err == 0)
+        *stat = req.statbuf;
+      uv_fs_req_cleanup(&req);
+    }
+    return err;
+  }
+
+  static uv_dirent_type_t TypeFromMode(uint64_t mode) {
+    switch (mode & S_IFMT) {
+      case S_IFREG: return UV_DIRENT_FILE;
+      case S_IFDIR: return UV_DIRENT_DIR;
+#ifdef S_IFLNK
+      case S_IFLNK: return UV_DIRENT_LINK;
+#endif
+#ifdef S_IFIFO
+      case S_IFIFO: return UV_DIRENT_FIFO;
+#endif
+#ifdef S_IFSOCK
+      case S_IFSOCK: return UV_DIRENT_SOCKET;
+#endif
+#ifdef S_IFCHR
+      case S_IFCHR: return UV_DIRENT_CHAR;
+#endif
+#ifdef S_IFBLK
+      case S_IFBLK: return UV_DIRENT_BLOCK;
+#endif
+      default: return UV_DIRENT_UNKNOWN;
+    }
+  }
+
+  bool SetError(int err, const char* syscall, const std::string& path) {
+    err_ = err;
+    syscall_ = syscall;
+    error_path_ = path;
+    return false;
+  }
+
+  void Finish() override {
+    Environment* env = req_wrap()->env();
+    Isolate* isolate = env->isolate();
+    Local<Context> context = env->context();
+
+    if (err_ < 0) {
+      return req_wrap()->Reject(UVException(isolate, err_, syscall_, nullptr,
+                                            error_path_.c_str()));
+    }
+
+    Local<Array> names = Array::New(isolate, 0);
+    Local<Function> fn = env->push_values_to_array_function();
+    Local<Value> name_argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
+    size_t name_idx = 0;
+    for (const std::string& name : names_) {
+      name_argv[name_idx++] =
+          String::NewFromUtf8(isolate, name.data(), v8::NewStringType::kNormal,
+                              name.size()).ToLocalChecked();
+      if (name_idx >= arraysize(name_argv)) {
+        fn->Call(context, names, name_idx, name_argv).ToLocalChecked();
+        name_idx = 0;
+      }
+    }
+    if (name_idx > 0)
+      fn->Call(context, names, name_idx, name_argv).ToLocalChecked();
+
+    Local<Value> result[] = {
+      Integer::NewFromUnsigned(isolate, counts_.size()),
+      Uint32Array::New(CopyToArrayBuffer(isolate, counts_), 0, counts_.size()),
+      names,
+      Uint8Array::New(CopyToArrayBuffer(isolate, types_), 0, types_.size()),
+      Undefined(isolate),
+      Undefined(isolate)
+    };
+    if (with_stats_) {
+      result[4] = Float64Array::New(CopyToArrayBuffer(isolate, stats_),
+                                    0, stats_.size());
+    }
+    if (follow_symlinks_) {
+      result[5] = Float64Array::New(CopyToArrayBuffer(isolate, ids_),
+                                    0, ids_.size());
+    }
+
+    Local<Array> array = Array::New(isolate, arraysize(result));
+    for (size_t i = 0; i < arraysize(result); i++)
+      array->Set(context, i, result[i]).FromJust();
+    req_wrap()->Resolve(array);
+  }
+
+  template <typename T>
+  static Local<ArrayBuffer> CopyToArrayBuffer(Isolate* isolate,
+                                              const std::vector<T>& values) {
+    size_t size = values.size() * sizeof(T);
+    Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, size);
+    if (size > 0)
+      memcpy(ab->GetContents().Data(), values.data(), size);
+    return ab;
+  }
+
+  const std::vector<std::string> dirs_;
+  const bool with_stats_;
+  const bool follow_symlinks_;
+
+  // Per scanned directory.
+  std::vector<uint32_t> counts_;
+  std::vector<double> ids_;
+  // Per entry.
+  std::vector<std::string> names_;
+  std::vector<uint8_t> types_;
+  std::vector<double> stats_;
+
+  int err_ = 0;
+  const char* syscall_ = nullptr;
+  std::string error_path_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanDirsJob);
+};
+
+
+/*
+ * fs.walk(root, options)
+ *
+ * 0 dirs            array of strings. directories to scan, in order
+ * 1 withStats       boolean. stat every entry
+ * 2 followSymlinks  boolean. report what symlinks point to, and the dev and
+ *                   ino of every scanned directory
+ * 3 req             FSReqWrap. completes with
+ *                   [scanned, counts, names, types, stats, ids]
+ */
+static void ScanDirs(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_EQ(args.Length(), 4);
+  CHECK(args[0]->IsArray());
+  CHECK(args[3]->IsObject());
+
+  Local<Array> array = args[0].As<Array>();
+  CHECK_GT(array->Length(), 0);
+  std::vector<std::string> dirs;
+  dirs.reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> dir = array->Get(env->context(), i).ToLocalChecked();
+    CHECK(dir->IsString());
+    node::Utf8Value path(env->isolate(), dir);
+    dirs.emplace_back(*path, path.length());
+  }
+
+  FSReqWrap* req_wrap = Unwrap<FSReqWrap>(args[3].As<Object>());
+  CHECK_NE(req_wrap, nullptr);
+  req_wrap->Init("scandir");
+
+  ScanDirsJob* job = new ScanDirsJob(req_wrap,
+                                     std::move(dirs),
+                                     args[1]->IsTrue(),
+                                     args[2]->IsTrue());
+  job->Start();
+  args.GetReturnValue().Set(req_wrap->persistent());
+}
+
+
 /* fs.chmod(path, mode);
  * Wrapper for chmod(1) / EIO_CHMOD
  */
@@ -1336,6 +2016,154 @@ static void Mkdtemp(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Flags of fs.mmap(), see lib/fs.js.
+enum MMapFlags {
+  kMMapShared = 1 << 0,
+  kMMapPopulate = 1 << 1,
+  kMMapHugePages = 1 << 2
+};
+
+// Indexes into the advice names in lib/fs.js.
+enum MMapAdvice {
+  kMMapAdviceNormal,
+  kMMapAdviceRandom,
+  kMMapAdviceSequential,
+  kMMapAdviceWillNeed,
+  kMMapAdviceDontNeed,
+  kMMapAdviceCount
+};
+
+struct MappedRegion {
+  void* base;
+  size_t length;
+};
+
+static void Unmap(char* data, void* hint) {
+  MappedRegion* region = static_cast<MappedRegion*>(hint);
+#ifdef _WIN32
+  CHECK(UnmapViewOfFile(region->base));
+#else
+  CHECK_EQ(0, munmap(region->base, region->length));
+#endif
+  delete region;
+}
+
+#ifndef _WIN32
+static void Advise(void* base, size_t length, int flags, int advice) {
+  // These are hints, failing to apply them is not an error.
+  static const int kAdvice[kMMapAdviceCount] = {
+    MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL, MADV_WILLNEED, MADV_DONTNEED
+  };
+  if (advice != kMMapAdviceNormal)
+    madvise(base, length, kAdvice[advice]);
+#ifdef MADV_HUGEPAGE
+  if (flags & kMMapHugePages)
+    madvise(base, length, MADV_HUGEPAGE);
+#endif
+#ifndef MAP_POPULATE
+  if (flags & kMMapPopulate)
+    madvise(base, length, MADV_WILLNEED);
+#endif
+}
+#endif
+
+// mmap(fd, offset, length, flags, advice, ctx)
+//
+// Maps `length` bytes of `fd` starting at `offset` and returns a Buffer that
+// points into the mapping, which is unmapped when the Buffer is garbage
+// collected. Private mappings are copy-on-write: pages are shared with the
+// page cache until they are written to, and writes never reach the file.
+// lib/fs.js checks that the range lies within the file, pages past its end
+// raise SIGBUS when they are accessed.
+static void MMap(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_EQ(args.Length(), 6);
+  CHECK(args[0]->IsInt32());
+  const int fd = args[0].As<Int32>()->Value();
+  CHECK(args[1]->IsNumber());
+  const int64_t offset = args[1].As<Integer>()->Value();
+  CHECK_GE(offset, 0);
+  CHECK(args[2]->IsUint32());
+  const size_t length = args[2].As<Uint32>()->Value();
+  CHECK_GT(length, 0);
+  CHECK_LE(length, Buffer::kMaxLength);
+  CHECK(args[3]->IsInt32());
+  const int flags = args[3].As<Int32>()->Value();
+  CHECK(args[4]->IsInt32());
+  const int advice = args[4].As<Int32>()->Value();
+  CHECK(advice >= 0 && advice < kMMapAdviceCount);
+  CHECK(args[5]->IsObject());
+
+  env->PrintSyncTrace();
+
+  // The offset of a mapping must be aligned, map from the start of the page
+  // (or allocation granule on Windows) and skip the first bytes.
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const int64_t granularity = info.dwAllocationGranularity;
+#else
+  const int64_t granularity = sysconf(_SC_PAGESIZE);
+#endif
+  const int64_t aligned_offset = offset - offset % granularity;
+  const size_t skip = static_cast<size_t>(offset - aligned_offset);
+  const size_t map_length = length + skip;
+
+  void* base;
+  int err = 0;
+#ifdef _WIN32
+  HANDLE file = reinterpret_cast<HANDLE>(uv_get_osfhandle(fd));
+  HANDLE mapping = CreateFileMappingW(
+      file, nullptr, (flags & kMMapShared) ? PAGE_READWRITE : PAGE_WRITECOPY,
+      0, 0, nullptr);
+  base = nullptr;
+  if (mapping != nullptr) {
+    base = MapViewOfFile(
+        mapping, (flags & kMMapShared) ? FILE_MAP_WRITE : FILE_MAP_COPY,
+        static_cast<DWORD>(aligned_offset >> 32),
+        static_cast<DWORD>(aligned_offset & 0xFFFFFFFF),
+        map_length);
+  }
+  if (base == nullptr)
+    err = uv_translate_sys_error(GetLastError());
+  if (mapping != nullptr)
+    CloseHandle(mapping);  // The view keeps the mapping alive.
+#else
+  int map_flags = (flags & kMMapShared) ? MAP_SHARED : MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if (flags & kMMapPopulate)
+    map_flags |= MAP_POPULATE;
+#endif
+  base = mmap(nullptr, map_length, PROT_READ | PROT_WRITE, map_flags, fd,
+              static_cast<off_t>(aligned_offset));
+  if (base == MAP_FAILED)
+    err = -errno;
+  else
+    Advise(base, map_length, flags, advice);
+#endif
+
+  if (err != 0) {
+    Local<Object> ctx = args[5].As<Object>();
+    ctx->Set(env->context(),
+             env->errno_string(),
+             Integer::New(env->isolate(), err)).FromJust();
+    ctx->Set(env->context(),
+             env->syscall_string(),
+             OneByteString(env->isolate(), "mmap")).FromJust();
+    return;
+  }
+
+  MappedRegion* region = new MappedRegion { base, map_length };
+  Local<Object> buffer;
+  if (!Buffer::New(env, static_cast<char*>(base) + skip, length,
+                   Unmap, region).ToLocal(&buffer)) {
+    Unmap(nullptr, region);
+    return;
+  }
+  args.GetReturnValue().Set(buffer);
+}
+
 void InitFs(Local<Object> target,
             Local<Value> unused,
             Local<Context> context,
@@ -1346,6 +2174,7 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "close", Close);
   env->SetMethod(target, "open", Open);
   env->SetMethod(target, "read", Read);
+  env->SetMethod(target, "readFile", ReadFile);
   env->SetMethod(target, "fdatasync", Fdatasync);
   env->SetMethod(target, "fsync", Fsync);
   env->SetMethod(target, "rename", Rename);
@@ -1353,8 +2182,20 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "rmdir", RMDir);
   env->SetMethod(target, "mkdir", MKDir);
   env->SetMethod(target, "readdir", ReadDir);
+  env->SetMethod(target, "scanDirs", ScanDirs);
   env->SetMethod(target, "internalModuleReadJSON", InternalModuleReadJSON);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleProbe", InternalModuleProbe);
+  env->SetMethod(target, "setModuleStatCacheEnabled",
+                 SetModuleStatCacheEnabled);
+  env->SetMethod(target, "moduleResolveCacheAddFile",
+                 ModuleResolveCacheAddFile);
+  env->SetMethod(target, "moduleResolveCacheGet", ModuleResolveCacheGet);
+  env->SetMethod(target, "moduleResolveCacheSet", ModuleResolveCacheSet);
+  env->SetMethod(target, "moduleResolveCacheLoad", ModuleResolveCacheLoad);
+  env->SetMethod(target, "moduleResolveCacheSave", ModuleResolveCacheSave);
+  env->SetMethod(target, "getModuleResolveCacheStats",
+                 GetModuleResolveCacheStats);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
@@ -1381,6 +2222,8 @@ void InitFs(Local<Object> target,
 
   env->SetMethod(target, "mkdtemp", Mkdtemp);
 
+  env->SetMethod(target, "mmap", MMap);
+
   target->Set(context,
               FIXED_ONE_BYTE_STRING(env->isolate(), "statValues"),
               env->fs_stats_field_array()->GetJSArray()).FromJust();
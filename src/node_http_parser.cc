@@ -32,6 +32,11 @@
 #include <stdlib.h>  // free()
 #include <string.h>  // strdup()
 
+#include <iterator>  // std::next()
+#include <memory>
+#include <string>
+#include <vector>
+
 // This is a binding to http_parser (https://github.com/nodejs/http-parser)
 // The goal is to decouple sockets from parsing for more javascript-level
 // agility. A Buffer is read from a socket and passed to parser.execute().
@@ -51,6 +56,7 @@ using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Eternal;
 using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -59,6 +65,7 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::NewStringType;
 using v8::Object;
 using v8::String;
 using v8::Uint32;
@@ -72,60 +79,267 @@ const uint32_t kOnMessageComplete = 3;
 const uint32_t kOnExecute = 4;
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+// Header names and values that show up in most messages. They are turned
+// into internalized strings once per isolate and shared by all messages,
+// instead of allocating new strings for every header of every request.
+const char* const kCommonHeaderNames[] = {
+  "Accept",
+  "Accept-Charset",
+  "Accept-Encoding",
+  "Accept-Language",
+  "Accept-Ranges",
+  "Access-Control-Allow-Origin",
+  "Age",
+  "Authorization",
+  "Cache-Control",
+  "Connection",
+  "Content-Encoding",
+  "Content-Language",
+  "Content-Length",
+  "Content-Type",
+  "Cookie",
+  "Date",
+  "DNT",
+  "ETag",
+  "Expect",
+  "Expires",
+  "Host",
+  "If-Modified-Since",
+  "If-None-Match",
+  "Keep-Alive",
+  "Last-Modified",
+  "Location",
+  "Origin",
+  "Pragma",
+  "Proxy-Connection",
+  "Range",
+  "Referer",
+  "Sec-WebSocket-Accept",
+  "Sec-WebSocket-Key",
+  "Sec-WebSocket-Version",
+  "Server",
+  "Set-Cookie",
+  "Trailer",
+  "Transfer-Encoding",
+  "Upgrade",
+  "Upgrade-Insecure-Requests",
+  "User-Agent",
+  "Vary",
+  "Via",
+  "X-Forwarded-For",
+  "X-Forwarded-Host",
+  "X-Forwarded-Proto",
+  "X-Powered-By",
+  "X-Real-IP",
+  "X-Requested-With"
+};
+
+const char* const kCommonHeaderValues[] = {
+  "*/*",
+  "0",
+  "1",
+  "100-continue",
+  "application/json",
+  "application/x-www-form-urlencoded",
+  "bytes",
+  "chunked",
+  "close",
+  "Close",
+  "deflate",
+  "gzip",
+  "gzip, deflate",
+  "gzip, deflate, br",
+  "identity",
+  "keep-alive",
+  "Keep-Alive",
+  "max-age=0",
+  "no-cache",
+  "text/html",
+  "text/html; charset=utf-8",
+  "text/plain",
+  "text/plain; charset=utf-8",
+  "websocket"
+};
+
+
+// Open addressing hash table over the common header strings. The hash is
+// case-insensitive so that all spellings of a name share a probe sequence,
+// but only an exact match is a hit: header names are passed to JS as they
+// were received, e.g. for message.rawHeaders. Every name is stored as listed
+// and in lower case, which covers what clients send in practice.
+class HeaderStringTable {
+ public:
+  static const size_t kMaxLength = 48;
+
+  static const HeaderStringTable& Get() {
+    static const HeaderStringTable table;
+    return table;
+  }
+
+  // Returns the index of the entry that is equal to `str`, or -1.
+  int Find(const char* str, size_t size) const {
+    if (size == 0 || size > kMaxLength)
+      return -1;
+    size_t i = Hash(str, size);
+    for (; buckets_[i] != -1; i = (i + 1) % kBuckets) {
+      const std::string& entry = strings_[buckets_[i]];
+      if (entry.size() == size && memcmp(entry.data(), str, size) == 0)
+        return buckets_[i];
+    }
+    return -1;
+  }
+
+  const std::string& at(size_t index) const { return strings_[index]; }
+  size_t size() const { return strings_.size(); }
+
+ private:
+  static const size_t kBuckets = 512;
+
+  HeaderStringTable() {
+    for (size_t i = 0; i < kBuckets; i++)
+      buckets_[i] = -1;
+    for (const char* name : kCommonHeaderNames) {
+      std::string lower(name);
+      for (char& c : lower)
+        c = ToLower(c);
+      Insert(name);
+      Insert(lower);
+    }
+    for (const char* value : kCommonHeaderValues)
+      Insert(value);
+    CHECK_LE(strings_.size(), kBuckets / 2);
   }
 
+  static size_t Hash(const char* str, size_t size) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<uint8_t>(ToLower(str[i]));
+      hash *= 16777619u;
+    }
+    return hash % kBuckets;
+  }
+
+  void Insert(const std::string& str) {
+    CHECK_LE(str.size(), kMaxLength);
+    if (Find(str.data(), str.size()) != -1)
+      return;  // Names that are all lower case or also listed as values.
+    size_t i = Hash(str.data(), str.size());
+    while (buckets_[i] != -1)
+      i = (i + 1) % kBuckets;
+    buckets_[i] = static_cast<int16_t>(strings_.size());
+    strings_.push_back(str);
+  }
+
+  std::vector<std::string> strings_;
+  int16_t buckets_[kBuckets];
+};
+
+
+// Storage for header bytes that have to outlive the buffer they were parsed
+// from. Allocations are carved out of blocks that never move, so strings that
+// were saved earlier stay valid while the arena grows. Everything is released
+// at once when the next message starts.
+class StringArena {
+ public:
+  static const size_t kBlockSize = 4096;
 
-  ~StringPtr() {
+  char* Allocate(size_t size) {
+    if (size > kBlockSize / 4) {
+      large_.emplace_back(new char[size]);
+      return large_.back().get();
+    }
+
+    if (blocks_in_use_ == 0 || kBlockSize - used_ < size) {
+      if (blocks_in_use_ == blocks_.size())
+        blocks_.emplace_back(new char[kBlockSize]);
+      blocks_in_use_++;
+      used_ = 0;
+    }
+
+    char* ptr = blocks_[blocks_in_use_ - 1].get() + used_;
+    used_ += size;
+    return ptr;
+  }
+
+  // Gives back an allocation that was superseded by a larger copy. Only large
+  // allocations are freed right away, smaller ones stay until Reset().
+  void Free(char* ptr, size_t size) {
+    if (size <= kBlockSize / 4)
+      return;
+
+    for (auto it = large_.rbegin(); it != large_.rend(); ++it) {
+      if (it->get() == ptr) {
+        large_.erase(std::next(it).base());
+        return;
+      }
+    }
+  }
+
+  void Reset() {
+    large_.clear();
+    // Keep one block around for the next message.
+    if (blocks_.size() > 1)
+      blocks_.resize(1);
+    blocks_in_use_ = 0;
+    used_ = 0;
+  }
+
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::vector<std::unique_ptr<char[]>> large_;
+  size_t blocks_in_use_ = 0;
+  size_t used_ = 0;
+};
+
+
+// helper class for the Parser
+struct StringPtr {
+  StringPtr() {
     Reset();
   }
 
 
-  // If str_ does not point to a heap string yet, this function makes it do
+  // If str_ does not point into the arena yet, this function makes it do
   // so. This is called at the end of each http_parser_execute() so as not
   // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
-  void Save() {
-    if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
+  void Save(StringArena* arena) {
+    if (!saved_ && size_ > 0) {
+      char* s = arena->Allocate(size_);
       memcpy(s, str_, size_);
       str_ = s;
-      on_heap_ = true;
+      saved_ = true;
+      capacity_ = size_;
     }
   }
 
   // 重置字段
   void Reset() {
-    // 数据是在堆上分配的则free
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
-    }
-
     str_ = nullptr;
+    saved_ = false;
     size_ = 0;
+    capacity_ = 0;
   }
 
 
-  void Update(const char* str, size_t size) {
+  void Update(const char* str, size_t size, StringArena* arena) {
     if (str_ == nullptr) {
       str_ = str;
-    } else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
+    } else if (saved_ && size_ + size <= capacity_) {
+      // The copy in the arena still has room for the new input.
+      memcpy(const_cast<char*>(str_) + size_, str, size);
+    } else if (saved_ || str_ + size_ != str) {
+      // Non-consecutive input, make a copy in the arena. Its capacity is
+      // doubled, so that a string that arrives in many small pieces is only
+      // copied a logarithmic number of times.
+      const size_t capacity = 2 * (size_ + size);
+      char* s = arena->Allocate(capacity);
       memcpy(s, str_, size_);
       memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
+      if (saved_)
+        arena->Free(const_cast<char*>(str_), capacity_);
       str_ = s;
+      saved_ = true;
+      capacity_ = capacity;
     }
     size_ += size;
   }
@@ -139,9 +353,39 @@ struct StringPtr {
   }
 
 
+  // Same as ToString(), but common header names and values are looked up in
+  // HeaderStringTable and returned as shared internalized strings.
+  Local<String> ToInternedString(Environment* env) const {
+    const HeaderStringTable& table = HeaderStringTable::Get();
+    const int index = table.Find(str_, size_);
+    if (index == -1)
+      return ToString(env);
+
+    std::vector<Eternal<String>>& strings =
+        env->isolate_data()->http_parser_strs;
+    if (strings.empty())
+      strings.resize(table.size());
+
+    Eternal<String>& eternal = strings[index];
+    if (eternal.IsEmpty()) {
+      const std::string& entry = table.at(index);
+      Local<String> str =
+          String::NewFromOneByte(env->isolate(),
+                                 reinterpret_cast<const uint8_t*>(entry.data()),
+                                 NewStringType::kInternalized,
+                                 entry.size()).ToLocalChecked();
+      eternal.Set(env->isolate(), str);
+      return str;
+    }
+    return eternal.Get(env->isolate());
+  }
+
+
   const char* str_;
-  bool on_heap_;
+  bool saved_;
   size_t size_;
+  // The size of the arena allocation that str_ points to, if saved_ is set.
+  size_t capacity_;
 };
 
 
@@ -171,18 +415,19 @@ class Parser : public AsyncWrap, public StreamListener {
     num_fields_ = num_values_ = 0;
     url_.Reset();
     status_message_.Reset();
+    arena_.Reset();
     return 0;
   }
 
 
   int on_url(const char* at, size_t length) {
-    url_.Update(at, length);
+    url_.Update(at, length, &arena_);
     return 0;
   }
 
 
   int on_status(const char* at, size_t length) {
-    status_message_.Update(at, length);
+    status_message_.Update(at, length, &arena_);
     return 0;
   }
 
@@ -191,19 +436,17 @@ class Parser : public AsyncWrap, public StreamListener {
     if (num_fields_ == num_values_) {
       // start of new field name
       num_fields_++;
-      if (num_fields_ == arraysize(fields_)) {
-        // ran out of space - flush to javascript land
-        Flush();
-        num_fields_ = 1;
-        num_values_ = 0;
+      if (num_fields_ > fields_.size()) {
+        fields_.resize(num_fields_);
+        values_.resize(num_fields_);
       }
       fields_[num_fields_ - 1].Reset();
     }
 
-    CHECK_LT(num_fields_, arraysize(fields_));
+    CHECK_LE(num_fields_, fields_.size());
     CHECK_EQ(num_fields_, num_values_ + 1);
 
-    fields_[num_fields_ - 1].Update(at, length);
+    fields_[num_fields_ - 1].Update(at, length, &arena_);
 
     return 0;
   }
@@ -216,10 +459,10 @@ class Parser : public AsyncWrap, public StreamListener {
       values_[num_values_ - 1].Reset();
     }
 
-    CHECK_LT(num_values_, arraysize(values_));
+    CHECK_LE(num_values_, values_.size());
     CHECK_EQ(num_values_, num_fields_);
 
-    values_[num_values_ - 1].Update(at, length);
+    values_[num_values_ - 1].Update(at, length, &arena_);
 
     return 0;
   }
@@ -253,15 +496,10 @@ class Parser : public AsyncWrap, public StreamListener {
     for (size_t i = 0; i < arraysize(argv); i++)
       argv[i] = undefined;
 
-    if (have_flushed_) {
-      // Slow case, flush remaining headers.
-      Flush();
-    } else {
-      // Fast case, pass headers and URL to JS land.
-      argv[A_HEADERS] = CreateHeaders();
-      if (parser_.type == HTTP_REQUEST)
-        argv[A_URL] = url_.ToString(env());
-    }
+    // All headers of the message are passed to JS land at once.
+    argv[A_HEADERS] = CreateHeaders();
+    if (parser_.type == HTTP_REQUEST)
+      argv[A_URL] = url_.ToString(env());
 
     num_fields_ = 0;
     num_values_ = 0;
@@ -274,7 +512,7 @@ class Parser : public AsyncWrap, public StreamListener {
 
     // STATUS
     if (parser_.type == HTTP_RESPONSE) {
-      argv[A_STATUS_CODE] =lo
+      argv[A_STATUS_CODE] =
           Integer::New(env()->isolate(), parser_.status_code);
       argv[A_STATUS_MESSAGE] = status_message_.ToString(env());
     }
@@ -394,15 +632,15 @@ class Parser : public AsyncWrap, public StreamListener {
 
 
   void Save() {
-    url_.Save();
-    status_message_.Save();
+    url_.Save(&arena_);
+    status_message_.Save(&arena_);
 
     for (size_t i = 0; i < num_fields_; i++) {
-      fields_[i].Save();
+      fields_[i].Save(&arena_);
     }
 
     for (size_t i = 0; i < num_values_; i++) {
-      values_[i].Save();
+      values_[i].Save(&arena_);
     }
   }
 
@@ -608,6 +846,7 @@ class Parser : public AsyncWrap, public StreamListener {
     return scope.Escape(nparsed_obj);
   }
 
+  // Returns the headers as one flat [name, value, ...] array.
   Local<Array> CreateHeaders() {
     Local<Array> headers = Array::New(env()->isolate());
     Local<Function> fn = env()->push_values_to_array_function();
@@ -617,8 +856,8 @@ class Parser : public AsyncWrap, public StreamListener {
     do {
       size_t j = 0;
       while (i < num_values_ && j < arraysize(argv) / 2) {
-        argv[j * 2] = fields_[i].ToString(env());
-        argv[j * 2 + 1] = values_[i].ToString(env());
+        argv[j * 2] = fields_[i].ToInternedString(env());
+        argv[j * 2 + 1] = values_[i].ToInternedString(env());
         i++;
         j++;
       }
@@ -631,7 +870,7 @@ class Parser : public AsyncWrap, public StreamListener {
   }
 
 
-  // spill headers and request path to JS land
+  // spill trailing headers to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
 
@@ -654,7 +893,6 @@ class Parser : public AsyncWrap, public StreamListener {
       got_exception_ = true;
 
     url_.Reset();
-    have_flushed_ = true;
   }
 
 
@@ -662,21 +900,23 @@ class Parser : public AsyncWrap, public StreamListener {
     http_parser_init(&parser_, type);
     url_.Reset();
     status_message_.Reset();
+    arena_.Reset();
     num_fields_ = 0;
     num_values_ = 0;
-    have_flushed_ = false;
     got_exception_ = false;
   }
 
 
   http_parser parser_;
-  StringPtr fields_[32];  // header fields
-  StringPtr values_[32];  // header values
+  // Header fields and values of the current message. These only grow, so the
+  // storage is reused by the following messages.
+  std::vector<StringPtr> fields_;
+  std::vector<StringPtr> values_;
   StringPtr url_;
   StringPtr status_message_;
+  StringArena arena_;
   size_t num_fields_;
   size_t num_values_;
-  bool have_flushed_;
   bool got_exception_;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
@@ -753,7 +993,7 @@ void InitHttpParser(Local<Object> target,
   env->SetProtoMethod(t, "pause", Parser::Pause<true>);
   env->SetProtoMethod(t, "resume", Parser::Pause<false>);
   env->SetProtoMethod(t, "consume", Parser::Consume);
-  env->SetProtoMethod(t, "unconsume", Parser::UncoSetProtoMethodnsume);
+  env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
   env->SetProtoMethod(t, "getCurrentBuffer", Parser::GetCurrentBuffer);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
@@ -0,0 +1,262 @@
+#include "node.h"
+#include "node_internals.h"
+#include "env-inl.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>  // memchr(), memcpy(), strlen()
+#include <algorithm>
+
+// Serialization of the header block of outgoing HTTP/1 messages.
+//
+// lib/_http_outgoing.js used to build the header block by concatenating a
+// string per field and running the validation and escaping regular
+// expressions on every name and value. SerializeHeaders() does all of that in
+// one pass over a flat array of fields and produces a flat one-byte string,
+// which StreamBase::Writev() later copies into the WriteWrap storage with a
+// single memcpy().
+
+namespace node {
+namespace {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::NewStringType;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+typedef MaybeStackBuffer<char, 4096> HeaderBuffer;
+
+// Field names that _storeHeader() needs to look at, see RE_FIELDS in
+// lib/_http_outgoing.js.
+const char* const kMatchedFields[] = {
+  "connection",
+  "transfer-encoding",
+  "content-length",
+  "date",
+  "expect",
+  "trailer",
+  "upgrade"
+};
+
+
+// Same as tokenRegExp in lib/_http_common.js.
+inline bool IsTokenChar(unsigned char c) {
+  if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+      (c >= '0' && c <= '9')) {
+    return true;
+  }
+  switch (c) {
+    case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+    case '+': case '-': case '.': case '^': case '_': case '`': case '|':
+    case '~':
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+// Same as validHdrChars in lib/_http_common.js.
+inline bool IsHeaderValueChar(unsigned char c) {
+  return c == '\t' || (c >= 32 && c != 127);
+}
+
+
+bool IsToken(const char* data, size_t length) {
+  if (length == 0)
+    return false;
+  for (size_t i = 0; i < length; i++) {
+    if (!IsTokenChar(data[i]))
+      return false;
+  }
+  return true;
+}
+
+
+bool IsHeaderValue(const char* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (!IsHeaderValueChar(data[i]))
+      return false;
+  }
+  return true;
+}
+
+
+bool IsMatchedField(const char* name, size_t length) {
+  for (const char* field : kMatchedFields) {
+    if (strlen(field) == length && StringEqualNoCaseN(name, field, length))
+      return true;
+  }
+  return false;
+}
+
+
+// Removes CR and LF, along with any spaces and tabs that follow them, to
+// protect against response splitting. Same as escapeHeaderValue() in
+// lib/_http_outgoing.js. Returns the new length.
+size_t EscapeHeaderValue(char* data, size_t length) {
+  if (memchr(data, '\r', length) == nullptr &&
+      memchr(data, '\n', length) == nullptr) {
+    return length;
+  }
+
+  size_t out = 0;
+  size_t i = 0;
+  while (i < length) {
+    if (data[i] != '\r' && data[i] != '\n') {
+      data[out++] = data[i++];
+      continue;
+    }
+    while (i < length && (data[i] == '\r' || data[i] == '\n'))
+      i++;
+    while (i < length && (data[i] == ' ' || data[i] == '\t'))
+      i++;
+  }
+  return out;
+}
+
+
+// Makes room for `size` bytes. The first `used` bytes are kept, which
+// AllocateSufficientStorage() only does for the buffer's length().
+void EnsureCapacity(HeaderBuffer* buf, size_t used, size_t size) {
+  if (size > buf->capacity()) {
+    buf->SetLength(used);
+    buf->AllocateSufficientStorage(std::max(size, 2 * buf->capacity()));
+  }
+}
+
+
+void Append(HeaderBuffer* buf, size_t* pos, const char* data, size_t length) {
+  EnsureCapacity(buf, *pos, *pos + length);
+  memcpy(buf->out() + *pos, data, length);
+  *pos += length;
+}
+
+
+// Appends `string` as Latin-1 like StringBytes::Write() does for 'latin1'.
+// Returns false if any of the characters was outside of the Latin-1 range and
+// had to be truncated.
+bool AppendLatin1(HeaderBuffer* buf, size_t* pos, Local<String> string) {
+  const size_t length = string->Length();
+  EnsureCapacity(buf, *pos, *pos + length);
+  char* dst = buf->out() + *pos;
+  *pos += length;
+
+  if (string->IsOneByte()) {
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(dst),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    return true;
+  }
+
+  MaybeStackBuffer<uint16_t> wide(length);
+  string->Write(*wide, 0, length, String::NO_NULL_TERMINATION);
+  bool latin1 = true;
+  for (size_t i = 0; i < length; i++) {
+    if (wide[i] > 0xff)
+      latin1 = false;
+    dst[i] = static_cast<char>(wide[i] & 0xff);
+  }
+  return latin1;
+}
+
+
+// serializeHeaders(firstLine, fields, validate, matched)
+//
+// `fields` is a flat [name, value, name, value, ...] array. Returns the header
+// block without the terminating empty line. The indices of fields whose names
+// match RE_FIELDS are appended to `matched`. If `validate` is true and a field
+// fails the checks of validateHeader(), its index is returned instead so that
+// JS can throw the appropriate error.
+void SerializeHeaders(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+  CHECK(args[3]->IsArray());
+
+  Local<Array> fields = args[1].As<Array>();
+  const bool validate = args[2]->IsTrue();
+  Local<Array> matched = args[3].As<Array>();
+  uint32_t matched_count = 0;
+
+  HeaderBuffer buf;
+  size_t pos = 0;
+  AppendLatin1(&buf, &pos, args[0].As<String>());
+
+  const uint32_t length = fields->Length();
+  for (uint32_t i = 0; i + 1 < length; i += 2) {
+    Local<Value> name_value;
+    Local<Value> value_value;
+    if (!fields->Get(context, i).ToLocal(&name_value) ||
+        !fields->Get(context, i + 1).ToLocal(&value_value)) {
+      return;
+    }
+
+    if (validate && (!name_value->IsString() || value_value->IsUndefined()))
+      return args.GetReturnValue().Set(i);
+
+    Local<String> name;
+    Local<String> value;
+    if (!name_value->ToString(context).ToLocal(&name) ||
+        !value_value->ToString(context).ToLocal(&value)) {
+      return;
+    }
+
+    const size_t name_start = pos;
+    bool latin1 = AppendLatin1(&buf, &pos, name);
+    const char* name_data = buf.out() + name_start;
+    const size_t name_length = pos - name_start;
+    if (validate && (!latin1 || !IsToken(name_data, name_length)))
+      return args.GetReturnValue().Set(i);
+
+    if (IsMatchedField(name_data, name_length)) {
+      Local<Integer> index = Integer::NewFromUnsigned(isolate, i);
+      if (matched->Set(context, matched_count++, index).IsNothing())
+        return;
+    }
+
+    Append(&buf, &pos, ": ", 2);
+
+    const size_t value_start = pos;
+    latin1 = AppendLatin1(&buf, &pos, value);
+    char* value_data = buf.out() + value_start;
+    if (validate && (!latin1 || !IsHeaderValue(value_data, pos - value_start)))
+      return args.GetReturnValue().Set(i);
+    pos = value_start + EscapeHeaderValue(value_data, pos - value_start);
+
+    Append(&buf, &pos, "\r\n", 2);
+  }
+
+  Local<String> result;
+  if (!String::NewFromOneByte(isolate,
+                              reinterpret_cast<const uint8_t*>(buf.out()),
+                              NewStringType::kNormal,
+                              pos).ToLocal(&result)) {
+    return;
+  }
+  args.GetReturnValue().Set(result);
+}
+
+
+void InitHttpSerializer(Local<Object> target,
+                        Local<Value> unused,
+                        Local<Context> context,
+                        void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "serializeHeaders", SerializeHeaders);
+}
+
+}  // anonymous namespace
+}  // namespace node
+
+NODE_BUILTIN_MODULE_CONTEXT_AWARE(http_serializer, node::InitHttpSerializer)
@@ -102,6 +102,7 @@ struct sockaddr;
     V(async_wrap)                                                             \
     V(buffer)                                                                 \
     V(cares_wrap)                                                             \
+    V(code_cache)                                                             \
     V(config)                                                                 \
     V(contextify)                                                             \
     V(domain)                                                                 \
@@ -109,6 +110,7 @@ struct sockaddr;
     V(fs_event_wrap)                                                          \
     V(http2)                                                                  \
     V(http_parser)                                                            \
+    V(http_serializer)                                                        \
     V(inspector)                                                              \
     V(js_stream)                                                              \
     V(module_wrap)                                                            \
@@ -193,6 +195,11 @@ extern bool config_expose_internals;
 // it to stderr.
 extern std::string config_warning_file;  // NOLINT(runtime/string)
 
+// Set in node.cc by ParseArgs when --compile-cache-dir= is used.
+// The directory in which lib/module.js keeps the V8 code cache of the
+// modules it compiles, see src/compile_cache.h.
+extern std::string config_compile_cache_dir;  // NOLINT(runtime/string)
+
 // Set in node.cc by ParseArgs when --pending-deprecation or
 // NODE_PENDING_DEPRECATION is used
 extern bool config_pending_deprecation;
@@ -29,7 +29,16 @@
 namespace node {
 
 void DefineJavaScript(Environment* env, v8::Local<v8::Object> target);
+void DefineJavaScript(v8::Isolate* isolate,
+                      v8::Local<v8::Context> context,
+                      v8::Local<v8::Object> target);
 v8::Local<v8::String> MainSource(Environment* env);
+v8::Local<v8::String> MainSource(v8::Isolate* isolate);
+
+// Wraps the source of a built-in module like NativeModule.wrap() in
+// lib/internal/bootstrap_node.js, which is what gets compiled.
+v8::Local<v8::String> WrapNativeSource(v8::Isolate* isolate,
+                                       v8::Local<v8::String> source);
 
 }  // namespace node
 
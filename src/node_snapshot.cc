@@ -0,0 +1,167 @@
+#include "node_snapshot.h"
+#include "env-inl.h"
+#include "node_internals.h"
+#include "node_javascript.h"
+#include "util-inl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace node {
+namespace snapshot {
+
+using v8::Array;
+using v8::Context;
+using v8::Function;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Message;
+using v8::Null;
+using v8::Object;
+using v8::Script;
+using v8::ScriptOrigin;
+using v8::SnapshotCreator;
+using v8::StartupData;
+using v8::String;
+using v8::TryCatch;
+using v8::Undefined;
+using v8::Value;
+
+// The slot of the main context's embedder data that holds the compiled
+// functions until NewContext() takes them out again.
+static const int kContextSnapshotDataIndex =
+    Environment::kContextEmbedderDataIndex + 1;
+
+enum SnapshotDataFields {
+  kSnapshotBootstrap,
+  kSnapshotNatives,
+  kSnapshotDataFieldsCount
+};
+
+
+// Entries of process.binding('natives') that are not compiled into the
+// snapshot: the configuration, which is not a script, and the dependencies
+// that only the debugger and the profiler use.
+static bool SkipNative(const char* id) {
+  return strcmp(id, "config") == 0 ||
+         strncmp(id, "internal/deps/", 14) == 0 ||
+         strncmp(id, "node-inspect/", 13) == 0 ||
+         strncmp(id, "v8/", 3) == 0;
+}
+
+
+static MaybeLocal<Value> CompileFunction(Local<Context> context,
+                                         Local<String> source,
+                                         const char* filename) {
+  Isolate* isolate = context->GetIsolate();
+  TryCatch try_catch(isolate);
+  ScriptOrigin origin(OneByteString(isolate, filename));
+  Local<Script> script;
+  Local<Value> result;
+  if (!Script::Compile(context, source, &origin).ToLocal(&script) ||
+      !script->Run(context).ToLocal(&result)) {
+    Local<Message> message = try_catch.Message();
+    node::Utf8Value exception(isolate, try_catch.Exception());
+    fprintf(stderr, "%s:%d: %s\n", filename,
+            message.IsEmpty() ? 0 : message->GetLineNumber(context).FromJust(),
+            *exception);
+    return MaybeLocal<Value>();
+  }
+  if (!result->IsFunction()) {
+    fprintf(stderr, "%s: does not evaluate to a function\n", filename);
+    return MaybeLocal<Value>();
+  }
+  return result;
+}
+
+
+static bool CompileNatives(Local<Context> context, Local<Array> data) {
+  Isolate* isolate = context->GetIsolate();
+
+  Local<Value> bootstrap;
+  if (!CompileFunction(context, MainSource(isolate),
+                       "bootstrap_node.js").ToLocal(&bootstrap)) {
+    return false;
+  }
+
+  Local<Object> sources = Object::New(isolate);
+  DefineJavaScript(isolate, context, sources);
+  Local<Array> ids = sources->GetOwnPropertyNames(context).ToLocalChecked();
+
+  Local<Object> natives = Object::New(isolate);
+  CHECK(natives->SetPrototype(context, Null(isolate)).FromJust());
+  for (uint32_t i = 0; i < ids->Length(); i++) {
+    Local<Value> id = ids->Get(context, i).ToLocalChecked();
+    node::Utf8Value id_value(isolate, id);
+    if (SkipNative(*id_value))
+      continue;
+
+    Local<String> source = WrapNativeSource(
+        isolate, sources->Get(context, id).ToLocalChecked().As<String>());
+    std::string filename = std::string(*id_value) + ".js";
+    Local<Value> fn;
+    if (!CompileFunction(context, source, filename.c_str()).ToLocal(&fn))
+      return false;
+    CHECK(natives->Set(context, id, fn).FromJust());
+  }
+
+  CHECK(data->Set(context, kSnapshotBootstrap, bootstrap).FromJust());
+  CHECK(data->Set(context, kSnapshotNatives, natives).FromJust());
+  return true;
+}
+
+
+MaybeLocal<Context> NewContext(Isolate* isolate,
+                               Local<Function>* bootstrap,
+                               Local<Object>* natives) {
+  Local<Context> context;
+  if (!Context::FromSnapshot(isolate, kNodeContextIndex).ToLocal(&context))
+    return MaybeLocal<Context>();
+
+  Local<Value> data_value = context->GetEmbedderData(kContextSnapshotDataIndex);
+  CHECK(data_value->IsArray());
+  Local<Array> data = data_value.As<Array>();
+  Local<Value> bootstrap_value =
+      data->Get(context, kSnapshotBootstrap).ToLocalChecked();
+  Local<Value> natives_value =
+      data->Get(context, kSnapshotNatives).ToLocalChecked();
+  CHECK(bootstrap_value->IsFunction());
+  CHECK(natives_value->IsObject());
+  *bootstrap = bootstrap_value.As<Function>();
+  *natives = natives_value.As<Object>();
+
+  // Once handed out, the functions are only referenced by the code that
+  // runs them.
+  context->SetEmbedderData(kContextSnapshotDataIndex, Undefined(isolate));
+  return context;
+}
+
+
+StartupData CreateBlob() {
+  SnapshotCreator creator;
+  Isolate* isolate = creator.GetIsolate();
+  {
+    HandleScope handle_scope(isolate);
+
+    // Contexts that are created with Context::New(), such as the ones of
+    // the vm module, are deserialized from the default context. Keep that
+    // one the same as in V8's own snapshot.
+    creator.SetDefaultContext(Context::New(isolate));
+
+    Local<Context> context = node::NewContext(isolate);
+    Context::Scope context_scope(context);
+    Local<Array> data = Array::New(isolate, kSnapshotDataFieldsCount);
+    if (!CompileNatives(context, data))
+      return StartupData { nullptr, 0 };
+    context->SetEmbedderData(kContextSnapshotDataIndex, data);
+    CHECK_EQ(creator.AddContext(context), kNodeContextIndex);
+  }
+  // Keep the bytecode: V8 compiles the wrapper functions eagerly because
+  // they are parenthesized, and avoiding that work is the point.
+  return creator.CreateBlob(SnapshotCreator::FunctionCodeHandling::kKeep);
+}
+
+}  // namespace snapshot
+}  // namespace node
@@ -0,0 +1,47 @@
+#ifndef SRC_NODE_SNAPSHOT_H_
+#define SRC_NODE_SNAPSHOT_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "v8.h"
+
+namespace node {
+namespace snapshot {
+
+// The V8 startup snapshot that tools/snapshot/node_mksnapshot.cc creates at
+// build time.
+//
+// Besides the heap that V8 puts into its own snapshot, it contains a context
+// in which lib/internal/bootstrap_node.js and the built-in modules from
+// lib/*.js have already been compiled. The main context of a process is
+// deserialized from it, so that startup does not parse and compile those
+// scripts again. Running the bootstrap is still left to LoadEnvironment():
+// it sets up the process object and the native bindings, which hold pointers
+// that can not be serialized.
+
+// Index of the main context in the snapshot.
+static const size_t kNodeContextIndex = 0;
+
+// Returns the snapshot that was built into the binary, or nullptr if there
+// is none because node was configured with --without-node-snapshot.
+// Defined in the generated node_snapshot_blob.cc or in node_snapshot_stub.cc.
+v8::StartupData* GetBlob();
+
+// Creates the main context of an isolate that was created from GetBlob().
+// `bootstrap` is set to the function that bootstrap_node.js evaluates to, and
+// `natives` to an object that maps the ids of the built-in modules to their
+// wrapper functions, see NativeModule.wrap().
+v8::MaybeLocal<v8::Context> NewContext(v8::Isolate* isolate,
+                                       v8::Local<v8::Function>* bootstrap,
+                                       v8::Local<v8::Object>* natives);
+
+// Creates the snapshot. The caller owns the returned data, which is empty if
+// anything failed.
+v8::StartupData CreateBlob();
+
+}  // namespace snapshot
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SNAPSHOT_H_
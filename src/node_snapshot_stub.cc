@@ -0,0 +1,14 @@
+// Used instead of the generated node_snapshot_blob.cc when node is built
+// without a startup snapshot, and by node_mksnapshot itself.
+
+#include "node_snapshot.h"
+
+namespace node {
+namespace snapshot {
+
+v8::StartupData* GetBlob() {
+  return nullptr;
+}
+
+}  // namespace snapshot
+}  // namespace node
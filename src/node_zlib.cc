@@ -34,20 +34,28 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <deque>
+#include <vector>
+
 namespace node {
 
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::Context;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Number;
 using v8::Object;
 using v8::Persistent;
 using v8::String;
+using v8::Uint32;
 using v8::Uint32Array;
 using v8::Value;
 
@@ -67,6 +75,15 @@ enum node_zlib_mode {
 #define GZIP_HEADER_ID1 0x1f
 #define GZIP_HEADER_ID2 0x8b
 
+// Fields of Environment::zlib_write_stats().
+enum ZlibWriteStatsFields {
+  kZlibInlineWrites,
+  kZlibInlineBytes,
+  kZlibOffloadedWrites,
+  kZlibOffloadedBytes,
+  kZlibWriteStatsFieldsCount
+};
+
 /**
  * Deflate/Inflate
  */
@@ -109,18 +126,23 @@ class ZCtx : public AsyncWrap {
     CHECK(init_done_ && "close before init");
     CHECK_LE(mode_, UNZIP);
 
-    int status = Z_OK;
     if (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) {
-      status = deflateEnd(&strm_);
       int64_t change_in_bytes = -static_cast<int64_t>(kDeflateContextSize);
       env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
     } else if (mode_ == INFLATE || mode_ == GUNZIP || mode_ == INFLATERAW ||
                mode_ == UNZIP) {
-      status = inflateEnd(&strm_);
       int64_t change_in_bytes = -static_cast<int64_t>(kInflateContextSize);
       env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
     }
-    CHECK(status == Z_OK || status == Z_DATA_ERROR);
+    if (strm_ != nullptr) {
+      // Streams whose parameters were changed with params() no longer match
+      // their key.
+      if (reusable_)
+        env()->zlib_context_pool()->Release(pool_key_, strm_);
+      else
+        ZlibContextPool::End(pool_key_, strm_);
+      strm_ = nullptr;
+    }
     mode_ = NONE;
 
     if (dictionary_ != nullptr) {
@@ -138,6 +160,9 @@ class ZCtx : public AsyncWrap {
 
 
   // write(flush, in, in_off, in_len, out, out_off, out_len)
+  // The async version returns true if the input was small enough to be
+  // processed right away, in that case the results are ready and the write
+  // callback is not called.
   template <bool async>
   static void Write(const FunctionCallbackInfo<Value>& args) {
     CHECK_EQ(args.Length(), 7);
@@ -196,10 +221,10 @@ class ZCtx : public AsyncWrap {
     // build up the work request
     uv_work_t* work_req = &(ctx->work_req_);
 
-    ctx->strm_.avail_in = in_len;
-    ctx->strm_.next_in = in;
-    ctx->strm_.avail_out = out_len;
-    ctx->strm_.next_out = out;
+    ctx->strm_->avail_in = in_len;
+    ctx->strm_->next_in = in;
+    ctx->strm_->avail_out = out_len;
+    ctx->strm_->next_out = out;
     ctx->flush_ = flush;
 
     if (!async) {
@@ -207,8 +232,8 @@ class ZCtx : public AsyncWrap {
       env->PrintSyncTrace();
       Process(work_req);
       if (CheckError(ctx)) {
-        ctx->write_result_[0] = ctx->strm_.avail_out;
-        ctx->write_result_[1] = ctx->strm_.avail_in;
+        ctx->write_result_[0] = ctx->strm_->avail_out;
+        ctx->write_result_[1] = ctx->strm_->avail_in;
         ctx->write_in_progress_ = false;
         ctx->Unref();
       }
@@ -216,7 +241,28 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(env->event_loop(), work_req, ZCtx::Process, ZCtx::After);
+    AliasedBuffer<double, Float64Array>* stats = env->zlib_write_stats();
+
+    // For small inputs, the round trip through the threadpool costs more
+    // than the compression itself.
+    if (in_len < ctx->inline_threshold_) {
+      (*stats)[kZlibInlineWrites] = (*stats)[kZlibInlineWrites] + 1;
+      (*stats)[kZlibInlineBytes] = (*stats)[kZlibInlineBytes] + in_len;
+      Process(work_req);
+      if (CheckError(ctx)) {
+        ctx->write_result_[0] = ctx->strm_->avail_out;
+        ctx->write_result_[1] = ctx->strm_->avail_in;
+        ctx->write_in_progress_ = false;
+        ctx->Unref();
+        args.GetReturnValue().Set(true);
+      }
+      return;
+    }
+
+    (*stats)[kZlibOffloadedWrites] = (*stats)[kZlibOffloadedWrites] + 1;
+    (*stats)[kZlibOffloadedBytes] = (*stats)[kZlibOffloadedBytes] + in_len;
+    uv_queue_work_kind(env->event_loop(), work_req, UV_WORK_CPU,
+                       ZCtx::Process, ZCtx::After);
   }
 
 
@@ -236,11 +282,11 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        ctx->err_ = deflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = deflate(ctx->strm_, ctx->flush_);
         break;
       case UNZIP:
-        if (ctx->strm_.avail_in > 0) {
-          next_expected_header_byte = ctx->strm_.next_in;
+        if (ctx->strm_->avail_in > 0) {
+          next_expected_header_byte = ctx->strm_->next_in;
         }
 
         switch (ctx->gzip_id_bytes_read_) {
@@ -253,7 +299,7 @@ class ZCtx : public AsyncWrap {
               ctx->gzip_id_bytes_read_ = 1;
               next_expected_header_byte++;
 
-              if (ctx->strm_.avail_in == 1) {
+              if (ctx->strm_->avail_in == 1) {
                 // The only available byte was already read.
                 break;
               }
@@ -286,7 +332,7 @@ class ZCtx : public AsyncWrap {
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
-        ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = inflate(ctx->strm_, ctx->flush_);
 
         // If data was encoded with dictionary (INFLATERAW will have it set in
         // SetDictionary, don't repeat that here)
@@ -294,12 +340,12 @@ class ZCtx : public AsyncWrap {
             ctx->err_ == Z_NEED_DICT &&
             ctx->dictionary_ != nullptr) {
           // Load it
-          ctx->err_ = inflateSetDictionary(&ctx->strm_,
+          ctx->err_ = inflateSetDictionary(ctx->strm_,
                                            ctx->dictionary_,
                                            ctx->dictionary_len_);
           if (ctx->err_ == Z_OK) {
             // And try to decode again
-            ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+            ctx->err_ = inflate(ctx->strm_, ctx->flush_);
           } else if (ctx->err_ == Z_DATA_ERROR) {
             // Both inflateSetDictionary() and inflate() return Z_DATA_ERROR.
             // Make it possible for After() to tell a bad dictionary from bad
@@ -308,17 +354,17 @@ class ZCtx : public AsyncWrap {
           }
         }
 
-        while (ctx->strm_.avail_in > 0 &&
+        while (ctx->strm_->avail_in > 0 &&
                ctx->mode_ == GUNZIP &&
                ctx->err_ == Z_STREAM_END &&
-               ctx->strm_.next_in[0] != 0x00) {
+               ctx->strm_->next_in[0] != 0x00) {
           // Bytes remain in input buffer. Perhaps this is another compressed
           // member in the same archive, or just trailing garbage.
           // Trailing zero bytes are okay, though, since they are frequently
           // used for padding.
 
           Reset(ctx);
-          ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+          ctx->err_ = inflate(ctx->strm_, ctx->flush_);
         }
         break;
       default:
@@ -338,7 +384,7 @@ class ZCtx : public AsyncWrap {
     switch (ctx->err_) {
     case Z_OK:
     case Z_BUF_ERROR:
-      if (ctx->strm_.avail_out != 0 && ctx->flush_ == Z_FINISH) {
+      if (ctx->strm_->avail_out != 0 && ctx->flush_ == Z_FINISH) {
         ZCtx::Error(ctx, "unexpected end of file");
         return false;
       }
@@ -367,6 +413,7 @@ class ZCtx : public AsyncWrap {
 
     ZCtx* ctx = ContainerOf(&ZCtx::work_req_, work_req);
     Environment* env = ctx->env();
+    env->threadpool_stats()->Record(THREADPOOL_JOB_ZLIB, work_req);
 
     HandleScope handle_scope(env->isolate());
     Context::Scope context_scope(env->context());
@@ -374,8 +421,8 @@ class ZCtx : public AsyncWrap {
     if (!CheckError(ctx))
       return;
 
-    ctx->write_result_[0] = ctx->strm_.avail_out;
-    ctx->write_result_[1] = ctx->strm_.avail_in;
+    ctx->write_result_[0] = ctx->strm_->avail_out;
+    ctx->write_result_[1] = ctx->strm_->avail_in;
     ctx->write_in_progress_ = false;
 
     // call the write() cb
@@ -394,8 +441,8 @@ class ZCtx : public AsyncWrap {
     // If you hit this assertion, you forgot to enter the v8::Context first.
     CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
 
-    if (ctx->strm_.msg != nullptr) {
-      message = ctx->strm_.msg;
+    if (ctx->strm_->msg != nullptr) {
+      message = ctx->strm_->msg;
     }
 
     HandleScope scope(env->isolate());
@@ -492,6 +539,14 @@ class ZCtx : public AsyncWrap {
     Params(ctx, args[0]->Int32Value(), args[1]->Int32Value());
   }
 
+  // Inputs shorter than `threshold` bytes are processed on the loop thread.
+  static void SetInlineThreshold(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args[0]->IsUint32());
+    ZCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->inline_threshold_ = args[0].As<Uint32>()->Value();
+  }
+
   static void Reset(const FunctionCallbackInfo<Value> &args) {
     ZCtx* ctx;
     ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
@@ -508,10 +563,6 @@ class ZCtx : public AsyncWrap {
     ctx->memLevel_ = memLevel;
     ctx->strategy_ = strategy;
 
-    ctx->strm_.zalloc = Z_NULL;
-    ctx->strm_.zfree = Z_NULL;
-    ctx->strm_.opaque = Z_NULL;
-
     ctx->flush_ = Z_NO_FLUSH;
 
     ctx->err_ = Z_OK;
@@ -528,16 +579,38 @@ class ZCtx : public AsyncWrap {
       ctx->windowBits_ *= -1;
     }
 
+    const bool deflate =
+        ctx->mode_ == DEFLATE || ctx->mode_ == GZIP || ctx->mode_ == DEFLATERAW;
+    ZlibContextPool::Key& key = ctx->pool_key_;
+    key.deflate = deflate;
+    key.mode = ctx->mode_;
+    key.window_bits = ctx->windowBits_;
+    // The other parameters only matter for compression.
+    key.level = deflate ? ctx->level_ : 0;
+    key.mem_level = deflate ? ctx->memLevel_ : 0;
+    key.strategy = deflate ? ctx->strategy_ : 0;
+
+    ctx->strm_ = ctx->env()->zlib_context_pool()->Take(key);
+    const bool reused = ctx->strm_ != nullptr;
+    if (!reused) {
+      ctx->strm_ = new z_stream();
+      ctx->strm_->zalloc = Z_NULL;
+      ctx->strm_->zfree = Z_NULL;
+      ctx->strm_->opaque = Z_NULL;
+    }
+
     switch (ctx->mode_) {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        ctx->err_ = deflateInit2(&ctx->strm_,
-                                 ctx->level_,
-                                 Z_DEFLATED,
-                                 ctx->windowBits_,
-                                 ctx->memLevel_,
-                                 ctx->strategy_);
+        if (!reused) {
+          ctx->err_ = deflateInit2(ctx->strm_,
+                                   ctx->level_,
+                                   Z_DEFLATED,
+                                   ctx->windowBits_,
+                                   ctx->memLevel_,
+                                   ctx->strategy_);
+        }
         ctx->env()->isolate()
             ->AdjustAmountOfExternalAllocatedMemory(kDeflateContextSize);
         break;
@@ -545,7 +618,8 @@ class ZCtx : public AsyncWrap {
       case GUNZIP:
       case INFLATERAW:
       case UNZIP:
-        ctx->err_ = inflateInit2(&ctx->strm_, ctx->windowBits_);
+        if (!reused)
+          ctx->err_ = inflateInit2(ctx->strm_, ctx->windowBits_);
         ctx->env()->isolate()
             ->AdjustAmountOfExternalAllocatedMemory(kInflateContextSize);
         break;
@@ -564,6 +638,8 @@ class ZCtx : public AsyncWrap {
         delete[] dictionary;
         ctx->dictionary_ = nullptr;
       }
+      delete ctx->strm_;
+      ctx->strm_ = nullptr;
       ctx->mode_ = NONE;
       return false;
     }
@@ -582,14 +658,14 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateSetDictionary(&ctx->strm_,
+        ctx->err_ = deflateSetDictionary(ctx->strm_,
                                          ctx->dictionary_,
                                          ctx->dictionary_len_);
         break;
       case INFLATERAW:
         // The other inflate cases will have the dictionary set when inflate()
         // returns Z_NEED_DICT in Process()
-        ctx->err_ = inflateSetDictionary(&ctx->strm_,
+        ctx->err_ = inflateSetDictionary(ctx->strm_,
                                          ctx->dictionary_,
                                          ctx->dictionary_len_);
         break;
@@ -608,7 +684,8 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateParams(&ctx->strm_, level, strategy);
+        ctx->err_ = deflateParams(ctx->strm_, level, strategy);
+        ctx->reusable_ = false;
         break;
       default:
         break;
@@ -626,12 +703,12 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case DEFLATERAW:
       case GZIP:
-        ctx->err_ = deflateReset(&ctx->strm_);
+        ctx->err_ = deflateReset(ctx->strm_);
         break;
       case INFLATE:
       case INFLATERAW:
       case GUNZIP:
-        ctx->err_ = inflateReset(&ctx->strm_);
+        ctx->err_ = inflateReset(ctx->strm_);
         break;
       default:
         break;
@@ -670,18 +747,529 @@ class ZCtx : public AsyncWrap {
   int memLevel_;
   node_zlib_mode mode_;
   int strategy_;
-  z_stream strm_;
+  // Owned by the ZCtx until Close() gives it back to the context pool.
+  z_stream* strm_ = nullptr;
+  ZlibContextPool::Key pool_key_;
+  bool reusable_ = true;
   int windowBits_;
   uv_work_t work_req_;
   bool write_in_progress_;
   bool pending_close_;
   unsigned int refs_;
   unsigned int gzip_id_bytes_read_;
+  size_t inline_threshold_ = 0;
   uint32_t* write_result_;
   Persistent<Function> write_js_callback_;
 };
 
 
+// Gzip compression that spreads the work of a single stream over the
+// threadpool, in the style of pigz. The input is cut into blocks of
+// kBlockSize bytes which are deflated independently and concurrently. Every
+// block is primed with the window of input that precedes it, so the
+// compression ratio stays close to that of a single deflate stream, and ends
+// on a byte boundary through Z_SYNC_FLUSH, so the raw deflate output of the
+// blocks can be concatenated as is. The blocks are emitted in order, wrapped
+// in the gzip header and a trailer whose CRC is combined from the CRCs of the
+// blocks with crc32_combine().
+class ParallelGzip : public AsyncWrap {
+ public:
+  static const size_t kBlockSize = 128 * 1024;
+
+  ParallelGzip(Environment* env, Local<Object> wrap)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB) {
+    MakeWeak<ParallelGzip>(this);
+    Wrap(wrap, this);
+  }
+
+
+  ~ParallelGzip() override {
+    CHECK_EQ(refs_, 0);
+    Close();
+  }
+
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    new ParallelGzip(env, args.This());
+  }
+
+
+  // init(windowBits, level, memLevel, strategy, parallel, blockCallback)
+  static void Init(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 6 &&
+      "init(windowBits, level, memLevel, strategy, parallel, blockCallback)");
+
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+
+    ctx->window_bits_ = args[0]->Uint32Value();
+    CHECK((ctx->window_bits_ >= Z_MIN_WINDOWBITS &&
+           ctx->window_bits_ <= Z_MAX_WINDOWBITS) && "invalid windowBits");
+    // Same as in ZCtx::Init(), deflateInit2() turns 8 into 9 for raw streams.
+    if (ctx->window_bits_ == 8)
+      ctx->window_bits_ = 9;
+
+    ctx->level_ = args[1]->Int32Value();
+    CHECK((ctx->level_ >= Z_MIN_LEVEL && ctx->level_ <= Z_MAX_LEVEL) &&
+      "invalid compression level");
+
+    ctx->mem_level_ = args[2]->Uint32Value();
+    CHECK((ctx->mem_level_ >= Z_MIN_MEMLEVEL &&
+           ctx->mem_level_ <= Z_MAX_MEMLEVEL) && "invalid memlevel");
+
+    ctx->strategy_ = args[3]->Uint32Value();
+    CHECK((ctx->strategy_ == Z_FILTERED ||
+           ctx->strategy_ == Z_HUFFMAN_ONLY ||
+           ctx->strategy_ == Z_RLE ||
+           ctx->strategy_ == Z_FIXED ||
+           ctx->strategy_ == Z_DEFAULT_STRATEGY) && "invalid strategy");
+
+    CHECK(args[4]->IsUint32());
+    ctx->parallel_ = args[4].As<Integer>()->Value();
+    CHECK_GT(ctx->parallel_, 0);
+
+    CHECK(args[5]->IsFunction());
+    ctx->block_js_callback_.Reset(ctx->env()->isolate(),
+                                  args[5].As<Function>());
+
+    // Check the parameters once here, so that the only errors the blocks
+    // can run into later are allocation failures.
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int err = deflateInit2(&strm,
+                           ctx->level_,
+                           Z_DEFLATED,
+                           -ctx->window_bits_,
+                           ctx->mem_level_,
+                           ctx->strategy_);
+    if (err == Z_OK)
+      deflateEnd(&strm);
+
+    ctx->init_done_ = err == Z_OK;
+    args.GetReturnValue().Set(ctx->init_done_);
+  }
+
+
+  // write(in, flush)
+  // Returns the number of blocks that have been cut but not emitted yet, or
+  // nothing if an error was emitted.
+  static void Write(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 2);
+
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK(ctx->init_done_ && "write before init");
+    CHECK_EQ(false, ctx->closed_ && "already finalized");
+
+    CHECK(Buffer::HasInstance(args[0]));
+    const char* data = Buffer::Data(args[0]);
+    size_t length = Buffer::Length(args[0]);
+
+    unsigned int flush = args[1]->Uint32Value();
+    CHECK((flush == Z_NO_FLUSH ||
+           flush == Z_PARTIAL_FLUSH ||
+           flush == Z_SYNC_FLUSH ||
+           flush == Z_FULL_FLUSH ||
+           flush == Z_FINISH ||
+           flush == Z_BLOCK) && "Invalid flush value");
+
+    if (ctx->finished_) {
+      // Like deflate() after Z_STREAM_END: flushing again, e.g. end() after
+      // flush(Z_FINISH), does nothing, but there can be no more input.
+      if (length > 0)
+        return ctx->Error(Z_STREAM_ERROR);
+      args.GetReturnValue().Set(static_cast<uint32_t>(ctx->blocks_.size()));
+      return;
+    }
+
+    while (length > 0) {
+      if (ctx->current_ == nullptr)
+        ctx->current_ = new Block(ctx);
+      Block* block = ctx->current_;
+      size_t n = std::min(length, kBlockSize - block->in_len);
+      memcpy(block->in + block->in_len, data, n);
+      block->in_len += n;
+      data += n;
+      length -= n;
+      if (block->in_len == kBlockSize)
+        ctx->Cut(false);
+    }
+
+    if (flush == Z_FINISH) {
+      if (ctx->current_ == nullptr)
+        ctx->current_ = new Block(ctx);
+      ctx->Cut(true);
+      ctx->finished_ = true;
+    } else if (flush != Z_NO_FLUSH) {
+      if (ctx->current_ != nullptr && ctx->current_->in_len > 0)
+        ctx->Cut(false);
+      // Like deflate(), don't let later blocks refer back across a full
+      // flush.
+      if (flush == Z_FULL_FLUSH)
+        ctx->history_.clear();
+    }
+
+    ctx->Schedule();
+    args.GetReturnValue().Set(static_cast<uint32_t>(ctx->blocks_.size()));
+  }
+
+
+  static void Params(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 2 && "params(level, strategy)");
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    // Applies to the blocks that are cut from now on.
+    ctx->level_ = args[0]->Int32Value();
+    ctx->strategy_ = args[1]->Int32Value();
+  }
+
+
+  static void Reset(const FunctionCallbackInfo<Value>& args) {
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->Discard();
+  }
+
+
+  static void Close(const FunctionCallbackInfo<Value>& args) {
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->Close();
+  }
+
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const size_t kHeaderSize = 10;
+  static const size_t kTrailerSize = 8;
+
+  struct Block {
+    explicit Block(ParallelGzip* ctx)
+        : ctx(ctx),
+          in(node::Malloc(kBlockSize)),
+          level(ctx->level_),
+          strategy(ctx->strategy_) {}
+
+    ~Block() {
+      free(in);
+      free(out);
+    }
+
+    ParallelGzip* ctx;
+    uv_work_t work_req;
+    char* in;
+    size_t in_len = 0;
+    // The window of input that precedes the block.
+    std::vector<char> dictionary;
+    int level;
+    int strategy;
+    bool last = false;
+    bool started = false;
+    bool done = false;
+    // Set when the stream is reset or closed while the block is being
+    // compressed. After() then only frees the block.
+    bool orphaned = false;
+    // Room for the gzip header is left at the start of `out` and room for the
+    // trailer at the end, so the output can be handed to JS without copying.
+    char* out = nullptr;
+    size_t out_len = 0;
+    uLong crc = 0;
+    int err = Z_OK;
+  };
+
+
+  // Moves the current block to the queue of blocks to be compressed.
+  void Cut(bool last) {
+    Block* block = current_;
+    current_ = nullptr;
+    block->last = last;
+
+    const size_t window = static_cast<size_t>(1) << window_bits_;
+    block->dictionary = history_;
+    history_.insert(history_.end(), block->in, block->in + block->in_len);
+    if (history_.size() > window)
+      history_.erase(history_.begin(), history_.end() - window);
+
+    blocks_.push_back(block);
+  }
+
+
+  // Starts compressing queued blocks, in order, while fewer than parallel_
+  // blocks are in the threadpool.
+  void Schedule() {
+    for (Block* block : blocks_) {
+      if (running_ >= parallel_)
+        break;
+      if (block->started)
+        continue;
+      block->started = true;
+      running_++;
+      Ref();
+      uv_queue_work_kind(env()->event_loop(),
+                         &block->work_req,
+                         UV_WORK_CPU,
+                         ParallelGzip::Process,
+                         ParallelGzip::After);
+    }
+  }
+
+
+  // thread pool!
+  static void Process(uv_work_t* work_req) {
+    Block* block = ContainerOf(&Block::work_req, work_req);
+    ParallelGzip* ctx = block->ctx;
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    block->err = deflateInit2(&strm,
+                              block->level,
+                              Z_DEFLATED,
+                              -ctx->window_bits_,
+                              ctx->mem_level_,
+                              block->strategy);
+    if (block->err != Z_OK)
+      return;
+
+    if (!block->dictionary.empty()) {
+      block->err = deflateSetDictionary(
+          &strm,
+          reinterpret_cast<Bytef*>(block->dictionary.data()),
+          block->dictionary.size());
+    }
+
+    // deflateBound() assumes Z_FINISH, leave room for the empty stored block
+    // that Z_SYNC_FLUSH appends.
+    const size_t bound = deflateBound(&strm, block->in_len) + 16;
+    if (block->err == Z_OK) {
+      block->out = node::UncheckedMalloc(kHeaderSize + bound + kTrailerSize);
+      if (block->out == nullptr)
+        block->err = Z_MEM_ERROR;
+    }
+
+    if (block->err == Z_OK) {
+      strm.next_in = reinterpret_cast<Bytef*>(block->in);
+      strm.avail_in = block->in_len;
+      strm.next_out = reinterpret_cast<Bytef*>(block->out + kHeaderSize);
+      strm.avail_out = bound;
+      int err = deflate(&strm, block->last ? Z_FINISH : Z_SYNC_FLUSH);
+      if (err == (block->last ? Z_STREAM_END : Z_OK) && strm.avail_in == 0)
+        block->out_len = bound - strm.avail_out;
+      else
+        block->err = err == Z_OK ? Z_BUF_ERROR : err;
+    }
+
+    deflateEnd(&strm);
+
+    block->crc = crc32(0, reinterpret_cast<Bytef*>(block->in), block->in_len);
+    std::vector<char>().swap(block->dictionary);
+  }
+
+
+  // v8 land!
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+
+    Block* block = ContainerOf(&Block::work_req, work_req);
+    ParallelGzip* ctx = block->ctx;
+    Environment* env = ctx->env();
+    env->threadpool_stats()->Record(THREADPOOL_JOB_ZLIB, work_req);
+
+    ctx->running_--;
+    block->done = true;
+
+    if (block->orphaned) {
+      delete block;
+    } else {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      ctx->Schedule();
+      ctx->EmitCompleted();
+    }
+
+    ctx->Unref();
+  }
+
+
+  // Emits the blocks at the front of the queue that are done.
+  void EmitCompleted() {
+    Isolate* isolate = env()->isolate();
+
+    while (!blocks_.empty() && blocks_.front()->done) {
+      Block* block = blocks_.front();
+      blocks_.pop_front();
+
+      if (block->err != Z_OK) {
+        const int err = block->err;
+        delete block;
+        Error(err);
+        return;
+      }
+
+      char* data = block->out + kHeaderSize;
+      size_t length = block->out_len;
+
+      if (!header_written_) {
+        data -= kHeaderSize;
+        length += kHeaderSize;
+        WriteHeader(data);
+        header_written_ = true;
+      }
+
+      crc_ = crc32_combine(crc_, block->crc, block->in_len);
+      total_in_ += block->in_len;
+
+      if (block->last) {
+        WriteLE32(data + length, crc_);
+        WriteLE32(data + length + 4, total_in_);
+        length += kTrailerSize;
+      }
+
+      char* out = block->out;
+      block->out = nullptr;
+      delete block;
+
+      Local<Value> argv[] = {
+        Buffer::New(env(), data, length, FreeOutput, out).ToLocalChecked(),
+        Integer::NewFromUnsigned(isolate, blocks_.size())
+      };
+      Local<Function> cb = PersistentToLocal(isolate, block_js_callback_);
+      MakeCallback(cb, arraysize(argv), argv);
+
+      if (closed_)
+        return;
+    }
+  }
+
+
+  void WriteHeader(char* data) const {
+    data[0] = static_cast<char>(GZIP_HEADER_ID1);
+    data[1] = static_cast<char>(GZIP_HEADER_ID2);
+    data[2] = Z_DEFLATED;
+    data[3] = 0;  // No flags.
+    WriteLE32(data + 4, 0);  // No modification time.
+    // Extra flags, same as what deflate() writes.
+    const int level = level_ == Z_DEFAULT_COMPRESSION ? 6 : level_;
+    data[8] = level == 9 ? 2 :
+        (strategy_ >= Z_HUFFMAN_ONLY || level < 2 ? 4 : 0);
+#ifdef _WIN32
+    data[9] = 10;  // OS_CODE in deps/zlib/zutil.h
+#else
+    data[9] = 3;
+#endif
+  }
+
+
+  static void WriteLE32(char* data, uLong value) {
+    for (int i = 0; i < 4; i++)
+      data[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+
+
+  static void FreeOutput(char* data, void* hint) {
+    free(hint);
+  }
+
+
+  void Error(int err) {
+    Isolate* isolate = env()->isolate();
+    HandleScope scope(isolate);
+    Local<Value> argv[] = {
+      OneByteString(isolate, err == Z_MEM_ERROR ? "Out of memory" :
+                                                  "Zlib error"),
+      Number::New(isolate, err)
+    };
+    MakeCallback(env()->onerror_string(), arraysize(argv), argv);
+  }
+
+
+  // Drops all pending input and output and starts over with a new gzip
+  // member.
+  void Discard() {
+    for (Block* block : blocks_) {
+      if (block->started && !block->done)
+        block->orphaned = true;
+      else
+        delete block;
+    }
+    blocks_.clear();
+    delete current_;
+    current_ = nullptr;
+    history_.clear();
+    crc_ = crc32(0, Z_NULL, 0);
+    total_in_ = 0;
+    header_written_ = false;
+    finished_ = false;
+  }
+
+
+  void Close() {
+    if (closed_)
+      return;
+    Discard();
+    closed_ = true;
+  }
+
+
+  void Ref() {
+    if (++refs_ == 1) {
+      ClearWeak();
+    }
+  }
+
+
+  void Unref() {
+    CHECK_GT(refs_, 0);
+    if (--refs_ == 0) {
+      MakeWeak<ParallelGzip>(this);
+    }
+  }
+
+
+  int window_bits_ = 0;
+  int level_ = 0;
+  int mem_level_ = 0;
+  int strategy_ = 0;
+  uint32_t parallel_ = 1;
+  bool init_done_ = false;
+  bool header_written_ = false;
+  bool finished_ = false;
+  bool closed_ = false;
+  // Block that input is being appended to.
+  Block* current_ = nullptr;
+  // Blocks that have been cut, in output order.
+  std::deque<Block*> blocks_;
+  // The last 1 << window_bits_ bytes of input, used to prime the next block.
+  std::vector<char> history_;
+  uint32_t running_ = 0;
+  unsigned int refs_ = 0;
+  uLong crc_ = crc32(0, Z_NULL, 0);
+  uLong total_in_ = 0;
+  Persistent<Function> block_js_callback_;
+};
+
+
+void GetContextPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kZlibContextPoolStatsFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  env->zlib_context_pool()->GetStats(fields);
+}
+
+
+void SetContextPoolEnabled(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsBoolean());
+  env->zlib_context_pool()->set_enabled(args[0]->IsTrue());
+}
+
+
 void InitZlib(Local<Object> target,
               Local<Value> unused,
               Local<Context> context,
@@ -698,13 +1286,38 @@ void InitZlib(Local<Object> target,
   env->SetProtoMethod(z, "close", ZCtx::Close);
   env->SetProtoMethod(z, "params", ZCtx::Params);
   env->SetProtoMethod(z, "reset", ZCtx::Reset);
+  env->SetProtoMethod(z, "setInlineThreshold", ZCtx::SetInlineThreshold);
 
   Local<String> zlibString = FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib");
   z->SetClassName(zlibString);
   target->Set(zlibString, z->GetFunction());
 
+  Local<FunctionTemplate> pz = env->NewFunctionTemplate(ParallelGzip::New);
+
+  pz->InstanceTemplate()->SetInternalFieldCount(1);
+
+  AsyncWrap::AddWrapMethods(env, pz);
+  env->SetProtoMethod(pz, "write", ParallelGzip::Write);
+  env->SetProtoMethod(pz, "init", ParallelGzip::Init);
+  env->SetProtoMethod(pz, "close", ParallelGzip::Close);
+  env->SetProtoMethod(pz, "params", ParallelGzip::Params);
+  env->SetProtoMethod(pz, "reset", ParallelGzip::Reset);
+
+  Local<String> parallelGzipString =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "ParallelGzip");
+  pz->SetClassName(parallelGzipString);
+  target->Set(parallelGzipString, pz->GetFunction());
+
+  env->SetMethod(target, "getContextPoolStats", GetContextPoolStats);
+  env->SetMethod(target, "setContextPoolEnabled", SetContextPoolEnabled);
+
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ZLIB_VERSION"),
               FIXED_ONE_BYTE_STRING(env->isolate(), ZLIB_VERSION));
+
+  CHECK_EQ(env->zlib_write_stats()->GetJSArray()->Length(),
+           kZlibWriteStatsFieldsCount);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "writeStats"),
+              env->zlib_write_stats()->GetJSArray());
 }
 
 }  // anonymous namespace
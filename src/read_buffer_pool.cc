@@ -0,0 +1,197 @@
+#include "read_buffer_pool.h"
+#include "env-inl.h"
+#include "node_internals.h"
+#include "util-inl.h"
+
+#include <stdlib.h>  // free()
+
+namespace node {
+
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+
+// Keep reservations aligned so that typed array views on top of the carved
+// Buffers stay naturally aligned.
+static const size_t kReservationAlignment = 16;
+
+
+class ReadBufferPool::Slab {
+ public:
+  // Set to nullptr when the pool is destroyed while the slab is still in use.
+  ReadBufferPool* pool;
+  char* data;
+  // First byte that has not been handed out yet.
+  size_t offset = 0;
+  // Start of the most recent reservation.
+  size_t last = 0;
+  // Number of outstanding reads and Buffers pointing into the slab.
+  size_t refs = 0;
+};
+
+
+ReadBufferPool::ReadBufferPool(Isolate* isolate) : isolate_(isolate) {}
+
+
+ReadBufferPool::~ReadBufferPool() {
+  // Slabs that are still referenced are freed by the last FreeCallback().
+  for (Slab* slab : pinned_slabs_)
+    slab->pool = nullptr;
+
+  if (current_ != nullptr && current_->refs == 0)
+    free_slabs_.push_back(current_);
+
+  for (Slab* slab : free_slabs_) {
+    free(slab->data);
+    delete slab;
+  }
+}
+
+
+uv_buf_t ReadBufferPool::Allocate(size_t suggested_size, Slab** slab) {
+  *slab = nullptr;
+
+  if (!enabled_ || suggested_size > kSlabSize) {
+    misses_++;
+    return uv_buf_init(Malloc(suggested_size), suggested_size);
+  }
+
+  if (current_ == nullptr || kSlabSize - current_->offset < suggested_size) {
+    Slab* full = current_;
+    current_ = TakeSlab();
+    if (full != nullptr && full->refs == 0)
+      Recycle(full);
+  } else {
+    hits_++;
+  }
+
+  Slab* s = current_;
+  if (s->refs++ == 0)
+    pinned_slabs_.insert(s);
+  s->last = s->offset;
+  s->offset += suggested_size;
+
+  *slab = s;
+  return uv_buf_init(s->data + s->last, suggested_size);
+}
+
+
+MaybeLocal<Object> ReadBufferPool::Carve(Environment* env,
+                                         Slab* slab,
+                                         const uv_buf_t& buf,
+                                         size_t nread) {
+  CHECK_LE(nread, buf.len);
+
+  if (slab == nullptr) {
+    char* base = node::UncheckedRealloc(buf.base, nread);
+    return Buffer::New(env, base, nread);
+  }
+
+  if (nread == 0) {
+    Release(slab, buf);
+    return Buffer::New(env, static_cast<size_t>(0));
+  }
+
+  Trim(slab, buf, nread);
+
+  Local<Object> obj;
+  if (!Buffer::New(env, buf.base, nread, FreeCallback, slab).ToLocal(&obj)) {
+    Unref(slab);
+    return MaybeLocal<Object>();
+  }
+  return obj;
+}
+
+
+void ReadBufferPool::Release(Slab* slab, const uv_buf_t& buf) {
+  if (slab == nullptr) {
+    free(buf.base);
+    return;
+  }
+
+  Trim(slab, buf, 0);
+  Unref(slab);
+}
+
+
+void ReadBufferPool::GetStats(double* fields) const {
+  fields[kReadBufferPoolHits] = static_cast<double>(hits_);
+  fields[kReadBufferPoolMisses] = static_cast<double>(misses_);
+  fields[kReadBufferPoolPinnedBytes] =
+      static_cast<double>(pinned_slabs_.size() * kSlabSize);
+  fields[kReadBufferPoolFreeBytes] =
+      static_cast<double>(free_slabs_.size() * kSlabSize);
+}
+
+
+ReadBufferPool::Slab* ReadBufferPool::TakeSlab() {
+  if (!free_slabs_.empty()) {
+    hits_++;
+    Slab* slab = free_slabs_.back();
+    free_slabs_.pop_back();
+    return slab;
+  }
+
+  misses_++;
+  Slab* slab = new Slab();
+  slab->pool = this;
+  slab->data = Malloc(kSlabSize);
+  isolate_->AdjustAmountOfExternalAllocatedMemory(kSlabSize);
+  return slab;
+}
+
+
+void ReadBufferPool::Trim(Slab* slab, const uv_buf_t& buf, size_t nread) {
+  // Only the most recent reservation can give its unused tail back.
+  if (slab != current_ || buf.base != slab->data + slab->last)
+    return;
+
+  size_t end = slab->last +
+      ((nread + kReservationAlignment - 1) & ~(kReservationAlignment - 1));
+  if (end < slab->offset)
+    slab->offset = end;
+}
+
+
+void ReadBufferPool::Unref(Slab* slab) {
+  CHECK_GT(slab->refs, 0);
+  if (--slab->refs > 0)
+    return;
+
+  pinned_slabs_.erase(slab);
+  if (slab == current_)
+    slab->offset = 0;  // Nothing points into the slab anymore, start over.
+  else
+    Recycle(slab);
+}
+
+
+void ReadBufferPool::Recycle(Slab* slab) {
+  slab->offset = 0;
+  if (free_slabs_.size() < kMaxFreeSlabs) {
+    free_slabs_.push_back(slab);
+    return;
+  }
+
+  free(slab->data);
+  delete slab;
+  isolate_->AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int64_t>(kSlabSize));
+}
+
+
+void ReadBufferPool::FreeCallback(char* data, void* hint) {
+  Slab* slab = static_cast<Slab*>(hint);
+  if (slab->pool != nullptr) {
+    slab->pool->Unref(slab);
+    return;
+  }
+
+  if (--slab->refs == 0) {
+    free(slab->data);
+    delete slab;
+  }
+}
+
+}  // namespace node
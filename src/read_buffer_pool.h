@@ -0,0 +1,90 @@
+#ifndef SRC_READ_BUFFER_POOL_H_
+#define SRC_READ_BUFFER_POOL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+enum ReadBufferPoolStatsFields {
+  kReadBufferPoolHits,
+  kReadBufferPoolMisses,
+  kReadBufferPoolPinnedBytes,
+  kReadBufferPoolFreeBytes,
+  kReadBufferPoolStatsFieldsCount
+};
+
+// A per-Environment pool of read buffers for LibuvStreamWrap and UDPWrap.
+//
+// Reads are served from fixed-size slabs instead of one malloc() per read.
+// The bytes that were actually read are handed to JS as an external Buffer
+// that points into the slab, and the unused tail of the reservation is given
+// back so that the next read continues right after it. A slab is reused once
+// it is full and every Buffer carved out of it has been garbage collected,
+// which keeps the number of large allocations proportional to the amount of
+// data that JS holds on to rather than to the number of reads.
+class ReadBufferPool {
+ public:
+  static const size_t kSlabSize = 256 * 1024;
+  static const size_t kMaxFreeSlabs = 8;
+
+  class Slab;
+
+  explicit ReadBufferPool(v8::Isolate* isolate);
+  ~ReadBufferPool();
+
+  // Returns a buffer of exactly `suggested_size` bytes. `*slab` is set to the
+  // slab the buffer was carved from, or to nullptr if it was malloc()ed, and
+  // must be passed to exactly one of `Carve()` or `Release()` later on.
+  uv_buf_t Allocate(size_t suggested_size, Slab** slab);
+
+  // Wraps the first `nread` bytes of `buf` into a Buffer instance. The Buffer
+  // takes over the slab reference that was acquired by `Allocate()`.
+  v8::MaybeLocal<v8::Object> Carve(Environment* env,
+                                   Slab* slab,
+                                   const uv_buf_t& buf,
+                                   size_t nread);
+
+  // Gives back a buffer returned by `Allocate()` that did not receive data.
+  void Release(Slab* slab, const uv_buf_t& buf);
+
+  inline bool enabled() const { return enabled_; }
+  inline void set_enabled(bool value) { enabled_ = value; }
+
+  // Fills `fields` with kReadBufferPoolStatsFieldsCount entries.
+  void GetStats(double* fields) const;
+
+ private:
+  Slab* TakeSlab();
+  void Trim(Slab* slab, const uv_buf_t& buf, size_t nread);
+  void Unref(Slab* slab);
+  void Recycle(Slab* slab);
+  static void FreeCallback(char* data, void* hint);
+
+  v8::Isolate* const isolate_;
+  bool enabled_ = true;
+  Slab* current_ = nullptr;
+  std::vector<Slab*> free_slabs_;
+  // Slabs that are still referenced by a read or by a Buffer.
+  std::unordered_set<Slab*> pinned_slabs_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBufferPool);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_READ_BUFFER_POOL_H_
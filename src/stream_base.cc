@@ -489,6 +489,14 @@ uv_buf_t StreamListener::OnStreamAlloc(size_t suggested_size) {
 }
 
 
+uv_buf_t EmitToJSStreamListener::OnStreamAlloc(size_t suggested_size) {
+  CHECK_NE(stream_, nullptr);
+  CHECK_EQ(slab_, nullptr);
+  Environment* env = static_cast<StreamBase*>(stream_)->stream_env();
+  return env->read_buffer_pool()->Allocate(suggested_size, &slab_);
+}
+
+
 void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   CHECK_NE(stream_, nullptr);
   StreamBase* stream = static_cast<StreamBase*>(stream_);
@@ -496,8 +504,12 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  ReadBufferPool* pool = env->read_buffer_pool();
+  ReadBufferPool::Slab* slab = slab_;
+  slab_ = nullptr;
+
   if (nread <= 0)  {
-    free(buf.base);
+    pool->Release(slab, buf);
     if (nread < 0)
       stream->CallJSOnreadMethod(nread, Local<Object>());
     return;
@@ -505,7 +517,7 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
 
   CHECK_LE(static_cast<size_t>(nread), buf.len);
 
-  Local<Object> obj = Buffer::New(env, buf.base, nread).ToLocalChecked();
+  Local<Object> obj = pool->Carve(env, slab, buf, nread).ToLocalChecked();
   stream->CallJSOnreadMethod(nread, obj);
 }
 
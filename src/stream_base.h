@@ -176,9 +176,15 @@ class StreamListener {
 
 // A default emitter that just pushes data chunks as Buffer instances to
 // JS land via the handle’s .ondata method.
+// The chunks are carved out of the Environment’s `ReadBufferPool`.
 class EmitToJSStreamListener : public StreamListener {
  public:
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
   void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+
+ private:
+  // The slab backing the buffer returned by the last `OnStreamAlloc()` call.
+  ReadBufferPool::Slab* slab_ = nullptr;
 };
 
 
@@ -36,22 +36,52 @@
 #include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
 
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>  // fcntl()
+#include <unistd.h>  // close()
+#endif
+
 
 namespace node {
 
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::DontDelete;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Integer;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::ReadOnly;
 using v8::Signature;
 using v8::Value;
 
 
+static void GetReadBufferPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kReadBufferPoolStatsFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  env->read_buffer_pool()->GetStats(fields);
+}
+
+
+static void SetReadBufferPoolEnabled(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsBoolean());
+  env->read_buffer_pool()->set_enabled(args[0]->IsTrue());
+}
+
+
 void LibuvStreamWrap::Initialize(Local<Object> target,
                                  Local<Value> unused,
                                  Local<Context> context) {
@@ -83,6 +113,18 @@ void LibuvStreamWrap::Initialize(Local<Object> target,
   // 注册WriteWrap变量
   target->Set(writeWrapString, ww->GetFunction());
   env->set_write_wrap_constructor_function(ww->GetFunction());
+
+  Local<FunctionTemplate> sfw =
+      FunctionTemplate::New(env->isolate(), is_construct_call_callback);
+  sfw->InstanceTemplate()->SetInternalFieldCount(1);
+  Local<String> sendFileWrapString =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap");
+  sfw->SetClassName(sendFileWrapString);
+  AsyncWrap::AddWrapMethods(env, sfw);
+  target->Set(sendFileWrapString, sfw->GetFunction());
+
+  env->SetMethod(target, "getReadBufferPoolStats", GetReadBufferPoolStats);
+  env->SetMethod(target, "setReadBufferPoolEnabled", SetReadBufferPoolEnabled);
 }
 
 
@@ -115,6 +157,9 @@ void LibuvStreamWrap::AddMethods(Environment* env,
       Local<FunctionTemplate>(),
       static_cast<PropertyAttribute>(ReadOnly | DontDelete));
   env->SetProtoMethod(target, "setBlocking", SetBlocking);
+#ifndef _WIN32
+  env->SetProtoMethod(target, "sendFile", SendFile);
+#endif
   StreamBase::AddMethods<LibuvStreamWrap>(env, target, flags);
 }
 
@@ -368,6 +413,246 @@ void LibuvStreamWrap::AfterUvWrite(uv_write_t* req, int status) {
   req_wrap->Done(status);
 }
 
+
+#ifndef _WIN32
+// Copies a range of a file into the stream with sendfile(2). Each chunk is
+// sent from the threadpool through uv_fs_sendfile() on a duplicate of the
+// stream's file descriptor, so the data never passes through JS. When the
+// send buffer is full, the transfer waits with a uv_poll_t until the socket
+// is writable again instead of tying up a threadpool thread.
+class SendFileWrap : public ReqWrap<uv_fs_t> {
+ public:
+  static const size_t kChunkSize = 1024 * 1024;
+
+  SendFileWrap(Environment* env,
+               Local<Object> req_wrap_obj,
+               LibuvStreamWrap* stream,
+               int out_fd,
+               uv_file in_fd,
+               int64_t offset,
+               int64_t length);
+  ~SendFileWrap() override;
+
+  int Start();
+  // Called when the stream goes away while the transfer is in progress.
+  void Cancel();
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  void SendChunk();
+  void Finish(int status);
+
+  static void AfterSendFile(uv_fs_t* req);
+  static void OnWritable(uv_poll_t* handle, int status, int events);
+  static void OnPollClose(uv_handle_t* handle);
+
+  LibuvStreamWrap* stream_;
+  uv_poll_t poll_;
+  const int out_fd_;
+  const uv_file in_fd_;
+  int64_t offset_;
+  // Number of bytes left to send, or -1 to send up to the end of the file.
+  int64_t remaining_;
+  int64_t bytes_ = 0;
+  int status_ = 0;
+};
+
+
+SendFileWrap::SendFileWrap(Environment* env,
+                           Local<Object> req_wrap_obj,
+                           LibuvStreamWrap* stream,
+                           int out_fd,
+                           uv_file in_fd,
+                           int64_t offset,
+                           int64_t length)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_WRITEWRAP),
+      stream_(stream),
+      out_fd_(out_fd),
+      in_fd_(in_fd),
+      offset_(offset),
+      remaining_(length) {
+  Wrap(req_wrap_obj, this);
+  Dispatched();
+  stream_->send_file_ = this;
+}
+
+
+SendFileWrap::~SendFileWrap() {
+  if (stream_ != nullptr)
+    stream_->send_file_ = nullptr;
+  ClearWrap(object());
+  close(out_fd_);
+}
+
+
+int SendFileWrap::Start() {
+  int err = uv_poll_init(env()->event_loop(), &poll_, out_fd_);
+  if (err != 0)
+    return err;
+  SendChunk();
+  return 0;
+}
+
+
+void SendFileWrap::Cancel() {
+  stream_ = nullptr;
+  // If a chunk is in flight, AfterSendFile() finishes the transfer.
+  if (uv_is_active(reinterpret_cast<uv_handle_t*>(&poll_))) {
+    uv_poll_stop(&poll_);
+    Finish(UV_ECANCELED);
+  }
+}
+
+
+void SendFileWrap::SendChunk() {
+  if (stream_ == nullptr || !stream_->IsAlive() || stream_->IsClosing())
+    return Finish(UV_ECANCELED);
+
+  size_t len = kChunkSize;
+  if (remaining_ >= 0 && static_cast<uint64_t>(remaining_) < len)
+    len = static_cast<size_t>(remaining_);
+
+  int err = uv_fs_sendfile(env()->event_loop(),
+                           req(),
+                           out_fd_,
+                           in_fd_,
+                           offset_,
+                           len,
+                           AfterSendFile);
+  if (err != 0)
+    Finish(err);
+}
+
+
+void SendFileWrap::Finish(int status) {
+  if (stream_ != nullptr) {
+    stream_->send_file_ = nullptr;
+    stream_ = nullptr;
+  }
+  status_ = status;
+  uv_close(reinterpret_cast<uv_handle_t*>(&poll_), OnPollClose);
+}
+
+
+void SendFileWrap::AfterSendFile(uv_fs_t* req) {
+  SendFileWrap* wrap = static_cast<SendFileWrap*>(req->data);
+  ssize_t result = req->result;
+  uv_fs_req_cleanup(req);
+
+  if (wrap->stream_ == nullptr)
+    return wrap->Finish(UV_ECANCELED);
+
+  if (result == UV_EAGAIN) {
+    int err = uv_poll_start(&wrap->poll_, UV_WRITABLE, OnWritable);
+    if (err != 0)
+      wrap->Finish(err);
+    return;
+  }
+
+  if (result < 0)
+    return wrap->Finish(result);
+
+  // End of file. That is only an error if a fixed length was requested.
+  if (result == 0)
+    return wrap->Finish(wrap->remaining_ > 0 ? UV_EOF : 0);
+
+  if (wrap->stream_->is_tcp()) {
+    NODE_COUNT_NET_BYTES_SENT(result);
+  } else if (wrap->stream_->is_named_pipe()) {
+    NODE_COUNT_PIPE_BYTES_SENT(result);
+  }
+
+  wrap->offset_ += result;
+  wrap->bytes_ += result;
+  if (wrap->remaining_ > 0)
+    wrap->remaining_ -= result;
+
+  if (wrap->remaining_ == 0)
+    return wrap->Finish(0);
+
+  wrap->SendChunk();
+}
+
+
+void SendFileWrap::OnWritable(uv_poll_t* handle, int status, int events) {
+  SendFileWrap* wrap = ContainerOf(&SendFileWrap::poll_, handle);
+  uv_poll_stop(handle);
+  if (status < 0)
+    return wrap->Finish(status);
+  wrap->SendChunk();
+}
+
+
+void SendFileWrap::OnPollClose(uv_handle_t* handle) {
+  SendFileWrap* wrap =
+      ContainerOf(&SendFileWrap::poll_, reinterpret_cast<uv_poll_t*>(handle));
+  Environment* env = wrap->env();
+  HandleScope scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), wrap->status_),
+    Number::New(env->isolate(), static_cast<double>(wrap->bytes_))
+  };
+  wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+  delete wrap;
+}
+
+
+// args: req, fd, offset, length (-1 means up to the end of the file).
+void LibuvStreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  LibuvStreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  uv_file in_fd = args[1].As<v8::Int32>()->Value();
+  int64_t offset = args[2]->IntegerValue(env->context()).FromJust();
+  int64_t length = args[3]->IntegerValue(env->context()).FromJust();
+  CHECK_GE(offset, 0);
+  CHECK_GE(length, -1);
+
+  if (!wrap->IsAlive() || wrap->IsClosing())
+    return args.GetReturnValue().Set(UV_EBADF);
+
+  // Data that was written earlier has to go out first.
+  if (wrap->send_file_ != nullptr || wrap->stream()->write_queue_size != 0)
+    return args.GetReturnValue().Set(UV_EBUSY);
+
+  // uv_fs_sendfile() and uv_poll_t both need a descriptor of their own, the
+  // stream's descriptor is already registered with the event loop.
+  int out_fd = fcntl(wrap->GetFD(), F_DUPFD_CLOEXEC, 0);
+  if (out_fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  SendFileWrap* req_wrap = new SendFileWrap(env,
+                                            req_wrap_obj,
+                                            wrap,
+                                            out_fd,
+                                            in_fd,
+                                            offset,
+                                            length);
+  int err = req_wrap->Start();
+  if (err != 0)
+    delete req_wrap;
+  args.GetReturnValue().Set(err);
+}
+#endif  // _WIN32
+
+
+LibuvStreamWrap::~LibuvStreamWrap() {
+#ifndef _WIN32
+  if (send_file_ != nullptr)
+    send_file_->Cancel();
+#endif
+}
+
 }  // namespace node
 
 NODE_BUILTIN_MODULE_CONTEXT_AWARE(stream_wrap,
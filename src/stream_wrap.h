@@ -33,6 +33,8 @@
 
 namespace node {
 
+class SendFileWrap;
+
 class LibuvStreamWrap : public HandleWrap, public StreamBase {
  public:
   static void Initialize(v8::Local<v8::Object> target,
@@ -78,6 +80,7 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
                   v8::Local<v8::Object> object,
                   uv_stream_t* stream,
                   AsyncWrap::ProviderType provider);
+  ~LibuvStreamWrap() override;
 
   AsyncWrap* GetAsyncWrap() override;
 
@@ -89,6 +92,7 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void GetWriteQueueSize(
       const v8::FunctionCallbackInfo<v8::Value>& info);
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   void OnUvAlloc(size_t suggested_size, uv_buf_t* buf);
@@ -98,6 +102,10 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void AfterUvShutdown(uv_shutdown_t* req, int status);
 
   uv_stream_t* const stream_;
+  // The sendfile(2) transfer that currently owns the write side, if any.
+  SendFileWrap* send_file_ = nullptr;
+
+  friend class SendFileWrap;
 };
 
 
@@ -0,0 +1,77 @@
+#include "threadpool_stats.h"
+#include "util-inl.h"
+#include "tracing/trace_event.h"
+
+namespace node {
+
+ThreadpoolStats::ThreadpoolStats(v8::Isolate* isolate)
+    : fields_(isolate, kLength) {
+  for (size_t i = 0; i < kLength; i += kHistogramLength)
+    fields_[i + kThreadpoolHistogramMin] = -1;
+}
+
+
+size_t ThreadpoolStats::BucketIndex(uint64_t value) {
+  if (value < 2 * kSubBuckets)
+    return static_cast<size_t>(value);
+
+  // After the shift, `value` has exactly one bit above the sub-bucket bits.
+  size_t shift = 0;
+  while ((value >> shift) >= 2 * kSubBuckets)
+    shift++;
+  size_t index = (shift + 1) * kSubBuckets +
+                 static_cast<size_t>((value >> shift) - kSubBuckets);
+  return index < kBucketCount ? index : kBucketCount - 1;
+}
+
+
+void ThreadpoolStats::Add(ThreadpoolJobType type,
+                          ThreadpoolHistogram histogram,
+                          uint64_t value) {
+  const size_t offset =
+      (type * kThreadpoolHistogramCount + histogram) * kHistogramLength;
+  const size_t min = offset + kThreadpoolHistogramMin;
+  const size_t max = offset + kThreadpoolHistogramMax;
+  const size_t total = offset + kThreadpoolHistogramTotal;
+  const size_t sum = offset + kThreadpoolHistogramSum;
+  const size_t bucket =
+      offset + kThreadpoolHistogramBuckets + BucketIndex(value);
+  const double v = static_cast<double>(value);
+
+  if (fields_[min] < 0 || v < fields_[min])
+    fields_[min] = v;
+  if (v > fields_[max])
+    fields_[max] = v;
+  fields_[total] = fields_[total] + 1;
+  fields_[sum] = fields_[sum] + v;
+  fields_[bucket] = fields_[bucket] + 1;
+}
+
+
+void ThreadpoolStats::Record(ThreadpoolJobType type, const uv_req_t* req) {
+  uv_work_timing_t timing;
+  if (uv_req_get_work_timing(req, &timing) != 0 || timing.started_at == 0)
+    return;
+
+  uint64_t wait_time = (timing.started_at - timing.queued_at) / 1000;
+  uint64_t run_time = (timing.finished_at - timing.started_at) / 1000;
+  Add(type, kThreadpoolWaitTime, wait_time);
+  Add(type, kThreadpoolRunTime, run_time);
+  Add(type, kThreadpoolQueueDepth, timing.queue_depth);
+
+  switch (type) {
+#define V(name, label)                                                        \
+    case THREADPOOL_JOB_##name:                                               \
+      TRACE_EVENT_INSTANT2("node.threadpool", label,                         \
+                           TRACE_EVENT_SCOPE_THREAD,                          \
+                           "waitTime", wait_time, "runTime", run_time);       \
+      TRACE_COUNTER1("node.threadpool", label, timing.queue_depth);           \
+      break;
+    THREADPOOL_JOB_TYPES(V)
+#undef V
+    default:
+      UNREACHABLE();
+  }
+}
+
+}  // namespace node
@@ -0,0 +1,96 @@
+#ifndef SRC_THREADPOOL_STATS_H_
+#define SRC_THREADPOOL_STATS_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "aliased_buffer.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+#define THREADPOOL_JOB_TYPES(V)                                               \
+  V(FS, "fs")                                                                 \
+  V(ZLIB, "zlib")                                                             \
+  V(PBKDF2, "pbkdf2")                                                         \
+  V(RANDOM_BYTES, "randomBytes")                                              \
+  V(DNS, "dns")                                                               \
+  V(NAPI, "napi")                                                             \
+  V(TLS_HANDSHAKE, "tlsHandshake")
+
+enum ThreadpoolJobType {
+#define V(name, _) THREADPOOL_JOB_##name,
+  THREADPOOL_JOB_TYPES(V)
+#undef V
+  THREADPOOL_JOB_TYPE_COUNT
+};
+
+enum ThreadpoolHistogram {
+  kThreadpoolWaitTime,    // Queued until started, in microseconds.
+  kThreadpoolRunTime,     // Started until finished, in microseconds.
+  kThreadpoolQueueDepth,  // Jobs of the same uv_work_kind already waiting.
+  kThreadpoolHistogramCount
+};
+
+enum ThreadpoolHistogramFields {
+  kThreadpoolHistogramTotal,
+  kThreadpoolHistogramMin,
+  kThreadpoolHistogramMax,
+  kThreadpoolHistogramSum,
+  kThreadpoolHistogramBuckets
+};
+
+// Per-Environment histograms of the threadpool jobs that the Environment
+// started, one set per job type.
+//
+// The histograms are log-linear, like HdrHistogram: every power of two is
+// split into kSubBuckets equally wide buckets, so the relative error of a
+// bucket is at most 1 / kSubBuckets over the whole range. Values that are
+// larger than the last bucket are counted in it. Every histogram is laid out
+// as kThreadpoolHistogramBuckets fields followed by kBucketCount buckets in a
+// Float64Array that is shared with JS.
+//
+// libuv takes the timestamps on the worker threads, the histograms are only
+// updated on the loop thread, from the completion callbacks.
+class ThreadpoolStats {
+ public:
+  static const size_t kSubBuckets = 4;
+  static const size_t kBucketCount = 128;
+  static const size_t kHistogramLength =
+      kThreadpoolHistogramBuckets + kBucketCount;
+  static const size_t kLength =
+      THREADPOOL_JOB_TYPE_COUNT * kThreadpoolHistogramCount * kHistogramLength;
+
+  explicit ThreadpoolStats(v8::Isolate* isolate);
+
+  // Records a completed `uv_work_t`, `uv_fs_t`, `uv_getaddrinfo_t` or
+  // `uv_getnameinfo_t`. Requests that were cancelled are not recorded.
+  void Record(ThreadpoolJobType type, const uv_req_t* req);
+
+  template <typename T>
+  inline void Record(ThreadpoolJobType type, const T* req) {
+    Record(type, reinterpret_cast<const uv_req_t*>(req));
+  }
+
+  static size_t BucketIndex(uint64_t value);
+
+  inline AliasedBuffer<double, v8::Float64Array>* fields() { return &fields_; }
+
+ private:
+  void Add(ThreadpoolJobType type, ThreadpoolHistogram histogram,
+           uint64_t value);
+
+  AliasedBuffer<double, v8::Float64Array> fields_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadpoolStats);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_THREADPOOL_STATS_H_
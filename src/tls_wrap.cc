@@ -26,6 +26,7 @@
 #include "node_crypto_bio.h"  // NodeBIO
 // ClientHelloParser
 #include "node_crypto_clienthello-inl.h"
+#include "node_crypto_ktls.h"
 #include "node_counters.h"
 #include "node_internals.h"
 #include "stream_base-inl.h"
@@ -41,6 +42,7 @@ using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Local;
 using v8::Object;
 using v8::ReadOnly;
@@ -142,7 +144,7 @@ void TLSWrap::InitSSL() {
 
   InitNPN(sc_);
 
-  SSL_set_cert_cb(ssl_, SSLWrap<TLSWrap>::SSLCertCallback, this);
+  SSL_set_cert_cb(ssl_, CertCallback, this);
 
   if (is_server()) {
     SSL_set_accept_state(ssl_);
@@ -244,6 +246,142 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
 }
 
 
+// Wraps SSLWrap::SSLCertCallback(). With enableAsyncHandshake(), the initial
+// handshake of a server is suspended here, after the ClientHello and the JS
+// callbacks for it were processed. EncOut() then resumes it on the threadpool,
+// where OpenSSL chooses the cipher and produces the ServerHello, Certificate
+// and ServerKeyExchange, which includes the signature with the private key.
+//
+// The callbacks that OpenSSL makes in the meantime must not call into V8:
+// SSLInfoCallback() ignores the loop events, and the ALPN, NPN and OCSP
+// callbacks of SSLWrap only use data that is kept outside of the JS heap.
+// The methods that JS can call on the handle return undefined until the
+// handshake work is done.
+int TLSWrap::CertCallback(SSL* s, void* arg) {
+  TLSWrap* wrap = static_cast<TLSWrap*>(arg);
+
+  // Called again on the threadpool, let the handshake continue.
+  if (wrap->handshake_work_running_)
+    return 1;
+
+  if (wrap->handshake_work_pending_)
+    return -1;
+
+  int ret = SSLWrap<TLSWrap>::SSLCertCallback(s, arg);
+  if (ret != 1 ||
+      !wrap->async_handshake_ ||
+      !wrap->is_server() ||
+      SSL_session_reused(s) ||
+      wrap->established_ ||
+      wrap->write_size_ != 0) {
+    return ret;
+  }
+
+  wrap->handshake_work_pending_ = true;
+  return -1;
+}
+
+
+void TLSWrap::StartHandshakeWork() {
+  CHECK(handshake_work_pending_);
+  CHECK_EQ(write_size_, 0);
+  handshake_work_pending_ = false;
+  handshake_work_running_ = true;
+  async_handshake_ = false;
+
+  crypto::NodeBIO::FromBIO(enc_in_)->Detach();
+  crypto::NodeBIO::FromBIO(enc_out_)->Detach();
+
+  // The socket may be dropped by JS in the meantime.
+  ClearWeak();
+
+  CHECK_EQ(0, uv_queue_work_kind(env()->event_loop(),
+                                 &handshake_work_req_,
+                                 UV_WORK_CPU,
+                                 HandshakeWork,
+                                 AfterHandshakeWork));
+}
+
+
+void TLSWrap::HandshakeWork(uv_work_t* req) {
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_work_req_, req);
+
+  // Runs until the client has to answer, or the handshake failed.
+  int ret = SSL_do_handshake(wrap->ssl_);
+  wrap->handshake_work_err_ = SSL_get_error(wrap->ssl_, ret);
+  wrap->handshake_work_error_.clear();
+
+  if (wrap->handshake_work_err_ == SSL_ERROR_SSL ||
+      wrap->handshake_work_err_ == SSL_ERROR_SYSCALL) {
+    BIO* bio = BIO_new(BIO_s_mem());
+    ERR_print_errors(bio);
+
+    BUF_MEM* mem;
+    BIO_get_mem_ptr(bio, &mem);
+    wrap->handshake_work_error_.assign(mem->data, mem->data + mem->length);
+
+    BIO_free_all(bio);
+  }
+
+  // The error queue belongs to this thread.
+  ERR_clear_error();
+}
+
+
+void TLSWrap::AfterHandshakeWork(uv_work_t* req, int status) {
+  CHECK_EQ(status, 0);
+
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_work_req_, req);
+  Environment* env = wrap->env();
+  env->threadpool_stats()->Record(THREADPOOL_JOB_TLS_HANDSHAKE, req);
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  wrap->handshake_work_running_ = false;
+  crypto::NodeBIO::FromBIO(wrap->enc_in_)->Attach();
+  crypto::NodeBIO::FromBIO(wrap->enc_out_)->Attach();
+  wrap->MakeWeak(wrap);
+
+  ShutdownWrap* shutdown_req = wrap->shutdown_after_handshake_work_;
+  wrap->shutdown_after_handshake_work_ = nullptr;
+
+  if (wrap->destroy_after_handshake_work_) {
+    wrap->SSLWrap<TLSWrap>::DestroySSL();
+    if (shutdown_req != nullptr)
+      shutdown_req->Done(UV_ECANCELED);
+    return;
+  }
+
+  if (wrap->handshake_work_input_length_ != 0) {
+    crypto::NodeBIO::FromBIO(wrap->enc_in_)->Write(
+        wrap->handshake_work_input_.data(),
+        wrap->handshake_work_input_length_);
+  }
+  std::vector<char>().swap(wrap->handshake_work_input_);
+  wrap->handshake_work_input_length_ = 0;
+
+  if (wrap->handshake_work_err_ == SSL_ERROR_SSL ||
+      wrap->handshake_work_err_ == SSL_ERROR_SYSCALL) {
+    // Flush the alert, as ClearOut() does.
+    wrap->EncOut();
+    Local<Value> arg = Exception::Error(
+        OneByteString(env->isolate(),
+                      wrap->handshake_work_error_.data(),
+                      wrap->handshake_work_error_.size()));
+    wrap->MakeCallback(env->onerror_string(), 1, &arg);
+  } else {
+    wrap->Cycle();
+  }
+
+  if (shutdown_req != nullptr) {
+    int err = wrap->DoShutdown(shutdown_req);
+    if (err != 0)
+      shutdown_req->Done(err);
+  }
+}
+
+
 void TLSWrap::EncOut() {
   // Ignore cycling data if ClientHello wasn't yet parsed
   if (!hello_parser_.IsEnded())
@@ -264,6 +402,26 @@ void TLSWrap::EncOut() {
   if (ssl_ == nullptr)
     return;
 
+  if (handshake_work_running_)
+    return;
+
+  if (handshake_work_pending_) {
+    StartHandshakeWork();
+    return;
+  }
+
+  if (kernel_tls_ && BIO_pending(enc_out_) != 0) {
+    // The kernel would encrypt OpenSSL's records once more. Alerts are
+    // dropped, a renegotiation cannot continue.
+    crypto::NodeBIO::FromBIO(enc_out_)->Reset();
+    if (SSL_in_init(ssl_)) {
+      Local<Value> arg = Exception::Error(FIXED_ONE_BYTE_STRING(
+          env()->isolate(), "TLS renegotiation is not supported with kTLS"));
+      MakeCallback(env()->onerror_string(), 1, &arg);
+      return;
+    }
+  }
+
   // No data to write
   if (BIO_pending(enc_out_) == 0) {
     if (pending_cleartext_input_.empty())
@@ -326,6 +484,33 @@ void TLSWrap::OnStreamAfterWrite(WriteWrap* req_wrap, int status) {
   // Try writing more data
   write_size_ = 0;
   EncOut();
+  MaybeStartKernelTLS();
+}
+
+
+// Moves the encryption of outgoing records into the kernel, once the
+// handshake is done and everything that OpenSSL encrypted has been written,
+// so that the kernel starts with the next sequence number. If that fails,
+// OpenSSL simply continues to encrypt.
+void TLSWrap::MaybeStartKernelTLS() {
+  if (!kernel_tls_requested_ ||
+      !established_ ||
+      ssl_ == nullptr ||
+      shutdown_ ||
+      write_size_ != 0 ||
+      current_write_ != nullptr ||
+      !pending_cleartext_input_.empty() ||
+      BIO_pending(enc_out_) != 0) {
+    return;
+  }
+
+  kernel_tls_requested_ = false;
+  if (crypto::StartKernelTLS(ssl_, GetFD()) != 0)
+    return;
+
+  // OpenSSL's sequence numbers are stale now. EncOut() drops the records
+  // that it still produces, such as alerts and renegotiation handshakes.
+  kernel_tls_ = true;
 }
 
 
@@ -384,50 +569,67 @@ void TLSWrap::ClearOut() {
   if (ssl_ == nullptr)
     return;
 
+  if (handshake_work_running_)
+    return;
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  char out[kClearOutChunkSize];
   int read;
+  int err = SSL_ERROR_NONE;
+  Local<Value> arg;
   for (;;) {
-    read = SSL_read(ssl_, out, sizeof(out));
-
-    if (read <= 0)
+    if (SSL_pending(ssl_) == 0 && BIO_pending(enc_in_) == 0) {
+      // There is nothing to decrypt, so do not ask the listener for memory.
+      // SSL_read() still drives the handshake and reports errors.
+      char unused;
+      read = SSL_read(ssl_, &unused, sizeof(unused));
+      CHECK_LE(read, 0);
+      arg = GetSSLError(read, &err, nullptr);
       break;
+    }
 
-    char* current = out;
-    while (read > 0) {
-      int avail = read;
+    // Decrypt straight into the listener's buffer, as many records as fit,
+    // and pass them on with a single EmitRead().
+    uv_buf_t buf = EmitAlloc(kClearOutChunkSize);
+    CHECK_GT(buf.len, 0);
+    size_t nread = 0;
+    do {
+      read = SSL_read(ssl_, buf.base + nread, buf.len - nread);
+      if (read > 0)
+        nread += read;
+    } while (read > 0 && nread < buf.len);
+
+    // The last SSL_read() failed, look at why before JS land runs: writing
+    // from a 'data' handler calls SSL_write(), which resets the state that
+    // SSL_get_error() depends on.
+    if (read <= 0)
+      arg = GetSSLError(read, &err, nullptr);
 
-      uv_buf_t buf = EmitAlloc(avail);
-      if (static_cast<int>(buf.len) < avail)
-        avail = buf.len;
-      memcpy(buf.base, current, avail);
-      EmitRead(avail, buf);
+    // An empty read gives the buffer back.
+    EmitRead(nread, buf);
 
-      // Caveat emptor: OnRead() calls into JS land which can result in
-      // the SSL context object being destroyed.  We have to carefully
-      // check that ssl_ != nullptr afterwards.
-      if (ssl_ == nullptr)
-        return;
+    // Caveat emptor: OnRead() calls into JS land which can result in
+    // the SSL context object being destroyed.  We have to carefully
+    // check that ssl_ != nullptr afterwards.
+    if (ssl_ == nullptr)
+      return;
 
-      read -= avail;
-      current += avail;
-    }
+    if (read <= 0)
+      break;
   }
 
   int flags = SSL_get_shutdown(ssl_);
   if (!eof_ && flags & SSL_RECEIVED_SHUTDOWN) {
     eof_ = true;
     EmitRead(UV_EOF);
+    if (ssl_ == nullptr)
+      return;
   }
 
   // We need to check whether an error occurred or the connection was
   // shutdown cleanly (SSL_ERROR_ZERO_RETURN) even when read == 0.
   // See node#1642 and SSL_read(3SSL) for details.
   if (read <= 0) {
-    int err;
-    Local<Value> arg = GetSSLError(read, &err, nullptr);
-
     // Ignore ZERO_RETURN after EOF, it is basically not a error
     if (err == SSL_ERROR_ZERO_RETURN && eof_)
       return;
@@ -452,21 +654,16 @@ bool TLSWrap::ClearIn() {
   if (ssl_ == nullptr)
     return false;
 
+  if (handshake_work_running_)
+    return false;
+
   std::vector<uv_buf_t> buffers;
   buffers.swap(pending_cleartext_input_);
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  size_t i;
   int written = 0;
-  for (i = 0; i < buffers.size(); ++i) {
-    size_t avail = buffers[i].len;
-    char* data = buffers[i].base;
-    written = SSL_write(ssl_, data, avail);
-    CHECK(written == -1 || written == static_cast<int>(avail));
-    if (written == -1)
-      break;
-  }
+  size_t i = ClearWrite(buffers.data(), buffers.size(), &written);
 
   // All written
   if (i == buffers.size()) {
@@ -494,6 +691,64 @@ bool TLSWrap::ClearIn() {
 }
 
 
+// Passes `bufs` to SSL_write() and returns the number of buffers that were
+// written. When that is less than `count`, `*written` is the return value of
+// the SSL_write() call that failed.
+//
+// Unless disabled with setCoalesceWrites(false), consecutive small buffers
+// are copied into a staging buffer of up to one record and encrypted
+// together. Nothing is held back for later writes: a record never spans two
+// DoWrite() calls, so JS controls the boundaries with cork() and uncork().
+size_t TLSWrap::ClearWrite(const uv_buf_t* bufs, size_t count, int* written) {
+  char staging[SSL3_RT_MAX_PLAIN_LENGTH];
+  const size_t max_length = coalesce_writes_ ? MaxSendFragment() : 0;
+
+  size_t i = 0;
+  *written = 0;
+  while (i < count) {
+    size_t n = 1;
+    size_t length = bufs[i].len;
+    if (length < kCoalesceChunkSize) {
+      while (i + n < count &&
+             bufs[i + n].len < kCoalesceChunkSize &&
+             length + bufs[i + n].len <= max_length) {
+        length += bufs[i + n].len;
+        n++;
+      }
+    }
+
+    if (n == 1) {
+      *written = SSL_write(ssl_, bufs[i].base, length);
+    } else {
+      size_t offset = 0;
+      for (size_t j = i; j < i + n; j++) {
+        memcpy(staging + offset, bufs[j].base, bufs[j].len);
+        offset += bufs[j].len;
+      }
+      *written = SSL_write(ssl_, staging, length);
+    }
+    // The BIO never blocks, so writes are never partial. A failed write, e.g.
+    // during the handshake, is retried from the first of its buffers.
+    CHECK(*written == -1 || *written == static_cast<int>(length));
+    if (*written == -1)
+      break;
+    i += n;
+  }
+
+  return i;
+}
+
+
+size_t TLSWrap::MaxSendFragment() const {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  // Lowered by setMaxSendFragment().
+  return ssl_->max_send_fragment;
+#else
+  return SSL3_RT_MAX_PLAIN_LENGTH;
+#endif  // OPENSSL_VERSION_NUMBER < 0x10100000L
+}
+
+
 AsyncWrap* TLSWrap::GetAsyncWrap() {
   return static_cast<AsyncWrap*>(this);
 }
@@ -553,6 +808,23 @@ int TLSWrap::DoWrite(WriteWrap* w,
   CHECK_EQ(send_handle, nullptr);
   CHECK_NE(ssl_, nullptr);
 
+  if (handshake_work_running_) {
+    // Encrypted after the handshake work, like other writes that are made
+    // during the handshake.
+    CHECK_EQ(current_write_, nullptr);
+    current_write_ = w;
+    w->Dispatched();
+    for (size_t i = 0; i < count; i++) {
+      if (bufs[i].len > 0)
+        pending_cleartext_input_.push_back(bufs[i]);
+    }
+    return 0;
+  }
+
+  MaybeStartKernelTLS();
+  if (kernel_tls_)
+    return stream_->DoWrite(w, bufs, count, send_handle);
+
   bool empty = true;
 
   // Empty writes should not go through encryption process
@@ -591,12 +863,7 @@ int TLSWrap::DoWrite(WriteWrap* w,
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
   int written = 0;
-  for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    CHECK(written == -1 || written == static_cast<int>(bufs[i].len));
-    if (written == -1)
-      break;
-  }
+  i = ClearWrite(bufs, count, &written);
 
   if (i != count) {
     int err;
@@ -619,6 +886,15 @@ int TLSWrap::DoWrite(WriteWrap* w,
 uv_buf_t TLSWrap::OnStreamAlloc(size_t suggested_size) {
   CHECK_NE(ssl_, nullptr);
 
+  if (handshake_work_running_) {
+    // enc_in_ is in use on the threadpool, keep the data on the side.
+    handshake_work_input_.resize(handshake_work_input_length_ +
+                                 suggested_size);
+    return uv_buf_init(
+        handshake_work_input_.data() + handshake_work_input_length_,
+        suggested_size);
+  }
+
   size_t size = suggested_size;
   char* base = crypto::NodeBIO::FromBIO(enc_in_)->PeekWritable(&size);
   return uv_buf_init(base, size);
@@ -647,6 +923,11 @@ void TLSWrap::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
     return;
   }
 
+  if (handshake_work_running_) {
+    handshake_work_input_length_ += nread;
+    return;
+  }
+
   // Commit read data
   crypto::NodeBIO* enc_in = crypto::NodeBIO::FromBIO(enc_in_);
   enc_in->Commit(nread);
@@ -661,14 +942,39 @@ void TLSWrap::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
 
   // Cycle OpenSSL's state
   Cycle();
+  MaybeStartKernelTLS();
+}
+
+
+int TLSWrap::DoTryWrite(uv_buf_t** bufs, size_t* count) {
+  // Plaintext can be written right away when the kernel encrypts it.
+  if (kernel_tls_)
+    return stream_->DoTryWrite(bufs, count);
+  return 0;
 }
 
 
 int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
+  if (handshake_work_running_) {
+    CHECK_EQ(shutdown_after_handshake_work_, nullptr);
+    shutdown_after_handshake_work_ = req_wrap;
+    return 0;
+  }
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  if (ssl_ != nullptr && SSL_shutdown(ssl_) == 0)
+  if (kernel_tls_) {
+    // JS only shuts down after all writes finished, so this is the last
+    // record on the socket. If the peer has not read the data before it yet,
+    // the alert has to wait, and so does the FIN.
+    if (crypto::SendKernelTLSCloseNotify(GetFD()) == UV_EAGAIN) {
+      shutdown_ = true;
+      RetryCloseNotify(req_wrap);
+      return 0;
+    }
+  } else if (ssl_ != nullptr && SSL_shutdown(ssl_) == 0) {
     SSL_shutdown(ssl_);
+  }
 
   shutdown_ = true;
   EncOut();
@@ -676,6 +982,59 @@ int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
 }
 
 
+void TLSWrap::RetryCloseNotify(ShutdownWrap* req_wrap) {
+  CHECK_EQ(close_notify_retry_, nullptr);
+  close_notify_retry_ = new CloseNotifyRetry { uv_timer_t(), this, req_wrap };
+  uv_timer_t* timer = &close_notify_retry_->timer;
+  CHECK_EQ(0, uv_timer_init(env()->event_loop(), timer));
+  CHECK_EQ(0, uv_timer_start(timer,
+                             OnCloseNotifyRetry,
+                             kCloseNotifyRetryDelay,
+                             kCloseNotifyRetryDelay));
+
+  // The socket may be dropped by JS in the meantime.
+  ClearWeak();
+}
+
+
+// Returns the shutdown request that was waiting for the alert.
+ShutdownWrap* TLSWrap::StopCloseNotifyRetry() {
+  CloseNotifyRetry* retry = close_notify_retry_;
+  close_notify_retry_ = nullptr;
+  uv_close(reinterpret_cast<uv_handle_t*>(&retry->timer), [](uv_handle_t* h) {
+    CloseNotifyRetry* retry =
+        ContainerOf(&CloseNotifyRetry::timer, reinterpret_cast<uv_timer_t*>(h));
+    delete retry;
+  });
+  MakeWeak(this);
+  return retry->req_wrap;
+}
+
+
+void TLSWrap::OnCloseNotifyRetry(uv_timer_t* timer) {
+  CloseNotifyRetry* retry = ContainerOf(&CloseNotifyRetry::timer, timer);
+  TLSWrap* wrap = retry->wrap;
+
+  // The file descriptor is gone once the underlying stream is closed.
+  int err = UV_ECANCELED;
+  if (wrap->IsAlive() && !wrap->IsClosing()) {
+    err = crypto::SendKernelTLSCloseNotify(wrap->GetFD());
+    if (err == UV_EAGAIN)
+      return;
+  }
+
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  ShutdownWrap* req_wrap = wrap->StopCloseNotifyRetry();
+  if (err != UV_ECANCELED)
+    err = wrap->stream_->DoShutdown(req_wrap);
+  if (err != 0)
+    req_wrap->Done(err);
+}
+
+
 void TLSWrap::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
@@ -685,6 +1044,10 @@ void TLSWrap::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[1]->IsBoolean());
   CHECK_NE(wrap->ssl_, nullptr);
 
+  // The threadpool owns ssl_, see CertCallback().
+  if (wrap->handshake_work_running_)
+    return;
+
   int verify_mode;
   if (wrap->is_server()) {
     bool request_cert = args[0]->IsTrue();
@@ -707,6 +1070,39 @@ void TLSWrap::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSWrap::SetCoalesceWrites(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK_EQ(args.Length(), 1);
+  CHECK(args[0]->IsBoolean());
+  wrap->coalesce_writes_ = args[0]->IsTrue();
+}
+
+
+void TLSWrap::EnableKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  wrap->kernel_tls_requested_ = true;
+}
+
+
+void TLSWrap::IsKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  args.GetReturnValue().Set(wrap->kernel_tls_);
+}
+
+
+void TLSWrap::EnableAsyncHandshake(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  CHECK(wrap->is_server());
+  CHECK(!wrap->established_);
+  wrap->async_handshake_ = true;
+}
+
+
 void TLSWrap::EnableSessionCallbacks(
     const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
@@ -730,8 +1126,16 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
   // And destroy
   wrap->InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
 
-  // Destroy the SSL structure and friends
-  wrap->SSLWrap<TLSWrap>::DestroySSL();
+  // The stream is not shut down anymore once the SSL structure is gone.
+  if (wrap->close_notify_retry_ != nullptr)
+    wrap->StopCloseNotifyRetry()->Done(UV_ECANCELED);
+
+  // Destroy the SSL structure and friends, once the threadpool is done with
+  // them.
+  if (wrap->handshake_work_running_)
+    wrap->destroy_after_handshake_work_ = true;
+  else
+    wrap->SSLWrap<TLSWrap>::DestroySSL();
 
   if (wrap->stream_ != nullptr)
     wrap->stream_->RemoveStreamListener(wrap);
@@ -760,6 +1164,10 @@ void TLSWrap::GetServername(const FunctionCallbackInfo<Value>& args) {
 
   CHECK_NE(wrap->ssl_, nullptr);
 
+  // The threadpool owns ssl_, see CertCallback().
+  if (wrap->handshake_work_running_)
+    return;
+
   const char* servername = SSL_get_servername(wrap->ssl_,
                                               TLSEXT_NAMETYPE_host_name);
   if (servername != nullptr) {
@@ -830,7 +1238,7 @@ void TLSWrap::GetWriteQueueSize(const FunctionCallbackInfo<Value>& info) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, info.This());
 
-  if (wrap->ssl_ == nullptr) {
+  if (wrap->ssl_ == nullptr || wrap->handshake_work_running_) {
     info.GetReturnValue().Set(0);
     return;
   }
@@ -876,6 +1284,10 @@ void TLSWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "setVerifyMode", SetVerifyMode);
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "destroySSL", DestroySSL);
+  env->SetProtoMethod(t, "setCoalesceWrites", SetCoalesceWrites);
+  env->SetProtoMethod(t, "enableKernelTLS", EnableKernelTLS);
+  env->SetProtoMethod(t, "isKernelTLS", IsKernelTLS);
+  env->SetProtoMethod(t, "enableAsyncHandshake", EnableAsyncHandshake);
   env->SetProtoMethod(t, "enableCertCb", EnableCertCb);
 
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
@@ -66,6 +66,7 @@ class TLSWrap : public AsyncWrap,
   int ReadStop() override;
 
   int DoShutdown(ShutdownWrap* req_wrap) override;
+  int DoTryWrite(uv_buf_t** bufs, size_t* count) override;
   int DoWrite(WriteWrap* w,
               uv_buf_t* bufs,
               size_t count,
@@ -75,10 +76,16 @@ class TLSWrap : public AsyncWrap,
 
   void NewSessionDoneCb();
 
+  // The threadpool owns ssl_ while it produces the server's first flight.
+  inline bool is_ssl_busy() const { return handshake_work_running_; }
+
   size_t self_size() const override { return sizeof(*this); }
 
  protected:
-  static const int kClearOutChunkSize = 16384;
+  // Cleartext that is passed to the listener at once. It matches the size of
+  // the reads from the underlying stream, so that all records which arrived
+  // together end up in one buffer.
+  static const int kClearOutChunkSize = 64 * 1024;
 
   // Maximum number of bytes for hello parser
   static const int kMaxHelloLength = 16384;
@@ -86,19 +93,38 @@ class TLSWrap : public AsyncWrap,
   // Usual ServerHello + Certificate size
   static const int kInitialClientBufferLength = 4096;
 
+  // How often the close_notify alert is tried again while the send buffer
+  // of a kTLS socket is full.
+  static const uint64_t kCloseNotifyRetryDelay = 10;
+
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Buffers smaller than this are copied into a staging buffer, so that
+  // several of them are encrypted into one record; larger ones are passed to
+  // SSL_write() as they are.
+  static const size_t kCoalesceChunkSize = 4096;
+
   TLSWrap(Environment* env,
           Kind kind,
           StreamBase* stream,
           crypto::SecureContext* sc);
 
   static void SSLInfoCallback(const SSL* ssl_, int where, int ret);
+  static int CertCallback(SSL* s, void* arg);
   void InitSSL();
   void EncOut();
   bool ClearIn();
   void ClearOut();
+  size_t ClearWrite(const uv_buf_t* bufs, size_t count, int* written);
+  size_t MaxSendFragment() const;
+  void MaybeStartKernelTLS();
+  void RetryCloseNotify(ShutdownWrap* req_wrap);
+  ShutdownWrap* StopCloseNotifyRetry();
+  static void OnCloseNotifyRetry(uv_timer_t* timer);
+  void StartHandshakeWork();
+  static void HandshakeWork(uv_work_t* req);
+  static void AfterHandshakeWork(uv_work_t* req, int status);
   bool InvokeQueued(int status, const char* error_str = nullptr);
 
   inline void Cycle() {
@@ -133,6 +159,12 @@ class TLSWrap : public AsyncWrap,
   static void EnableCertCb(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetCoalesceWrites(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void IsKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncHandshake(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -147,6 +179,35 @@ class TLSWrap : public AsyncWrap,
   size_t write_size_;
   WriteWrap* current_write_ = nullptr;
   bool write_callback_scheduled_ = false;
+  bool coalesce_writes_ = true;
+  // Set by enableKernelTLS(), until StartKernelTLS() was tried.
+  bool kernel_tls_requested_ = false;
+  // Outgoing records are encrypted by the kernel, OpenSSL only decrypts.
+  bool kernel_tls_ = false;
+  // The close_notify alert did not fit into the send buffer of the socket.
+  // The shutdown of the underlying stream waits until it was sent.
+  struct CloseNotifyRetry {
+    uv_timer_t timer;
+    TLSWrap* wrap;
+    ShutdownWrap* req_wrap;
+  };
+  CloseNotifyRetry* close_notify_retry_ = nullptr;
+  // Set by enableAsyncHandshake(), until the handshake work was started.
+  bool async_handshake_ = false;
+  // The certificate callback suspended the handshake, so that the rest of the
+  // server's first flight is produced on the threadpool.
+  bool handshake_work_pending_ = false;
+  // The threadpool owns ssl_, enc_in_ and enc_out_. destroySSL() and
+  // shutdown() wait for it to finish.
+  bool handshake_work_running_ = false;
+  bool destroy_after_handshake_work_ = false;
+  ShutdownWrap* shutdown_after_handshake_work_ = nullptr;
+  uv_work_t handshake_work_req_;
+  int handshake_work_err_ = SSL_ERROR_NONE;
+  std::string handshake_work_error_;
+  // Encrypted data that arrived while the handshake work was running.
+  std::vector<char> handshake_work_input_;
+  size_t handshake_work_input_length_ = 0;
   bool started_;
   bool established_;
   bool shutdown_;
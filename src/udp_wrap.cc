@@ -26,7 +26,14 @@
 #include "req_wrap-inl.h"
 #include "util-inl.h"
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>  // memmove(), memset()
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/socket.h>  // recvmmsg(), sendmmsg()
+#endif
 
 
 namespace node {
@@ -38,6 +45,7 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Object;
 using v8::PropertyAttribute;
@@ -49,6 +57,8 @@ using v8::Value;
 
 using AsyncHooks = Environment::AsyncHooks;
 
+static const uint32_t kMaxRecvBatch = 1024;
+
 
 class SendWrap : public ReqWrap<uv_udp_send_t> {
  public:
@@ -81,6 +91,79 @@ inline bool SendWrap::have_callback() const {
 }
 
 
+// A single completion for all datagrams of a sendBatch() call that could not
+// be written synchronously and were queued with uv_udp_send() instead.
+class SendBatchWrap : public AsyncWrap {
+ public:
+  SendBatchWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                size_t count,
+                bool have_callback);
+  ~SendBatchWrap();
+
+  inline uv_udp_send_t* req(size_t index);
+  static void OnSend(uv_udp_send_t* req, int status);
+
+  size_t pending = 0;
+  int status = 0;
+  size_t msg_size = 0;
+  size_t self_size() const override {
+    return sizeof(*this) + count_ * sizeof(reqs_[0]);
+  }
+
+ private:
+  const size_t count_;
+  const bool have_callback_;
+  std::unique_ptr<uv_udp_send_t[]> reqs_;
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             size_t count,
+                             bool have_callback)
+    : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      count_(count),
+      have_callback_(have_callback),
+      reqs_(new uv_udp_send_t[count]) {
+  Wrap(req_wrap_obj, this);
+  for (size_t i = 0; i < count; i++)
+    reqs_[i].data = this;
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  ClearWrap(object());
+}
+
+
+uv_udp_send_t* SendBatchWrap::req(size_t index) {
+  CHECK_LT(index, count_);
+  return &reqs_[index];
+}
+
+
+void SendBatchWrap::OnSend(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  if (status < 0 && req_wrap->status == 0)
+    req_wrap->status = status;
+  if (--req_wrap->pending > 0)
+    return;
+
+  if (req_wrap->have_callback_) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg[] = {
+      Integer::New(env->isolate(), req_wrap->status),
+      Integer::New(env->isolate(), req_wrap->msg_size),
+    };
+    req_wrap->MakeCallback(env->oncomplete_string(), 2, arg);
+  }
+  delete req_wrap;
+}
+
+
 static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
   ClearWrap(args.This());
@@ -97,6 +180,133 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object)
 }
 
 
+UDPWrap::~UDPWrap() {}
+
+
+// The buffer that a batch of datagrams is received into, and the message
+// headers for draining the datagrams that follow the one libuv has just read.
+// Only recvmmsg(2) can do that in a single system call, so on other platforms
+// every batch consists of a single datagram.
+//
+// The buffer is reused by the reads that find no datagram, including the
+// last one of every libuv read loop, and only handed to JS, and replaced,
+// when a batch is delivered.
+class UDPWrap::RecvBatch {
+ public:
+  explicit RecvBatch(uint32_t size);
+  ~RecvBatch() { free(buffer_); }
+
+  // The number of datagrams that a batch holds.
+  inline uint32_t size() const { return size_; }
+
+  // One slot of `slot_size` bytes for every datagram of the batch. The memory
+  // is not initialized, so the pages of slots that stay empty are never
+  // touched.
+  uv_buf_t GetBuffer(size_t slot_size);
+  // Passes ownership of the buffer to the caller.
+  char* TakeBuffer();
+
+  // Reads up to `size() - 1` queued datagrams without blocking, one into each
+  // `slot_size` bytes starting at `base`. Returns their number, or a negative
+  // libuv error code.
+  int Drain(uv_os_fd_t fd, char* base, size_t slot_size);
+
+  inline size_t length(int i) const;
+  inline const struct sockaddr* addr(int i) const;
+
+ private:
+  uint32_t size_;
+  char* buffer_ = nullptr;
+  size_t buffer_size_ = 0;
+#if defined(__linux__)
+  std::vector<struct mmsghdr> msgs_;
+  std::vector<struct iovec> iov_;
+  std::vector<struct sockaddr_storage> peers_;
+#endif
+};
+
+
+UDPWrap::RecvBatch::RecvBatch(uint32_t size) {
+#if defined(__linux__)
+  size_ = size;
+  const size_t extra = size - 1;
+  msgs_.resize(extra);
+  iov_.resize(extra);
+  peers_.resize(extra);
+  for (size_t i = 0; i < extra; i++) {
+    memset(&msgs_[i], 0, sizeof(msgs_[i]));
+    msgs_[i].msg_hdr.msg_iov = &iov_[i];
+    msgs_[i].msg_hdr.msg_iovlen = 1;
+    msgs_[i].msg_hdr.msg_name = &peers_[i];
+  }
+#else
+  size_ = 1;
+#endif
+}
+
+
+uv_buf_t UDPWrap::RecvBatch::GetBuffer(size_t slot_size) {
+  const size_t size = slot_size * size_;
+  if (buffer_size_ != size) {
+    free(buffer_);
+    buffer_ = node::Malloc(size);
+    buffer_size_ = size;
+  }
+  return uv_buf_init(buffer_, size);
+}
+
+
+char* UDPWrap::RecvBatch::TakeBuffer() {
+  char* buffer = buffer_;
+  buffer_ = nullptr;
+  buffer_size_ = 0;
+  return buffer;
+}
+
+
+int UDPWrap::RecvBatch::Drain(uv_os_fd_t fd, char* base, size_t slot_size) {
+#if defined(__linux__)
+  if (msgs_.empty())
+    return 0;
+
+  for (size_t i = 0; i < msgs_.size(); i++) {
+    iov_[i].iov_base = base + i * slot_size;
+    iov_[i].iov_len = slot_size;
+    msgs_[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+  }
+
+  int r;
+  do {
+    r = recvmmsg(fd, msgs_.data(), msgs_.size(), MSG_DONTWAIT, nullptr);
+  } while (r == -1 && errno == EINTR);
+
+  if (r == -1)
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -errno;
+  return r;
+#else
+  return 0;
+#endif
+}
+
+
+size_t UDPWrap::RecvBatch::length(int i) const {
+#if defined(__linux__)
+  return msgs_[i].msg_len;
+#else
+  UNREACHABLE();
+#endif
+}
+
+
+const struct sockaddr* UDPWrap::RecvBatch::addr(int i) const {
+#if defined(__linux__)
+  return reinterpret_cast<const struct sockaddr*>(&peers_[i]);
+#else
+  UNREACHABLE();
+#endif
+}
+
+
 void UDPWrap::Initialize(Local<Object> target,
                          Local<Value> unused,
                          Local<Context> context) {
@@ -128,9 +338,12 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
+  env->SetProtoMethod(t, "setRecvBatch", SetRecvBatch);
   env->SetProtoMethod(t, "getsockname",
                       GetSockOrPeerName<UDPWrap, uv_udp_getsockname>);
   env->SetProtoMethod(t, "addMembership", AddMembership);
@@ -421,6 +634,168 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // sendBatch(req, list, ports, addresses, hasCallback)
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsArray());
+  CHECK(args[4]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> chunks = args[1].As<Array>();
+  Local<Array> ports = args[2].As<Array>();
+  Local<Array> addresses = args[3].As<Array>();
+  const bool have_callback = args[4]->IsTrue();
+
+  const size_t count = chunks->Length();
+  CHECK_EQ(ports->Length(), count);
+  CHECK_EQ(addresses->Length(), count);
+
+  MaybeStackBuffer<uv_buf_t, 16> bufs(count);
+  MaybeStackBuffer<sockaddr_storage, 16> addrs(count);
+  size_t msg_size = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> chunk = chunks->Get(context, i).ToLocalChecked();
+    size_t length = Buffer::Length(chunk);
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), length);
+    msg_size += length;
+
+    Local<Value> port = ports->Get(context, i).ToLocalChecked();
+    CHECK(port->IsUint32());
+    node::Utf8Value address(env->isolate(),
+                            addresses->Get(context, i).ToLocalChecked());
+    int err;
+    switch (family) {
+    case AF_INET:
+      err = uv_ip4_addr(*address,
+                        port.As<Uint32>()->Value(),
+                        reinterpret_cast<sockaddr_in*>(&addrs[i]));
+      break;
+    case AF_INET6:
+      err = uv_ip6_addr(*address,
+                        port.As<Uint32>()->Value(),
+                        reinterpret_cast<sockaddr_in6*>(&addrs[i]));
+      break;
+    default:
+      CHECK(0 && "unexpected address family");
+      ABORT();
+    }
+    if (err)
+      return args.GetReturnValue().Set(err);
+  }
+
+  int sent = wrap->TrySendBatch(*bufs, *addrs, count);
+  if (sent < 0 || static_cast<size_t>(sent) == count)
+    return args.GetReturnValue().Set(sent);
+
+  // The socket's send buffer is full, or libuv still has sends queued up;
+  // hand the rest over to libuv, which preserves the order of the datagrams.
+  SendBatchWrap* req_wrap;
+  {
+    AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(
+      env, wrap->get_async_id());
+    req_wrap = new SendBatchWrap(env, req_wrap_obj, count - sent,
+                                 have_callback);
+  }
+  req_wrap->msg_size = msg_size;
+
+  int err = 0;
+  for (size_t i = sent; i < count; i++) {
+    err = uv_udp_send(req_wrap->req(i - sent),
+                      &wrap->handle_,
+                      &bufs[i],
+                      1,
+                      reinterpret_cast<const sockaddr*>(&addrs[i]),
+                      SendBatchWrap::OnSend);
+    if (err)
+      break;
+    req_wrap->pending++;
+  }
+
+  if (req_wrap->pending == 0) {
+    delete req_wrap;
+    return args.GetReturnValue().Set(err);
+  }
+
+  req_wrap->status = err;
+  args.GetReturnValue().Set(sent);
+}
+
+
+int UDPWrap::TrySendBatch(uv_buf_t* bufs,
+                          const sockaddr_storage* addrs,
+                          size_t count) {
+  size_t sent = 0;
+
+#if defined(__linux__)
+  uv_os_fd_t fd;
+  if (handle_.send_queue_count > 0 ||
+      uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) != 0) {
+    return 0;
+  }
+
+  MaybeStackBuffer<struct mmsghdr, 16> msgs(count);
+  for (size_t i = 0; i < count; i++) {
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = const_cast<sockaddr_storage*>(&addrs[i]);
+    msgs[i].msg_hdr.msg_namelen = addrs[i].ss_family == AF_INET6 ?
+        sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+    // uv_buf_t is layout-compatible with struct iovec on Unix.
+    msgs[i].msg_hdr.msg_iov = reinterpret_cast<struct iovec*>(&bufs[i]);
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  while (sent < count) {
+    int r = sendmmsg(fd, &msgs[sent], count - sent, MSG_DONTWAIT);
+    if (r == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOSYS)
+        break;
+      // Report the error unless some datagrams made it out already, in which
+      // case libuv will run into it again for the next one.
+      return sent > 0 ? sent : -errno;
+    }
+    sent += r;
+  }
+#else
+  for (; sent < count; sent++) {
+    int r = uv_udp_try_send(&handle_,
+                            &bufs[sent],
+                            1,
+                            reinterpret_cast<const sockaddr*>(&addrs[sent]));
+    if (r == UV_EAGAIN || r == UV_ENOSYS)
+      break;
+    if (r < 0)
+      return sent > 0 ? sent : r;
+  }
+#endif
+
+  return sent;
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap,
@@ -444,6 +819,22 @@ void UDPWrap::RecvStop(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::SetRecvBatch(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+  const uint32_t size = args[0].As<Uint32>()->Value();
+  CHECK_LE(size, kMaxRecvBatch);
+
+  if (size > 1)
+    wrap->recv_batch_.reset(new RecvBatch(size));
+  else
+    wrap->recv_batch_.reset();
+}
+
+
 void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
   SendWrap* req_wrap = static_cast<SendWrap*>(req->data);
   if (req_wrap->have_callback()) {
@@ -463,8 +854,18 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = node::Malloc(suggested_size);
-  buf->len = suggested_size;
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  CHECK_EQ(wrap->read_slab_, nullptr);
+
+  if (wrap->recv_batch_) {
+    // libuv reads the first datagram into the first slot, and OnRecvBatch()
+    // the others into the rest.
+    *buf = wrap->recv_batch_->GetBuffer(suggested_size);
+    return;
+  }
+
+  *buf = wrap->env()->read_buffer_pool()->Allocate(suggested_size,
+                                                    &wrap->read_slab_);
 }
 
 
@@ -473,15 +874,21 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  Environment* env = wrap->env();
+  ReadBufferPool* pool = env->read_buffer_pool();
+  ReadBufferPool::Slab* slab = wrap->read_slab_;
+  wrap->read_slab_ = nullptr;
+
+  // The batch buffer stays with the socket for the next read.
+  const bool batch = wrap->recv_batch_ != nullptr;
+
   if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
-      free(buf->base);
+    if (!batch)
+      pool->Release(slab, *buf);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
-  Environment* env = wrap->env();
-
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -494,19 +901,91 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
+    if (!batch)
+      pool->Release(slab, *buf);
     wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
     return;
   }
 
-  char* base = node::UncheckedRealloc(buf->base, nread);
-  argv[2] = Buffer::New(env, base, nread).ToLocalChecked();
+  if (batch) {
+    wrap->OnRecvBatch(nread, *buf, addr);
+    return;
+  }
+
+  argv[2] = pool->Carve(env, slab, *buf, nread).ToLocalChecked();
   argv[3] = AddressToJS(env, addr);
   wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
 }
 
 
+void UDPWrap::OnRecvBatch(ssize_t nread,
+                          const uv_buf_t& buf,
+                          const struct sockaddr* addr) {
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  // The buffer from OnAlloc() holds the first datagram in its first slot.
+  char* data = recv_batch_->TakeBuffer();
+  CHECK_EQ(data, buf.base);
+  const size_t slot_size = buf.len / recv_batch_->size();
+
+  uv_os_fd_t fd;
+  int count = 0;
+  int err = 0;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) == 0) {
+    count = recv_batch_->Drain(fd, data + slot_size, slot_size);
+    if (count < 0) {
+      err = count;
+      count = 0;
+    }
+  }
+
+  Local<Array> entries = Array::New(isolate, 3 * (count + 1));
+  entries->Set(context, 0, Integer::New(isolate, 0)).FromJust();
+  entries->Set(context, 1, Integer::New(isolate, nread)).FromJust();
+  entries->Set(context, 2, AddressToJS(env, addr)).FromJust();
+
+  // Move the datagrams down to the end of their predecessors, so that they
+  // are back to back and the tail of the buffer can be given back.
+  size_t offset = nread;
+  for (int i = 0; i < count; i++) {
+    const size_t length = recv_batch_->length(i);
+    const char* slot = data + (i + 1) * slot_size;
+    if (slot != data + offset)
+      memmove(data + offset, slot, length);
+    const uint32_t index = 3 * (i + 1);
+    entries->Set(context, index,
+                 Integer::NewFromUnsigned(isolate, offset)).FromJust();
+    entries->Set(context, index + 1,
+                 Integer::NewFromUnsigned(isolate, length)).FromJust();
+    entries->Set(context, index + 2,
+                 AddressToJS(env, recv_batch_->addr(i))).FromJust();
+    offset += length;
+  }
+
+  data = node::Realloc(data, offset);
+  Local<Value> argv[] = {
+    object(),
+    Buffer::New(env, data, offset).ToLocalChecked(),
+    entries
+  };
+  MakeCallback(env->onmessages_string(), arraysize(argv), argv);
+
+  // recvmmsg(2) consumed a pending socket error; report it the same way the
+  // regular receive path does, unless the socket was closed in the meantime.
+  if (err != 0 && IsAlive(this)) {
+    Local<Value> error_argv[] = {
+      Integer::New(isolate, err),
+      object(),
+      Undefined(isolate),
+      Undefined(isolate)
+    };
+    MakeCallback(env->onmessage_string(), arraysize(error_argv), error_argv);
+  }
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env,
                                    AsyncWrap* parent,
                                    UDPWrap::SocketType type) {
@@ -31,6 +31,8 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <memory>
+
 namespace node {
 
 class UDPWrap: public HandleWrap {
@@ -47,8 +49,11 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecvBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AddMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DropMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetMulticastInterface(
@@ -75,11 +80,19 @@ class UDPWrap: public HandleWrap {
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
   UDPWrap(Environment* env, v8::Local<v8::Object> object);
+  ~UDPWrap() override;
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
+  // Writes as many of the datagrams as possible without blocking, with a
+  // single sendmmsg(2) call where available. Returns the number of datagrams
+  // that were sent, or a negative libuv error code.
+  int TrySendBatch(uv_buf_t* bufs, const sockaddr_storage* addrs,
+                   size_t count);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -93,7 +106,19 @@ class UDPWrap: public HandleWrap {
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  // Delivers the datagram in `buf` together with the ones that are already
+  // queued on the socket in a single `onmessages` call.
+  void OnRecvBatch(ssize_t nread,
+                   const uv_buf_t& buf,
+                   const struct sockaddr* addr);
+
+  class RecvBatch;
+
   uv_udp_t handle_;
+  // The slab backing the buffer returned by the last `OnAlloc()` call.
+  ReadBufferPool::Slab* read_slab_ = nullptr;
+  // Set when datagrams should be delivered to JS in batches.
+  std::unique_ptr<RecvBatch> recv_batch_;
 };
 
 }  // namespace node
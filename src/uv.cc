@@ -28,7 +28,9 @@ namespace node {
 namespace {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::Integer;
 using v8::Isolate;
@@ -50,6 +52,41 @@ void ErrName(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+enum ThreadpoolStatsFields {
+  kThreadpoolMaxRunning,
+  kThreadpoolRunning,
+  kThreadpoolQueued,
+  kThreadpoolCompleted,
+  kThreadpoolWaitTimeTotal,
+  kThreadpoolWaitTimeMax,
+  kThreadpoolStatsFieldsCount
+};
+
+
+// Fills kThreadpoolStatsFieldsCount entries for every kind of work, in the
+// order of the UV_WORK_* constants. Times are in nanoseconds.
+void GetThreadpoolStats(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), UV_WORK_KIND_COUNT * kThreadpoolStatsFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  for (int kind = 0; kind < UV_WORK_KIND_COUNT; kind++) {
+    uv_threadpool_stats_t stats;
+    CHECK_EQ(0, uv_threadpool_stats(static_cast<uv_work_kind>(kind), &stats));
+    double* lane = fields + kind * kThreadpoolStatsFieldsCount;
+    lane[kThreadpoolMaxRunning] = stats.max_running;
+    lane[kThreadpoolRunning] = stats.running;
+    lane[kThreadpoolQueued] = stats.queued;
+    lane[kThreadpoolCompleted] = static_cast<double>(stats.completed);
+    lane[kThreadpoolWaitTimeTotal] =
+        static_cast<double>(stats.wait_time_total);
+    lane[kThreadpoolWaitTimeMax] = static_cast<double>(stats.wait_time_max);
+  }
+}
+
+
 void InitializeUV(Local<Object> target,
                   Local<Value> unused,
                   Local<Context> context) {
@@ -57,6 +94,45 @@ void InitializeUV(Local<Object> target,
   Isolate* isolate = env->isolate();
   target->Set(FIXED_ONE_BYTE_STRING(isolate, "errname"),
               env->NewFunctionTemplate(ErrName)->GetFunction());
+  env->SetMethod(target, "getThreadpoolStats", GetThreadpoolStats);
+
+  // Not prefixed with UV_, those are all error codes.
+  NODE_DEFINE_CONSTANT(target, kThreadpoolStatsFieldsCount);
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kWorkCpu"),
+              Integer::New(isolate, UV_WORK_CPU)).FromJust();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kWorkFastIO"),
+              Integer::New(isolate, UV_WORK_FAST_IO)).FromJust();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kWorkSlowIO"),
+              Integer::New(isolate, UV_WORK_SLOW_IO)).FromJust();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kWorkKindCount"),
+              Integer::New(isolate, UV_WORK_KIND_COUNT)).FromJust();
+
+  // Histograms of the threadpool jobs started by this Environment, laid out
+  // as described in threadpool_stats.h.
+  Local<Array> job_types = Array::New(isolate, THREADPOOL_JOB_TYPE_COUNT);
+#define V(name, label)                                                        \
+  job_types->Set(context, THREADPOOL_JOB_##name,                              \
+                 OneByteString(isolate, label)).FromJust();
+  THREADPOOL_JOB_TYPES(V)
+#undef V
+  target->Set(context, FIXED_ONE_BYTE_STRING(isolate, "threadpoolJobTypes"),
+              job_types).FromJust();
+  target->Set(context, FIXED_ONE_BYTE_STRING(isolate, "threadpoolHistograms"),
+              env->threadpool_stats()->fields()->GetJSArray()).FromJust();
+  NODE_DEFINE_CONSTANT(target, kThreadpoolHistogramCount);
+  NODE_DEFINE_CONSTANT(target, kThreadpoolHistogramBuckets);
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kThreadpoolHistogramLength"),
+              Integer::NewFromUnsigned(
+                  isolate, ThreadpoolStats::kHistogramLength)).FromJust();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "kThreadpoolSubBuckets"),
+              Integer::NewFromUnsigned(
+                  isolate, ThreadpoolStats::kSubBuckets)).FromJust();
 
 #define V(name, _) NODE_DEFINE_CONSTANT(target, UV_##name);
   UV_ERRNO_MAP(V)
@@ -0,0 +1,90 @@
+#include "zlib_context_pool.h"
+#include "util-inl.h"
+
+#include "zlib.h"
+
+namespace node {
+
+bool ZlibContextPool::Key::operator==(const Key& other) const {
+  return deflate == other.deflate &&
+         mode == other.mode &&
+         level == other.level &&
+         window_bits == other.window_bits &&
+         mem_level == other.mem_level &&
+         strategy == other.strategy;
+}
+
+
+ZlibContextPool::~ZlibContextPool() {
+  set_enabled(false);
+}
+
+
+z_stream* ZlibContextPool::Take(const Key& key) {
+  if (!enabled_)
+    return nullptr;
+
+  // Prefer the most recently used stream, its memory is more likely to still
+  // be in the cache.
+  for (size_t i = idle_.size(); i > 0; i--) {
+    if (idle_[i - 1].key == key) {
+      z_stream* strm = idle_[i - 1].strm;
+      idle_.erase(idle_.begin() + (i - 1));
+      hits_++;
+      return strm;
+    }
+  }
+
+  misses_++;
+  return nullptr;
+}
+
+
+void ZlibContextPool::Release(const Key& key, z_stream* strm) {
+  if (!enabled_) {
+    End(key, strm);
+    return;
+  }
+
+  int err = key.deflate ? deflateReset(strm) : inflateReset(strm);
+  if (err != Z_OK) {
+    End(key, strm);
+    return;
+  }
+
+  if (idle_.size() == kMaxIdleContexts) {
+    End(idle_.front().key, idle_.front().strm);
+    idle_.erase(idle_.begin());
+    evictions_++;
+  }
+
+  idle_.push_back(Entry { key, strm });
+}
+
+
+void ZlibContextPool::set_enabled(bool value) {
+  enabled_ = value;
+  if (enabled_)
+    return;
+
+  for (const Entry& entry : idle_)
+    End(entry.key, entry.strm);
+  idle_.clear();
+}
+
+
+void ZlibContextPool::GetStats(double* fields) const {
+  fields[kZlibContextPoolHits] = static_cast<double>(hits_);
+  fields[kZlibContextPoolMisses] = static_cast<double>(misses_);
+  fields[kZlibContextPoolEvictions] = static_cast<double>(evictions_);
+  fields[kZlibContextPoolIdle] = static_cast<double>(idle_.size());
+}
+
+
+void ZlibContextPool::End(const Key& key, z_stream* strm) {
+  int status = key.deflate ? deflateEnd(strm) : inflateEnd(strm);
+  CHECK(status == Z_OK || status == Z_DATA_ERROR);
+  delete strm;
+}
+
+}  // namespace node
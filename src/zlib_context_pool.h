@@ -0,0 +1,89 @@
+#ifndef SRC_ZLIB_CONTEXT_POOL_H_
+#define SRC_ZLIB_CONTEXT_POOL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct z_stream_s;  // zlib.h
+
+namespace node {
+
+enum ZlibContextPoolStatsFields {
+  kZlibContextPoolHits,
+  kZlibContextPoolMisses,
+  kZlibContextPoolEvictions,
+  kZlibContextPoolIdle,
+  kZlibContextPoolStatsFieldsCount
+};
+
+// A per-Environment pool of idle zlib streams.
+//
+// deflateInit2() allocates the window, hash chains and pending buffer of a
+// stream, a few hundred KiB with the default settings, and deflateEnd()
+// frees them again. Servers that compress every response would do that once
+// per response. Instead, ZCtx::Close() hands the stream to the pool, which
+// resets it with deflateReset() or inflateReset() and keeps it around for
+// the next ZCtx that is created with the same parameters.
+class ZlibContextPool {
+ public:
+  static const size_t kMaxIdleContexts = 32;
+
+  // The parameters a stream was initialized with. A stream can only be
+  // reused for a ZCtx with the same ones.
+  struct Key {
+    bool deflate;
+    int mode;
+    int level;
+    int window_bits;
+    int mem_level;
+    int strategy;
+
+    bool operator==(const Key& other) const;
+  };
+
+  ZlibContextPool() = default;
+  ~ZlibContextPool();
+
+  // Returns an idle stream that was initialized with `key`, or nullptr if
+  // there is none and the caller has to initialize a new one.
+  z_stream_s* Take(const Key& key);
+
+  // Takes ownership of a stream that was initialized with `key` and is no
+  // longer used. The stream is either reset and kept, or ended and freed.
+  void Release(const Key& key, z_stream_s* strm);
+
+  // Ends and frees a stream without trying to keep it.
+  static void End(const Key& key, z_stream_s* strm);
+
+  inline bool enabled() const { return enabled_; }
+  void set_enabled(bool value);
+
+  // Fills `fields` with kZlibContextPoolStatsFieldsCount entries.
+  void GetStats(double* fields) const;
+
+ private:
+  struct Entry {
+    Key key;
+    z_stream_s* strm;
+  };
+
+  bool enabled_ = true;
+  // Least recently released first.
+  std::vector<Entry> idle_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ZlibContextPool);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_ZLIB_CONTEXT_POOL_H_
@@ -6,9 +6,11 @@ const runBenchmark = require('../common/benchmark');
 
 runBenchmark('misc', [
   'concat=0',
+  'dur=0.1',
   'method=',
   'millions=.000001',
   'n=1',
+  'snapshot=true',
   'type=extend',
   'val=magyarország.icom.museum'
 ], { NODEJS_BENCHMARK_ZERO_ALLOWED: 1 });
@@ -6,8 +6,14 @@ const runBenchmark = require('../common/benchmark');
 
 runBenchmark('zlib',
              [
+               'inlineThreshold=0',
+               'inputLen=200',
+               'level=1',
+               'mb=1',
                'method=deflate',
                'n=1',
                'options=true',
+               'parallel=2',
+               'pool=true',
                'type=Deflate'
              ]);
@@ -0,0 +1,42 @@
+'use strict';
+// Built-in modules that are not taken from the startup snapshot are compiled
+// with the code cache that is built into the binary, if there is one.
+
+require('../common');
+const assert = require('assert');
+const { execFileSync } = require('child_process');
+
+const script = `
+  require('http');
+  const cache = require('internal/code_cache');
+  console.log(JSON.stringify(cache));
+`;
+
+const out = execFileSync(process.execPath, [
+  '--expose-internals', '--no-node-snapshot', '-e', script
+], { encoding: 'utf8' });
+const {
+  hasCodeCache,
+  compiledWithCache,
+  compiledWithoutCache
+} = JSON.parse(out);
+
+assert.strictEqual(typeof hasCodeCache, 'boolean');
+if (hasCodeCache) {
+  assert.ok(compiledWithCache.includes('http'));
+  assert.ok(!compiledWithoutCache.includes('http'));
+} else {
+  assert.deepStrictEqual(compiledWithCache, []);
+  assert.ok(compiledWithoutCache.includes('http'));
+}
+
+// V8 flags that differ from the build invalidate the whole cache, and the
+// modules are compiled from source instead.
+{
+  const out = execFileSync(process.execPath, [
+    '--expose-internals', '--no-node-snapshot', '--no-opt', '-e', script
+  ], { encoding: 'utf8' });
+  const { compiledWithCache, compiledWithoutCache } = JSON.parse(out);
+  assert.deepStrictEqual(compiledWithCache, []);
+  assert.ok(compiledWithoutCache.includes('http'));
+}
@@ -0,0 +1,92 @@
+'use strict';
+// With --compile-cache-dir, the code cache that V8 produces for the modules
+// that require() compiles is written to the directory and consumed by later
+// processes for as long as the source did not change.
+
+require('../common');
+const assert = require('assert');
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+
+const cacheDir = path.join(tmpdir.path, 'compile-cache');
+const helper = path.join(tmpdir.path, 'helper.js');
+const main = path.join(tmpdir.path, 'main.js');
+fs.writeFileSync(helper, 'module.exports = function() { return 42; };');
+fs.writeFileSync(main, `
+  const value = require('./helper')();
+  process.on('exit', () => {
+    const { kCompileCacheStatsFieldsCount, getCompileCacheStats } =
+      process.binding('contextify');
+    const stats = new Float64Array(kCompileCacheStatsFieldsCount);
+    getCompileCacheStats(stats);
+    console.log(JSON.stringify({
+      value,
+      hits: stats[0],
+      misses: stats[1],
+      rejected: stats[2],
+      writes: stats[3],
+      writeErrors: stats[4]
+    }));
+  });
+`);
+
+function run() {
+  const out = execFileSync(process.execPath,
+                           [`--compile-cache-dir=${cacheDir}`, main],
+                           { encoding: 'utf8' });
+  const result = JSON.parse(out);
+  assert.strictEqual(result.value, 42);
+  assert.strictEqual(result.writeErrors, 0);
+  return result;
+}
+
+// The directory is created, and both modules are compiled and written.
+{
+  const result = run();
+  assert.strictEqual(result.hits, 0);
+  assert.strictEqual(result.misses, 2);
+  assert.strictEqual(result.writes, 2);
+  assert.strictEqual(fs.readdirSync(cacheDir).length, 2);
+}
+
+// Nothing needs to be compiled or written again.
+{
+  const result = run();
+  assert.strictEqual(result.hits, 2);
+  assert.strictEqual(result.misses, 0);
+  assert.strictEqual(result.rejected, 0);
+  assert.strictEqual(result.writes, 0);
+}
+
+// An entry for an older source is not used, but replaced.
+{
+  fs.writeFileSync(helper, 'module.exports = () => 42;');
+  let result = run();
+  assert.strictEqual(result.hits, 1);
+  assert.strictEqual(result.misses, 1);
+  assert.strictEqual(result.writes, 1);
+  result = run();
+  assert.strictEqual(result.hits, 2);
+  assert.strictEqual(fs.readdirSync(cacheDir).length, 2);
+}
+
+// Data that V8 rejects is counted and removed.
+{
+  for (const name of fs.readdirSync(cacheDir)) {
+    const file = path.join(cacheDir, name);
+    const contents = fs.readFileSync(file);
+    contents[contents.length - 1] ^= 0xff;
+    fs.writeFileSync(file, contents);
+  }
+  let result = run();
+  assert.strictEqual(result.hits, 0);
+  assert.strictEqual(result.rejected, 2);
+  assert.strictEqual(fs.readdirSync(cacheDir).length, 0);
+  result = run();
+  assert.strictEqual(result.misses, 2);
+  assert.strictEqual(result.writes, 2);
+}
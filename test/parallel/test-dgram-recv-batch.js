@@ -0,0 +1,81 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const kMessages = 20;
+
+[0, -1, 1.5, 1025, '4', null].forEach((recvBatch) => {
+  common.expectsError(() => {
+    dgram.createSocket({ type: 'udp4', recvBatch });
+  }, {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: RangeError
+  });
+});
+
+function sendAll(port) {
+  const client = dgram.createSocket('udp4');
+  let sent = 0;
+  for (let i = 0; i < kMessages; i++) {
+    client.send(`message ${i}`, port, common.localhostIPv4, () => {
+      if (++sent === kMessages)
+        client.close();
+    });
+  }
+}
+
+// Datagrams are delivered through 'messages' as (offset, length, rinfo)
+// triples into one contiguous Buffer.
+{
+  const socket = dgram.createSocket({ type: 'udp4', recvBatch: 8 });
+  const received = [];
+
+  socket.on('message', common.mustNotCall());
+  socket.on('messages', common.mustCallAtLeast((buf, entries) => {
+    assert.ok(Buffer.isBuffer(buf));
+    assert.strictEqual(entries.length % 3, 0);
+    assert.ok(entries.length / 3 <= 8);
+
+    let expectedOffset = 0;
+    for (let i = 0; i < entries.length; i += 3) {
+      const offset = entries[i];
+      const length = entries[i + 1];
+      const rinfo = entries[i + 2];
+      assert.strictEqual(offset, expectedOffset);
+      assert.strictEqual(rinfo.size, length);
+      assert.strictEqual(rinfo.family, 'IPv4');
+      received.push(buf.toString('utf8', offset, offset + length));
+      expectedOffset += length;
+    }
+    assert.strictEqual(expectedOffset, buf.length);
+
+    if (received.length === kMessages) {
+      received.sort((a, b) => a.split(' ')[1] - b.split(' ')[1]);
+      for (let i = 0; i < kMessages; i++)
+        assert.strictEqual(received[i], `message ${i}`);
+      socket.close();
+    }
+  }));
+
+  socket.bind(0, common.mustCall(() => {
+    sendAll(socket.address().port);
+  }));
+}
+
+// Without a 'messages' listener, batches fall back to 'message' events.
+{
+  const socket = dgram.createSocket({ type: 'udp4', recvBatch: 4 });
+  let received = 0;
+
+  socket.on('message', common.mustCall((msg, rinfo) => {
+    assert.strictEqual(rinfo.size, msg.length);
+    assert.ok(/^message \d+$/.test(msg.toString()));
+    if (++received === kMessages)
+      socket.close();
+  }, kMessages));
+
+  socket.bind(0, common.mustCall(() => {
+    sendAll(socket.address().port);
+  }));
+}
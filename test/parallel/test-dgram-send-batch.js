@@ -0,0 +1,74 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const kMessages = 10;
+
+{
+  const socket = dgram.createSocket('udp4');
+
+  common.expectsError(() => socket.sendBatch('foo'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => socket.sendBatch([null]), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 1, port: 1 }]), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 'a', port: 0 }]), {
+    code: 'ERR_SOCKET_BAD_PORT',
+    type: RangeError
+  });
+  common.expectsError(() => {
+    socket.sendBatch([{ msg: 'a', port: 1, address: 'localhost' }]);
+  }, {
+    code: 'ERR_INVALID_IP_ADDRESS',
+    type: TypeError
+  });
+  common.expectsError(() => {
+    socket.sendBatch([{ msg: 'a', port: 1, address: '::1' }]);
+  }, {
+    code: 'ERR_INVALID_IP_ADDRESS',
+    type: TypeError
+  });
+
+  socket.close();
+}
+
+{
+  const receiver = dgram.createSocket('udp4');
+  const sender = dgram.createSocket('udp4');
+  const received = [];
+
+  receiver.on('message', common.mustCall((msg, rinfo) => {
+    assert.strictEqual(rinfo.port, sender.address().port);
+    received.push(msg.toString());
+    if (received.length === kMessages) {
+      received.sort((a, b) => a - b);
+      for (let i = 0; i < kMessages; i++)
+        assert.strictEqual(received[i], `${i}`);
+      receiver.close();
+    }
+  }, kMessages));
+
+  receiver.bind(0, common.mustCall(() => {
+    const messages = [];
+    let bytes = 0;
+    for (let i = 0; i < kMessages; i++) {
+      const msg = i % 2 ? `${i}` : Buffer.from(`${i}`);
+      messages.push({ msg, port: receiver.address().port });
+      bytes += msg.length;
+    }
+
+    sender.sendBatch(messages, common.mustCall((err, sent) => {
+      assert.ifError(err);
+      assert.strictEqual(sent, bytes);
+      sender.close();
+    }));
+  }));
+}
@@ -0,0 +1,76 @@
+'use strict';
+// With UV_USE_IO_URING=1, file system requests are submitted to io_uring where
+// the kernel supports it. The results must be the same as on the threadpool.
+
+const common = require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+if (process.argv[2] === 'child') {
+  const file = path.join(tmpdir.path, 'io-uring.txt');
+  const data = Buffer.from('io_uring and the threadpool\n');
+
+  fs.open(file, 'w+', common.mustCall((err, fd) => {
+    assert.ifError(err);
+    fs.write(fd, data, 0, data.length, null, common.mustCall((err, written) => {
+      assert.ifError(err);
+      assert.strictEqual(written, data.length);
+      fs.fsync(fd, common.mustCall((err) => {
+        assert.ifError(err);
+        fs.fstat(fd, common.mustCall((err, stats) => {
+          assert.ifError(err);
+          assert.strictEqual(stats.size, data.length);
+          assert.ok(stats.isFile());
+          const buf = Buffer.alloc(data.length);
+          fs.read(fd, buf, 0, buf.length, 0, common.mustCall((err, nread) => {
+            assert.ifError(err);
+            assert.strictEqual(nread, data.length);
+            assert.deepStrictEqual(buf, data);
+            fs.fdatasync(fd, common.mustCall((err) => {
+              assert.ifError(err);
+              fs.close(fd, common.mustCall((err) => {
+                assert.ifError(err);
+                checkPaths(file, data);
+              }));
+            }));
+          }));
+        }));
+      }));
+    }));
+  }));
+  return;
+}
+
+function checkPaths(file, data) {
+  fs.stat(file, common.mustCall((err, stats) => {
+    assert.ifError(err);
+    assert.strictEqual(stats.size, data.length);
+  }));
+  fs.lstat(tmpdir.path, common.mustCall((err, stats) => {
+    assert.ifError(err);
+    assert.ok(stats.isDirectory());
+  }));
+  fs.stat(`${file}.missing`, common.mustCall((err) => {
+    assert.strictEqual(err.code, 'ENOENT');
+  }));
+  fs.open(`${file}.missing`, 'r', common.mustCall((err) => {
+    assert.strictEqual(err.code, 'ENOENT');
+  }));
+  fs.readFile(file, common.mustCall((err, contents) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(contents, data);
+  }));
+}
+
+tmpdir.refresh();
+
+for (const value of ['1', '0']) {
+  const env = Object.assign({}, process.env, { UV_USE_IO_URING: value });
+  const child = spawnSync(process.execPath, [__filename, 'child'],
+                          { env, encoding: 'utf8' });
+  assert.strictEqual(child.status, 0,
+                     `UV_USE_IO_URING=${value}\n${child.stderr}`);
+}
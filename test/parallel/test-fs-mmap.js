@@ -0,0 +1,119 @@
+'use strict';
+// fs.mmap() returns a Buffer that is backed by a mapping of the file.
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const { kMaxLength } = require('buffer');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const filename = path.join(tmpdir.path, 'mmap.bin');
+const content = Buffer.alloc(3 * 65536 + 123);
+for (let i = 0; i < content.length; i++)
+  content[i] = i * 7 % 256;
+fs.writeFileSync(filename, content);
+
+const fd = fs.openSync(filename, 'r');
+
+// The whole file.
+assert.deepStrictEqual(fs.mmap(fd), content);
+
+// Offsets do not have to be aligned to pages.
+for (const offset of [1, 4095, 4096, 65537]) {
+  const buffer = fs.mmap(fd, offset, 1000);
+  assert.strictEqual(buffer.length, 1000);
+  assert.deepStrictEqual(buffer, content.slice(offset, offset + 1000));
+  assert.deepStrictEqual(fs.mmap(fd, offset),
+                         content.slice(offset));
+}
+
+// Hints do not change the contents.
+assert.deepStrictEqual(
+  fs.mmap(fd, 0, undefined, { populate: true, hugepages: true }), content);
+for (const advice of ['normal', 'random', 'sequential', 'willneed'])
+  assert.deepStrictEqual(fs.mmap(fd, 0, undefined, { advice }), content);
+
+// Empty ranges.
+assert.strictEqual(fs.mmap(fd, 0, 0).length, 0);
+assert.strictEqual(fs.mmap(fd, content.length).length, 0);
+
+// Mapping past the end of a regular file would raise SIGBUS on access.
+[
+  [0, content.length + 1],
+  [1, content.length],
+  [content.length, 1],
+  [content.length + 4096, 1]
+].forEach(([offset, length]) => {
+  common.expectsError(() => fs.mmap(fd, offset, length), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "offset + length" is out of range. ' +
+             `It must be <= ${content.length}. Received ${offset + length}`
+  });
+});
+
+// Read-only mappings are private, writes do not reach the file.
+{
+  const buffer = fs.mmap(fd, 0, 16);
+  buffer.fill(0xff);
+  assert.deepStrictEqual(fs.readFileSync(filename), content);
+}
+
+// The mapping outlives the file descriptor.
+const mapped = fs.mmap(fd);
+fs.closeSync(fd);
+assert.deepStrictEqual(mapped, content);
+
+// Writable mappings are shared with the file.
+{
+  const rw = fs.openSync(filename, 'r+');
+  const buffer = fs.mmap(rw, 4, 4, { readonly: false });
+  buffer.write('mmap');
+  fs.closeSync(rw);
+  assert.strictEqual(fs.readFileSync(filename, 'latin1').slice(4, 8), 'mmap');
+}
+
+// A read-only file descriptor can not be mapped for writing.
+if (!common.isWindows) {
+  const ro = fs.openSync(filename, 'r');
+  common.expectsError(() => fs.mmap(ro, 0, 16, { readonly: false }), {
+    code: 'EACCES',
+    type: Error
+  });
+  fs.closeSync(ro);
+}
+
+common.expectsError(() => fs.mmap(-1), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
+common.expectsError(() => fs.mmap(0, '0'), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
+[-1, 1.5, Infinity].forEach((offset) => {
+  common.expectsError(() => fs.mmap(0, offset, 1), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+});
+[-1, 1.5, kMaxLength + 1].forEach((length) => {
+  common.expectsError(() => fs.mmap(0, 0, length), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+});
+[
+  { readonly: 1 },
+  { populate: 'yes' },
+  { hugepages: null },
+  { advice: 'sometimes' }
+].forEach((options) => {
+  common.expectsError(() => fs.mmap(0, 0, 1, options), {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: TypeError
+  });
+});
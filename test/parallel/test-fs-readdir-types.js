@@ -0,0 +1,69 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const readdirDir = path.join(tmpdir.path, 'readdir-types');
+fs.mkdirSync(readdirDir);
+fs.mkdirSync(path.join(readdirDir, 'dir'));
+fs.writeFileSync(path.join(readdirDir, 'file'), 'file');
+
+const expected = {
+  dir: 'isDirectory',
+  file: 'isFile'
+};
+
+if (common.canCreateSymLink()) {
+  fs.symlinkSync('file', path.join(readdirDir, 'link'));
+  expected.link = 'isSymbolicLink';
+}
+
+function assertDirents(dirents) {
+  assert.deepStrictEqual(dirents.map((dirent) => dirent.name).sort(),
+                         Object.keys(expected));
+  for (const dirent of dirents) {
+    assert.ok(dirent instanceof fs.Dirent);
+    for (const method of ['isBlockDevice', 'isCharacterDevice', 'isDirectory',
+                          'isFIFO', 'isFile', 'isSocket', 'isSymbolicLink']) {
+      assert.strictEqual(dirent[method](), method === expected[dirent.name],
+                         `${dirent.name}.${method}()`);
+    }
+  }
+}
+
+// Without the option, only the names are returned.
+assert.deepStrictEqual(fs.readdirSync(readdirDir).sort(),
+                       Object.keys(expected));
+
+assertDirents(fs.readdirSync(readdirDir, { withFileTypes: true }));
+
+fs.readdir(readdirDir, { withFileTypes: true },
+           common.mustCall((err, dirents) => {
+             assert.ifError(err);
+             assertDirents(dirents);
+           }));
+
+// The encoding applies to the names.
+{
+  const dirents = fs.readdirSync(readdirDir, {
+    withFileTypes: true,
+    encoding: 'buffer'
+  });
+  assert.ok(dirents.every((dirent) => Buffer.isBuffer(dirent.name)));
+}
+
+// Errors are reported as before.
+common.expectsError(() => {
+  fs.readdirSync(path.join(readdirDir, 'file'), { withFileTypes: true });
+}, {
+  code: 'ENOTDIR'
+});
+fs.readdir(path.join(readdirDir, 'missing'), { withFileTypes: true },
+           common.mustCall((err) => {
+             assert.strictEqual(err.code, 'ENOENT');
+           }));
@@ -0,0 +1,99 @@
+'use strict';
+// fs.readFile() opens, reads and closes the file in a single threadpool job
+// and completes with the whole contents at once.
+
+const common = require('../common');
+const assert = require('assert');
+const async_hooks = require('async_hooks');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const expected = Buffer.from('readFile äöü '.repeat(10000));
+const file = path.join(tmpdir.path, 'readfile-single-job.txt');
+fs.writeFileSync(file, expected);
+
+// Only one request per call. The other cases run once this one is done, so
+// that their requests are not counted.
+{
+  let requests = 0;
+  const hook = async_hooks.createHook({
+    init: common.mustCallAtLeast((id, type) => {
+      if (type === 'FSREQWRAP')
+        requests++;
+    })
+  }).enable();
+
+  fs.readFile(file, common.mustCall((err, data) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(data, expected);
+    hook.disable();
+    assert.strictEqual(requests, 1);
+    testEncodings();
+    testEmptyFiles();
+    testFd();
+    testErrors();
+  }));
+}
+
+function testEncodings() {
+  ['utf8', 'latin1', 'hex', 'base64', 'ucs2'].forEach((encoding) => {
+    fs.readFile(file, encoding, common.mustCall((err, data) => {
+      assert.ifError(err);
+      assert.strictEqual(data, expected.toString(encoding));
+    }));
+  });
+}
+
+function testEmptyFiles() {
+  const empty = path.join(tmpdir.path, 'readfile-empty.txt');
+  fs.writeFileSync(empty, '');
+  fs.readFile(empty, common.mustCall((err, data) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(data, Buffer.alloc(0));
+  }));
+  fs.readFile(empty, 'utf8', common.mustCall((err, data) => {
+    assert.ifError(err);
+    assert.strictEqual(data, '');
+  }));
+
+  // Files for which fstat() reports no size are read until EOF.
+  if (common.isLinux) {
+    fs.readFile('/proc/self/status', 'utf8', common.mustCall((err, data) => {
+      assert.ifError(err);
+      assert.ok(data.startsWith('Name:'));
+    }));
+  }
+}
+
+// A file descriptor is read from its current position and stays open.
+function testFd() {
+  const fd = fs.openSync(file, 'r');
+  fs.readSync(fd, Buffer.alloc(100), 0, 100, null);
+  fs.readFile(fd, common.mustCall((err, data) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(data, expected.slice(100));
+    fs.fstatSync(fd);
+    fs.closeSync(fd);
+  }));
+}
+
+// Errors name the step that failed.
+function testErrors() {
+  const missing = path.join(tmpdir.path, 'does-not-exist');
+  fs.readFile(missing, common.mustCall((err, data) => {
+    assert.strictEqual(err.code, 'ENOENT');
+    assert.strictEqual(err.syscall, 'open');
+    assert.strictEqual(err.path, missing);
+    assert.strictEqual(data, undefined);
+  }));
+
+  if (!common.isWindows && !common.isFreeBSD) {
+    fs.readFile(tmpdir.path, common.mustCall((err) => {
+      assert.strictEqual(err.code, 'EISDIR');
+      assert.strictEqual(err.syscall, 'read');
+    }));
+  }
+}
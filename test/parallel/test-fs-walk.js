@@ -0,0 +1,129 @@
+'use strict';
+// fs.walk() lists a directory tree in batches of fs.Dirent objects.
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const root = path.join(tmpdir.path, 'walk');
+const dirs = ['b', 'b/c', 'b/c/d', 'node_modules', 'node_modules/m'];
+const files = ['a.txt', 'b/b.txt', 'b/c/c.txt', 'b/c/d/d.txt',
+               'node_modules/m/index.js'];
+
+fs.mkdirSync(root);
+for (const dir of dirs)
+  fs.mkdirSync(path.join(root, dir));
+for (const file of files)
+  fs.writeFileSync(path.join(root, file), file);
+
+function collect(options, callback) {
+  const entries = [];
+  fs.walk(root, options)
+    .on('data', (batch) => {
+      assert.ok(Array.isArray(batch));
+      assert.ok(batch.length > 0);
+      for (const entry of batch) {
+        assert.ok(entry instanceof fs.Dirent);
+        assert.strictEqual(path.basename(entry.path), entry.name);
+        entries.push(entry);
+      }
+    })
+    .on('end', common.mustCall(() => callback(entries)));
+}
+
+function relative(entries) {
+  return entries.map((entry) => path.relative(root, entry.path)
+                                    .split(path.sep).join('/')).sort();
+}
+
+collect({}, (entries) => {
+  assert.deepStrictEqual(relative(entries), dirs.concat(files).sort());
+  for (const entry of entries) {
+    assert.strictEqual(entry.isDirectory(),
+                       dirs.includes(relative([entry])[0]));
+    assert.strictEqual(entry.stats, undefined);
+  }
+});
+
+// Filtered directories are not descended into.
+collect({ filter: (entry) => entry.name !== 'node_modules' }, (entries) => {
+  assert.deepStrictEqual(relative(entries),
+                         ['a.txt', 'b', 'b/b.txt', 'b/c', 'b/c/c.txt', 'b/c/d',
+                          'b/c/d/d.txt']);
+});
+
+collect({ maxDepth: 0 }, (entries) => {
+  assert.deepStrictEqual(relative(entries), ['a.txt', 'b', 'node_modules']);
+});
+
+collect({ maxDepth: 1 }, (entries) => {
+  assert.deepStrictEqual(relative(entries),
+                         ['a.txt', 'b', 'b/b.txt', 'b/c', 'node_modules',
+                          'node_modules/m']);
+});
+
+collect({ stats: true }, (entries) => {
+  for (const entry of entries) {
+    assert.ok(entry.stats instanceof fs.Stats);
+    assert.strictEqual(entry.stats.isDirectory(), entry.isDirectory());
+    if (entry.isFile())
+      assert.strictEqual(entry.stats.size, fs.statSync(entry.path).size);
+  }
+});
+
+// Symbolic links, including one that forms a cycle.
+if (common.canCreateSymLink()) {
+  const linkRoot = path.join(tmpdir.path, 'walk-links');
+  fs.mkdirSync(linkRoot);
+  fs.symlinkSync(root, path.join(linkRoot, 'tree'), 'dir');
+  fs.symlinkSync(linkRoot, path.join(linkRoot, 'cycle'), 'dir');
+
+  const walkLinks = (options, callback) => {
+    const entries = [];
+    fs.walk(linkRoot, options)
+      .on('data', (batch) => entries.push(...batch))
+      .on('end', common.mustCall(() => {
+        callback(entries.map((entry) => path.relative(linkRoot, entry.path)));
+      }));
+  };
+
+  walkLinks({}, (paths) => {
+    assert.deepStrictEqual(paths.sort(), ['cycle', 'tree']);
+  });
+
+  walkLinks({ followSymlinks: true }, (paths) => {
+    assert.ok(paths.includes(path.join('tree', 'b', 'c', 'd', 'd.txt')));
+    // The cycle is entered once and then recognized.
+    assert.ok(paths.length < 2 * (dirs.length + files.length) + 4);
+  });
+}
+
+// Errors.
+fs.walk(path.join(tmpdir.path, 'missing'))
+  .on('data', common.mustNotCall())
+  .on('error', common.mustCall((err) => {
+    assert.strictEqual(err.code, 'ENOENT');
+    assert.strictEqual(err.syscall, 'scandir');
+  }));
+
+fs.walk(root, { filter: () => { throw new Error('filter'); } })
+  .on('data', common.mustNotCall())
+  .on('error', common.mustCall((err) => {
+    assert.strictEqual(err.message, 'filter');
+  }));
+
+common.expectsError(() => fs.walk(root, { filter: 'a' }), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
+
+[-1, 1.5, '1'].forEach((maxDepth) => {
+  common.expectsError(() => fs.walk(root, { maxDepth }), {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: RangeError
+  });
+});
@@ -0,0 +1,95 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const { OutgoingMessage } = require('http');
+const { outHeadersKey } = require('internal/http');
+
+// The header block is serialized natively, check that it matches what the
+// JS implementation used to produce for the different kinds of input.
+
+const firstLine = 'HTTP/1.1 200 OK\r\n';
+
+function storeHeader(headers) {
+  const msg = new OutgoingMessage();
+  msg._storeHeader(firstLine, headers);
+  return msg;
+}
+
+{
+  const msg = storeHeader({
+    'Content-Length': 2,
+    'X-List': ['a', 'b'],
+    'Cookie': ['c=1', 'd=2'],
+    'Connection': 'close',
+    'X-Latin1': 'Düsseldorf'
+  });
+  assert.strictEqual(msg._header,
+                     `${firstLine}Content-Length: 2\r\n` +
+                     'X-List: a\r\nX-List: b\r\n' +
+                     'Cookie: c=1; d=2\r\n' +
+                     'Connection: close\r\n' +
+                     'X-Latin1: Düsseldorf\r\n\r\n');
+  assert.strictEqual(msg._last, true);
+  assert.strictEqual(msg.chunkedEncoding, false);
+}
+
+{
+  const msg = storeHeader([
+    ['Transfer-Encoding', 'chunked'],
+    ['X-Array', ['1', '2']]
+  ]);
+  assert.strictEqual(msg._header,
+                     `${firstLine}Transfer-Encoding: chunked\r\n` +
+                     'X-Array: 1\r\nX-Array: 2\r\n' +
+                     'Connection: keep-alive\r\n\r\n');
+  assert.strictEqual(msg.chunkedEncoding, true);
+}
+
+{
+  // Headers from setHeader() are not validated again.
+  const msg = new OutgoingMessage();
+  msg.setHeader('Content-Length', 0);
+  msg.setHeader('X-Number', 42);
+  msg._storeHeader(firstLine, msg[outHeadersKey]);
+  assert.strictEqual(msg._header,
+                     `${firstLine}Content-Length: 0\r\n` +
+                     'X-Number: 42\r\n' +
+                     'Connection: keep-alive\r\n\r\n');
+}
+
+{
+  // Header blocks that outgrow the initial buffer keep their start.
+  const long = 'x'.repeat(5000);
+  const fields = {};
+  for (let i = 0; i < 200; i++)
+    fields[`X-Field-${i}`] = `value-${i}`;
+  const msg = storeHeader(Object.assign({ 'Content-Length': 0 }, fields,
+                                        { 'X-Long': long }));
+  let expected = `${firstLine}Content-Length: 0\r\n`;
+  for (let i = 0; i < 200; i++)
+    expected += `X-Field-${i}: value-${i}\r\n`;
+  expected += `X-Long: ${long}\r\nConnection: keep-alive\r\n\r\n`;
+  assert.ok(msg._header.length > 8192);
+  assert.strictEqual(msg._header, expected);
+}
+
+common.expectsError(() => storeHeader({ 'bad name': 'x' }), {
+  code: 'ERR_INVALID_HTTP_TOKEN',
+  type: TypeError
+});
+
+common.expectsError(() => storeHeader({ 'X-Value': undefined }), {
+  code: 'ERR_HTTP_INVALID_HEADER_VALUE',
+  type: TypeError
+});
+
+common.expectsError(() => storeHeader([['X-Value', 'a\r\nb']]), {
+  code: 'ERR_INVALID_CHAR',
+  type: TypeError
+});
+
+common.expectsError(() => storeHeader({ 'X-Value': 'Ā' }), {
+  code: 'ERR_INVALID_CHAR',
+  type: TypeError
+});
@@ -0,0 +1,50 @@
+'use strict';
+// Common header names and values are served from a per-isolate table of
+// internalized strings. Check that lookups only hit on exact matches, so the
+// headers reach JS exactly as they were sent, also when they are split across
+// several reads.
+
+const { mustCall } = require('../common');
+const assert = require('assert');
+
+const { HTTPParser } = process.binding('http_parser');
+const kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+
+const expected = [
+  'Host', 'localhost',
+  'host', 'localhost',
+  'HOST', 'localhost',
+  'hOsT', 'localhost',
+  'Connection', 'keep-alive',
+  'connection', 'Keep-Alive',
+  'CONNECTION', 'KEEP-ALIVE',
+  'Accept-Encoding', 'gzip, deflate',
+  'Accept-Encoding', 'gzip, deflat',
+  'Accept-Encodin', 'gzip',
+  'Accept-Encodingg', 'gzip',
+  'Content-Length', '0',
+  'X-Custom', 'Upgrade',
+  'Upgrade', 'x'
+];
+
+let request = 'GET / HTTP/1.1\r\n';
+for (let i = 0; i < expected.length; i += 2)
+  request += `${expected[i]}: ${expected[i + 1]}\r\n`;
+request += '\r\n';
+
+function check(chunkSize) {
+  const parser = new HTTPParser(HTTPParser.REQUEST);
+  parser[kOnHeadersComplete] = mustCall((versionMajor, versionMinor,
+                                         headers) => {
+    assert.deepStrictEqual(headers, expected);
+  });
+
+  for (let i = 0; i < request.length; i += chunkSize) {
+    const chunk = Buffer.from(request.slice(i, i + chunkSize));
+    parser.execute(chunk, 0, chunk.length);
+  }
+}
+
+// Twice each, the second run is served from the already populated table.
+for (const chunkSize of [request.length, request.length, 3, 3])
+  check(chunkSize);
@@ -254,8 +254,7 @@ function expectBody(expected) {
     assert.strictEqual(versionMajor, 1);
     assert.strictEqual(versionMinor, 0);
 
-    headers = headers || parser.headers;
-
+    // All headers arrive in one go, no matter how many there are.
     assert.strictEqual(headers.length, 2 * 256); // 256 key/value pairs
     for (let i = 0; i < headers.length; i += 2) {
       assert.strictEqual(headers[i], 'X-Filler');
@@ -264,8 +263,45 @@ function expectBody(expected) {
   };
 
   const parser = newParser(REQUEST);
+  parser[kOnHeaders] = mustNotCall();
   parser[kOnHeadersComplete] = mustCall(onHeadersComplete);
   parser.execute(request, 0, request.length);
+
+  // Same with the headers split over several reads, which makes the parser
+  // copy the pending strings before the input buffer goes away.
+  const split = newParser(REQUEST);
+  split[kOnHeaders] = mustNotCall();
+  split[kOnHeadersComplete] = mustCall(onHeadersComplete);
+  for (let i = 0; i < request.length; i += 1000) {
+    const chunk = Buffer.from(request.slice(i, i + 1000));
+    split.execute(chunk, 0, chunk.length);
+  }
+}
+
+
+//
+// Long URL and header value that arrive one byte per read, which makes the
+// parser append to the saved copies over and over.
+//
+{
+  const url = `/${'u'.repeat(16 * 1024)}`;
+  const value = 'v'.repeat(16 * 1024);
+  const request = Buffer.from(
+    `GET ${url} HTTP/1.1\r\n` +
+    `X-Long: ${value}\r\n` +
+    '\r\n');
+
+  const onHeadersComplete = (versionMajor, versionMinor, headers,
+                             method, url_) => {
+    assert.strictEqual(method, methods.indexOf('GET'));
+    assert.strictEqual(url_, url);
+    assert.deepStrictEqual(headers, ['X-Long', value]);
+  };
+
+  const parser = newParser(REQUEST);
+  parser[kOnHeadersComplete] = mustCall(onHeadersComplete);
+  for (let i = 0; i < request.length; i++)
+    parser.execute(request.slice(i, i + 1), 0, 1);
 }
 
 
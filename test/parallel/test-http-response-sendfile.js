@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const http = require('http');
+const fixtures = require('../common/fixtures');
+
+const file = fixtures.path('elipses.txt');
+const contents = fs.readFileSync(file);
+const fd = fs.openSync(file, 'r');
+
+// The first response has a Content-Length, the second one uses chunked
+// encoding, the file has to be framed like any other chunk there.
+const server = http.createServer(common.mustCall((req, res) => {
+  common.expectsError(() => res.sendFile(fd, 0), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+
+  if (req.url === '/length')
+    res.setHeader('Content-Length', contents.length + 6);
+  res.write('start:');
+  res.sendFile(fd, 0, contents.length, common.mustCall());
+  res.end();
+}, 2));
+
+function get(path, cb) {
+  http.get({ port: server.address().port, path }, common.mustCall((res) => {
+    const chunks = [];
+    res.on('data', (chunk) => chunks.push(chunk));
+    res.on('end', common.mustCall(() => cb(res, Buffer.concat(chunks))));
+  }));
+}
+
+server.listen(0, common.mustCall(() => {
+  const expected = Buffer.concat([Buffer.from('start:'), contents]);
+
+  get('/length', (res, body) => {
+    assert.strictEqual(res.headers['content-length'], `${expected.length}`);
+    assert.deepStrictEqual(body, expected);
+
+    get('/chunked', (res, body) => {
+      assert.strictEqual(res.headers['transfer-encoding'], 'chunked');
+      assert.deepStrictEqual(body, expected);
+      server.close();
+      fs.closeSync(fd);
+    });
+  });
+}));
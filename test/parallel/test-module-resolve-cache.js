@@ -0,0 +1,166 @@
+'use strict';
+// With NODE_MODULE_RESOLVE_CACHE, the filenames that require() resolved to
+// are saved on exit and reused by later processes for as long as the
+// directories that were searched did not change.
+
+const common = require('../common');
+const assert = require('assert');
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+const binding = process.binding('fs');
+
+tmpdir.refresh();
+
+// internalModuleProbe() returns the index of the first extension that names
+// a file.
+{
+  const base = path.join(tmpdir.path, 'probe');
+  fs.writeFileSync(`${base}.json`, '{}');
+  assert.strictEqual(binding.internalModuleProbe(base, ['.js', '.json']), 1);
+  assert.strictEqual(binding.internalModuleProbe(base, ['.js', '.node']), -1);
+  assert.strictEqual(binding.internalModuleProbe(base, []), -1);
+}
+
+const cacheFile = path.join(tmpdir.path, 'resolve-cache');
+const appDir = path.join(tmpdir.path, 'app');
+const depDir = path.join(appDir, 'node_modules', 'dep');
+fs.mkdirSync(appDir);
+fs.mkdirSync(path.dirname(depDir));
+fs.mkdirSync(depDir);
+fs.writeFileSync(path.join(depDir, 'package.json'),
+                 JSON.stringify({ main: 'lib' }));
+fs.writeFileSync(path.join(depDir, 'lib.json'), '"json"');
+fs.writeFileSync(path.join(appDir, 'helper.js'),
+                 'module.exports = require("dep");');
+fs.writeFileSync(path.join(appDir, 'main.js'), `
+  const stats = new Float64Array(5);
+  const value = require('./helper');
+  process.binding('fs').getModuleResolveCacheStats(stats);
+  console.log(JSON.stringify({ value, hits: stats[0], stale: stats[2] }));
+`);
+
+function run() {
+  const env = Object.assign({}, process.env,
+                            { NODE_MODULE_RESOLVE_CACHE: cacheFile });
+  const out = execFileSync(process.execPath, [path.join(appDir, 'main.js')],
+                           { env, encoding: 'utf8' });
+  return JSON.parse(out);
+}
+
+{
+  const result = run();
+  assert.strictEqual(result.value, 'json');
+  assert.strictEqual(result.hits, 0);
+  assert.ok(fs.existsSync(cacheFile));
+}
+
+{
+  const result = run();
+  assert.strictEqual(result.value, 'json');
+  assert.ok(result.hits > 0);
+}
+
+// A file that takes precedence appears in a directory that was searched; the
+// cached entry for 'dep' must not be used anymore. Make sure the mtime of the
+// directory changes even on file systems with a coarse resolution.
+fs.writeFileSync(path.join(depDir, 'lib.js'), 'module.exports = "js";');
+const future = new Date(Date.now() + 10000);
+fs.utimesSync(depDir, future, future);
+{
+  const result = run();
+  assert.strictEqual(result.value, 'js');
+  assert.ok(result.stale > 0);
+}
+
+// A deploy that points a symbolic link at a new release and preserves the
+// mtimes. The searched directories are the same paths, but not the same
+// directories anymore.
+if (common.canCreateSymLink()) {
+  const symlinkApp = path.join(tmpdir.path, 'symlink-app');
+  const current = path.join(symlinkApp, 'node_modules', 'dep');
+  const mtime = new Date(2000, 0, 1);
+  const releases = ['release-1', 'release-2'].map((name) => {
+    const dir = path.join(tmpdir.path, name);
+    fs.mkdirSync(dir);
+    fs.writeFileSync(path.join(dir, 'index.json'), JSON.stringify(name));
+    if (name === 'release-2')
+      fs.writeFileSync(path.join(dir, 'index.js'), 'module.exports = 2;');
+    fs.utimesSync(dir, mtime, mtime);
+    return dir;
+  });
+  fs.mkdirSync(symlinkApp);
+  fs.mkdirSync(path.dirname(current));
+  fs.symlinkSync(releases[0], current, 'dir');
+  fs.writeFileSync(path.join(symlinkApp, 'main.js'), `
+    const stats = new Float64Array(5);
+    const value = require('dep');
+    process.binding('fs').getModuleResolveCacheStats(stats);
+    console.log(JSON.stringify({ value, hits: stats[0], stale: stats[2] }));
+  `);
+  const runSymlinkApp = () => {
+    const env = Object.assign({}, process.env,
+                              { NODE_MODULE_RESOLVE_CACHE: cacheFile });
+    const out = execFileSync(process.execPath,
+                             [path.join(symlinkApp, 'main.js')],
+                             { env, encoding: 'utf8' });
+    return JSON.parse(out);
+  };
+
+  fs.utimesSync(path.dirname(current), mtime, mtime);
+  assert.strictEqual(runSymlinkApp().value, 'release-1');
+  assert.ok(runSymlinkApp().hits > 0);
+
+  const next = `${current}.next`;
+  fs.symlinkSync(releases[1], next, 'dir');
+  fs.renameSync(next, current);
+  fs.utimesSync(path.dirname(current), mtime, mtime);
+  const result = runSymlinkApp();
+  assert.strictEqual(result.value, 2);
+  assert.ok(result.stale > 0);
+}
+
+// A package.json is a dependency of every resolution that goes through it,
+// including the ones that only find its "main" in the cache of the process.
+{
+  const pkgApp = path.join(tmpdir.path, 'pkg-app');
+  const pkgDir = path.join(pkgApp, 'node_modules', 'pkg');
+  const pkgJSON = path.join(pkgDir, 'package.json');
+  fs.mkdirSync(pkgApp);
+  fs.mkdirSync(path.dirname(pkgDir));
+  fs.mkdirSync(pkgDir);
+  fs.mkdirSync(path.join(pkgApp, 'sub'));
+  fs.writeFileSync(pkgJSON, JSON.stringify({ main: 'first' }));
+  fs.writeFileSync(path.join(pkgDir, 'first.json'), '"first"');
+  fs.writeFileSync(path.join(pkgDir, 'second.json'), '"second"');
+  // Resolved from another directory, so it is a separate resolution.
+  fs.writeFileSync(path.join(pkgApp, 'sub', 'helper.js'),
+                   'module.exports = require("pkg");');
+  fs.writeFileSync(path.join(pkgApp, 'main.js'), `
+    const values = [require('pkg'), require('./sub/helper')];
+    console.log(JSON.stringify(values));
+  `);
+  const runPkgApp = () => {
+    const env = Object.assign({}, process.env,
+                              { NODE_MODULE_RESOLVE_CACHE: cacheFile });
+    const out = execFileSync(process.execPath, [path.join(pkgApp, 'main.js')],
+                             { env, encoding: 'utf8' });
+    return JSON.parse(out);
+  };
+
+  assert.deepStrictEqual(runPkgApp(), ['first', 'first']);
+  assert.deepStrictEqual(runPkgApp(), ['first', 'first']);
+
+  // Rewritten in place, the directory does not change.
+  fs.writeFileSync(pkgJSON, JSON.stringify({ main: 'second' }));
+  const future = new Date(Date.now() + 10000);
+  fs.utimesSync(pkgJSON, future, future);
+  assert.deepStrictEqual(runPkgApp(), ['second', 'second']);
+}
+
+// A cache file that is not valid is ignored.
+fs.writeFileSync(cacheFile, 'garbage');
+assert.strictEqual(binding.moduleResolveCacheLoad(cacheFile), false);
+assert.strictEqual(run().value, 'js');
@@ -0,0 +1,90 @@
+'use strict';
+// Reads on TCP sockets and UDP sockets are served from a per-Environment
+// pool of slabs. Check that the carved Buffers do not overlap and that the
+// pool statistics are updated.
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+const net = require('net');
+
+const streamWrap = process.binding('stream_wrap');
+
+function getStats() {
+  const fields = new Float64Array(4);
+  streamWrap.getReadBufferPoolStats(fields);
+  return {
+    hits: fields[0],
+    misses: fields[1],
+    pinnedBytes: fields[2],
+    freeBytes: fields[3]
+  };
+}
+
+const before = getStats();
+const kSockets = 4;
+const kChunks = 50;
+
+const server = net.createServer(common.mustCall((socket) => {
+  const received = [];
+  socket.on('data', (chunk) => received.push(chunk));
+  socket.on('end', common.mustCall(() => {
+    const data = Buffer.concat(received);
+    assert.strictEqual(data.length, kChunks * 100);
+    // Every socket writes a single repeated byte; a Buffer that shares memory
+    // with another socket's reads would show up as a foreign byte here.
+    for (const byte of data)
+      assert.strictEqual(byte, data[0]);
+    socket.end();
+  }));
+}, kSockets));
+
+server.listen(0, common.mustCall(() => {
+  let pending = kSockets;
+  for (let i = 0; i < kSockets; i++) {
+    const client = net.connect(server.address().port, common.mustCall(() => {
+      const chunk = Buffer.alloc(100, 0x41 + i);
+      for (let j = 0; j < kChunks; j++)
+        client.write(chunk);
+      client.end();
+    }));
+    client.resume();
+    client.on('close', common.mustCall(() => {
+      if (--pending === 0) {
+        server.close();
+        testDgram();
+      }
+    }));
+  }
+}));
+
+function testDgram() {
+  const socket = dgram.createSocket('udp4');
+  const messages = ['first', 'second', 'third'];
+  const received = [];
+
+  socket.on('message', common.mustCall((msg) => {
+    received.push(msg);
+    if (received.length !== messages.length)
+      return;
+
+    assert.deepStrictEqual(received.map(String), messages);
+    socket.close();
+
+    const after = getStats();
+    assert.ok(after.hits + after.misses > before.hits + before.misses);
+    assert.ok(after.pinnedBytes >= 0);
+    assert.ok(after.freeBytes >= 0);
+  }, messages.length));
+
+  socket.bind(0, common.mustCall(() => {
+    const port = socket.address().port;
+    // Send one at a time so that the messages arrive in order.
+    (function sendNext(i) {
+      if (i === messages.length)
+        return;
+      socket.send(messages[i], port, common.localhostIPv4,
+                  common.mustCall(() => sendNext(i + 1)));
+    })(0);
+  }));
+}
@@ -0,0 +1,60 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const fixtures = require('../common/fixtures');
+
+const file = fixtures.path('elipses.txt');
+const contents = fs.readFileSync(file);
+const fd = fs.openSync(file, 'r');
+
+[-1, 1.5, 'foo', null].forEach((value) => {
+  common.expectsError(() => new net.Socket().sendFile(value), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+});
+
+[-1, 1.5, Number.MAX_VALUE].forEach((value) => {
+  common.expectsError(() => new net.Socket().sendFile(fd, value), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+  common.expectsError(() => new net.Socket().sendFile(fd, 0, value), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+});
+
+// A file range sent between two writes arrives in order, and the whole file
+// is sent when no length is given.
+const server = net.createServer(common.mustCall((socket) => {
+  socket.write('head:');
+  socket.sendFile(fd, 10, 100, common.mustCall());
+  socket.write(':middle:');
+  socket.sendFile(fd, common.mustCall(() => {
+    assert.strictEqual(socket.bytesWritten,
+                       'head::middle::tail'.length + 100 + contents.length);
+  }));
+  socket.end(':tail');
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  const chunks = [];
+  client.on('data', (chunk) => chunks.push(chunk));
+  client.on('end', common.mustCall(() => {
+    const expected = Buffer.concat([
+      Buffer.from('head:'),
+      contents.slice(10, 110),
+      Buffer.from(':middle:'),
+      contents,
+      Buffer.from(':tail')
+    ]);
+    assert.deepStrictEqual(Buffer.concat(chunks), expected);
+    server.close();
+  }));
+}));
+
+process.on('exit', () => fs.closeSync(fd));
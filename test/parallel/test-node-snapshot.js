@@ -0,0 +1,42 @@
+'use strict';
+// Core modules that were compiled into the startup snapshot must behave like
+// the ones that are compiled when node starts with --no-node-snapshot.
+
+require('../common');
+const assert = require('assert');
+const { execFileSync } = require('child_process');
+
+const script = `
+  const fs = require('fs');
+  let stack;
+  try {
+    fs.readFileSync('/does/not/exist', 'not-an-encoding');
+  } catch (err) {
+    stack = err.stack.split('\\n').slice(1, 3).join('\\n');
+  }
+  console.log(JSON.stringify({
+    stack,
+    modules: process.moduleLoadList.filter((m) => m.startsWith('NativeModule')),
+    wrapped: require('util').inspect(fs.readFileSync)
+  }));
+`;
+
+function run(execArgv) {
+  const out = execFileSync(process.execPath, execArgv.concat(['-e', script]),
+                           { encoding: 'utf8' });
+  return JSON.parse(out);
+}
+
+const withSnapshot = run([]);
+const withoutSnapshot = run(['--no-node-snapshot']);
+assert.deepStrictEqual(withSnapshot, withoutSnapshot);
+assert.ok(/\(fs\.js:\d+:\d+\)/.test(withSnapshot.stack), withSnapshot.stack);
+
+// The option is allowed in NODE_OPTIONS.
+{
+  const env = Object.assign({}, process.env,
+                            { NODE_OPTIONS: '--no-node-snapshot' });
+  const out = execFileSync(process.execPath, ['-p', '1 + 1'],
+                           { env, encoding: 'utf8' });
+  assert.strictEqual(out.trim(), '2');
+}
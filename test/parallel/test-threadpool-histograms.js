@@ -0,0 +1,124 @@
+'use strict';
+// Every threadpool job is recorded in per-type histograms of its wait time,
+// run time and the depth of the queue it was added to.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+const dns = require('dns');
+const fs = require('fs');
+const zlib = require('zlib');
+
+const {
+  threadpoolJobTypes,
+  threadpoolHistograms,
+  kThreadpoolHistogramCount,
+  kThreadpoolHistogramBuckets,
+  kThreadpoolHistogramLength,
+  kThreadpoolSubBuckets
+} = process.binding('uv');
+
+assert.deepStrictEqual(threadpoolJobTypes,
+                       ['fs', 'zlib', 'pbkdf2', 'randomBytes', 'dns', 'napi',
+                        'tlsHandshake']);
+assert.strictEqual(threadpoolHistograms.length,
+                   threadpoolJobTypes.length * kThreadpoolHistogramCount *
+                   kThreadpoolHistogramLength);
+
+const histogramNames = ['waitTime', 'runTime', 'queueDepth'];
+
+// The lowest value that is counted in bucket `index`.
+function bucketStart(index) {
+  if (index < 2 * kThreadpoolSubBuckets)
+    return index;
+  const shift = Math.floor(index / kThreadpoolSubBuckets) - 1;
+  return (index % kThreadpoolSubBuckets + kThreadpoolSubBuckets) * 2 ** shift;
+}
+
+function getHistogram(type, name) {
+  const offset = (threadpoolJobTypes.indexOf(type) * kThreadpoolHistogramCount +
+                  histogramNames.indexOf(name)) * kThreadpoolHistogramLength;
+  const fields = threadpoolHistograms.slice(
+    offset, offset + kThreadpoolHistogramLength);
+  return {
+    total: fields[0],
+    min: fields[1],
+    max: fields[2],
+    sum: fields[3],
+    buckets: fields.slice(kThreadpoolHistogramBuckets)
+  };
+}
+
+function checkHistogram(type, name, minTotal) {
+  const { total, min, max, sum, buckets } = getHistogram(type, name);
+  assert.ok(total >= minTotal, `${type} ${name}: ${total} < ${minTotal}`);
+  assert.strictEqual(buckets.reduce((a, b) => a + b, 0), total);
+  assert.ok(min >= 0);
+  assert.ok(min <= max);
+  assert.ok(sum >= max);
+
+  // The values are in the buckets between min and max.
+  let first = -1;
+  let last = -1;
+  buckets.forEach((count, index) => {
+    if (count === 0)
+      return;
+    if (first === -1)
+      first = index;
+    last = index;
+  });
+  assert.ok(bucketStart(first) <= min);
+  assert.ok(bucketStart(first + 1) > min);
+  assert.ok(bucketStart(last) <= max);
+  if (last < buckets.length - 1)
+    assert.ok(bucketStart(last + 1) > max);
+}
+
+// Bucket boundaries are increasing and a power of two apart every
+// kThreadpoolSubBuckets buckets.
+for (let i = 1; i < kThreadpoolHistogramLength - kThreadpoolHistogramBuckets;
+  i++) {
+  assert.ok(bucketStart(i) > bucketStart(i - 1));
+  if (i >= 2 * kThreadpoolSubBuckets) {
+    assert.strictEqual(bucketStart(i),
+                       2 * bucketStart(i - kThreadpoolSubBuckets));
+  }
+}
+
+const before = {};
+for (const type of threadpoolJobTypes)
+  before[type] = getHistogram(type, 'runTime').total;
+
+let pending = 5;
+const done = common.mustCall(() => {
+  if (--pending > 0)
+    return;
+  for (const [type, count] of [['fs', 1],
+                               ['zlib', 1],
+                               ['pbkdf2', 4],
+                               ['randomBytes', 1],
+                               ['dns', 1]]) {
+    for (const name of histogramNames)
+      checkHistogram(type, name, before[type] + count);
+  }
+
+  // pbkdf2 jobs take at least a millisecond.
+  assert.ok(getHistogram('pbkdf2', 'runTime').max >= 1000);
+}, 5);
+
+fs.stat(__filename, common.mustCall(done));
+zlib.gzip(Buffer.alloc(64 * 1024), common.mustCall(done));
+crypto.randomBytes(16, common.mustCall(done));
+dns.lookup('localhost', common.mustCall(done));
+
+let pbkdf2Jobs = 4;
+for (let i = 0; i < 4; i++) {
+  crypto.pbkdf2('password', 'salt', 100000, 32, 'sha256',
+                common.mustCall(() => {
+                  if (--pbkdf2Jobs === 0)
+                    done();
+                }));
+}
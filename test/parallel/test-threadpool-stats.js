@@ -0,0 +1,73 @@
+'use strict';
+// Threadpool work is queued per kind, each kind with its own limit of threads
+// that may run it. fs requests are fast I/O, crypto and zlib work is CPU-bound.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+const fs = require('fs');
+
+const binding = process.binding('uv');
+const {
+  kThreadpoolStatsFieldsCount,
+  kWorkCpu,
+  kWorkFastIO,
+  kWorkSlowIO,
+  kWorkKindCount
+} = binding;
+
+assert.strictEqual(kWorkKindCount, 3);
+
+function getStats(kind) {
+  const fields = new Float64Array(kThreadpoolStatsFieldsCount * kWorkKindCount);
+  binding.getThreadpoolStats(fields);
+  const offset = kind * kThreadpoolStatsFieldsCount;
+  return {
+    maxRunning: fields[offset],
+    running: fields[offset + 1],
+    queued: fields[offset + 2],
+    completed: fields[offset + 3],
+    waitTimeTotal: fields[offset + 4],
+    waitTimeMax: fields[offset + 5]
+  };
+}
+
+// The default threadpool has four threads.
+if (!process.env.UV_THREADPOOL_SIZE) {
+  assert.strictEqual(getStats(kWorkCpu).maxRunning, 3);
+  assert.strictEqual(getStats(kWorkFastIO).maxRunning, 4);
+  assert.strictEqual(getStats(kWorkSlowIO).maxRunning, 2);
+}
+
+const cpuBefore = getStats(kWorkCpu);
+const ioBefore = getStats(kWorkFastIO);
+
+let pending = 2;
+function done() {
+  if (--pending > 0)
+    return;
+  const cpu = getStats(kWorkCpu);
+  const io = getStats(kWorkFastIO);
+  assert.ok(cpu.completed >= cpuBefore.completed + 4);
+  assert.ok(io.completed >= ioBefore.completed + 1);
+  assert.ok(cpu.waitTimeMax >= 0);
+  assert.ok(cpu.waitTimeTotal >= cpu.waitTimeMax);
+  assert.ok(cpu.running <= cpu.maxRunning);
+}
+
+// More CPU-bound jobs than CPU threads; they are spread over turns of the
+// threadpool without blocking the fs request.
+let cpuJobs = 4;
+for (let i = 0; i < 4; i++) {
+  crypto.pbkdf2('password', 'salt', 1000, 32, 'sha256', common.mustCall(() => {
+    if (--cpuJobs === 0)
+      done();
+  }));
+}
+fs.stat(__filename, common.mustCall((err) => {
+  assert.ifError(err);
+  done();
+}));
@@ -0,0 +1,74 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// With the asyncHandshake option, the server's full handshakes continue on the
+// threadpool after the ClientHello was processed. The callbacks that run
+// there, for ALPN and OCSP stapling, still see what JS set up before.
+
+const assert = require('assert');
+const tls = require('tls');
+
+const {
+  threadpoolJobTypes,
+  threadpoolHistograms,
+  kThreadpoolHistogramCount,
+  kThreadpoolHistogramLength
+} = process.binding('uv');
+
+// The number of jobs in the runTime histogram of the TLS handshakes.
+function handshakeJobs() {
+  const offset = (threadpoolJobTypes.indexOf('tlsHandshake') *
+                  kThreadpoolHistogramCount + 1) * kThreadpoolHistogramLength;
+  return threadpoolHistograms[offset];
+}
+
+const ocspResponse = Buffer.from('hello ocsp');
+const connections = 3;
+const before = handshakeJobs();
+
+const server = tls.createServer({
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  ALPNProtocols: ['a', 'b'],
+  asyncHandshake: true
+}, common.mustCall((socket) => {
+  assert.strictEqual(socket.alpnProtocol, 'b');
+  socket.on('data', (data) => socket.end(data));
+}, connections));
+
+server.on('OCSPRequest', common.mustCall((cert, issuer, callback) => {
+  setImmediate(callback, null, ocspResponse);
+}, connections));
+
+function connect(remaining) {
+  if (remaining === 0) {
+    assert.strictEqual(handshakeJobs(), before + connections);
+    server.close();
+    return;
+  }
+
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    requestOCSP: true,
+    ALPNProtocols: ['b']
+  }, common.mustCall(() => {
+    assert.strictEqual(client.alpnProtocol, 'b');
+    client.end('ping');
+  }));
+  client.on('OCSPResponse', common.mustCall((response) => {
+    assert.deepStrictEqual(response, ocspResponse);
+  }));
+  const chunks = [];
+  client.on('data', (data) => chunks.push(data));
+  client.on('end', common.mustCall(() => {
+    assert.strictEqual(Buffer.concat(chunks).toString(), 'ping');
+    connect(remaining - 1);
+  }));
+}
+
+server.listen(0, common.mustCall(() => connect(connections)));
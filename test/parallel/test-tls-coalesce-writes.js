@@ -0,0 +1,89 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// Small chunks that are written together are encrypted into as few
+// application data records as the maximum fragment size allows, unless
+// coalescing is disabled.
+
+const assert = require('assert');
+const net = require('net');
+const tls = require('tls');
+
+const chunks = 20;
+const chunkSize = 100;
+
+function noop() {}
+
+function test(serverOptions, setup, expectedRecords, cb) {
+  const server = tls.createServer(Object.assign({
+    key: fixtures.readKey('agent1-key.pem'),
+    cert: fixtures.readKey('agent1-cert.pem')
+  }, serverOptions), common.mustCall((socket) => {
+    setup(socket);
+    socket.cork();
+    for (let i = 0; i < chunks; i++)
+      socket.write(Buffer.alloc(chunkSize, i));
+    socket.uncork();
+    socket.end();
+  }));
+
+  // Counts the application data records that the server sends.
+  let records = 0;
+  const proxy = net.createServer((clientSocket) => {
+    const serverSocket = net.connect(server.address().port);
+    let pending = Buffer.alloc(0);
+    serverSocket.on('data', (data) => {
+      pending = Buffer.concat([pending, data]);
+      while (pending.length >= 5) {
+        const length = pending.readUInt16BE(3);
+        if (pending.length < 5 + length)
+          break;
+        if (pending[0] === 23)
+          records++;
+        pending = pending.slice(5 + length);
+      }
+    });
+    clientSocket.pipe(serverSocket);
+    serverSocket.pipe(clientSocket);
+  });
+
+  server.listen(0, common.mustCall(() => {
+    proxy.listen(0, common.mustCall(() => {
+      const client = tls.connect({
+        port: proxy.address().port,
+        rejectUnauthorized: false
+      });
+      let received = 0;
+      client.on('data', (data) => {
+        received += data.length;
+      });
+      client.on('end', common.mustCall(() => {
+        assert.strictEqual(received, chunks * chunkSize);
+        client.end();
+      }));
+      client.on('close', common.mustCall(() => {
+        assert.strictEqual(records, expectedRecords);
+        proxy.close();
+        server.close();
+        cb();
+      }));
+    }));
+  }));
+}
+
+test({}, noop, 1, () => {
+  // Records are no larger than the maximum fragment size.
+  test({}, (socket) => {
+    assert(socket.setMaxSendFragment(512));
+  }, 4, () => {
+    test({ coalesceWrites: false }, noop, chunks, () => {
+      test({}, (socket) => {
+        socket.setCoalesceWrites(false);
+      }, chunks, noop);
+    });
+  });
+});
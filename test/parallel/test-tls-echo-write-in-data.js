@@ -0,0 +1,63 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// An echo server that writes from its 'data' handler. Writing calls
+// SSL_write() while the records that were just decrypted are being handed to
+// JS, which must not turn the end of the input into an empty 'error'.
+
+const assert = require('assert');
+const tls = require('tls');
+
+const sizes = [1, 100, 16 * 1024, 16 * 1024 + 1, 64 * 1024, 200 * 1024];
+const total = sizes.reduce((sum, size) => sum + size, 0);
+
+const server = tls.createServer({
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem')
+}, common.mustCall((socket) => {
+  socket.on('error', common.mustNotCall());
+  socket.on('data', (data) => socket.write(data));
+  socket.on('end', common.mustCall(() => socket.end()));
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false
+  }, common.mustCall(() => {
+    let index = 0;
+    let expected = Buffer.alloc(0);
+    let received = 0;
+
+    // Send the next message once the previous one came back in full.
+    function next() {
+      const message = Buffer.alloc(sizes[index], 'a'.charCodeAt(0) + index);
+      expected = Buffer.concat([expected, message]);
+      index++;
+      client.write(message);
+    }
+
+    const chunks = [];
+    client.on('data', (data) => {
+      chunks.push(data);
+      received += data.length;
+      if (received === expected.length) {
+        if (index < sizes.length)
+          next();
+        else
+          client.end();
+      }
+    });
+    client.on('end', common.mustCall(() => {
+      assert.strictEqual(received, total);
+      assert.deepStrictEqual(Buffer.concat(chunks), expected);
+      server.close();
+    }));
+    next();
+  }));
+  client.on('error', common.mustNotCall());
+}));
@@ -0,0 +1,105 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// With the kernelTLS option, the kernel encrypts the data that the server
+// sends where it can, and OpenSSL does otherwise. The client cannot tell the
+// difference either way.
+
+const assert = require('assert');
+const tls = require('tls');
+
+const payload = Buffer.alloc(256 * 1024, 'x');
+
+function test(ciphers, cb) {
+  const server = tls.createServer({
+    key: fixtures.readKey('agent1-key.pem'),
+    cert: fixtures.readKey('agent1-cert.pem'),
+    ciphers,
+    kernelTLS: true
+  }, common.mustCall((socket) => {
+    assert.strictEqual(socket.isKernelTLS(), false);
+    socket.write('hello', common.mustCall(() => {
+      const kernelTLS = socket.isKernelTLS();
+      if (!common.isLinux || !/GCM/.test(ciphers))
+        assert.strictEqual(kernelTLS, false);
+      socket.write(payload);
+      socket.end('bye');
+    }));
+    socket.on('data', common.mustCall((data) => {
+      assert.strictEqual(data.toString(), 'ping');
+    }));
+  }));
+
+  server.listen(0, common.mustCall(() => {
+    const client = tls.connect({
+      port: server.address().port,
+      rejectUnauthorized: false
+    }, common.mustCall(() => {
+      assert.strictEqual(client.isKernelTLS(), false);
+      client.write('ping');
+    }));
+    const chunks = [];
+    client.on('data', (data) => chunks.push(data));
+    client.on('end', common.mustCall(() => {
+      const data = Buffer.concat(chunks).toString();
+      assert.strictEqual(data, `hello${payload}bye`);
+      client.end();
+      server.close(cb);
+    }));
+  }));
+}
+
+// OpenSSL cannot answer a renegotiation once the kernel encrypts, the server
+// reports that instead of an empty error.
+function testRenegotiation(cb) {
+  const server = tls.createServer({
+    key: fixtures.readKey('agent1-key.pem'),
+    cert: fixtures.readKey('agent1-cert.pem'),
+    ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+    kernelTLS: true
+  }, common.mustCall((socket) => {
+    socket.write('hello', common.mustCall(() => {
+      if (!socket.isKernelTLS()) {
+        // kTLS is not available here.
+        socket.end('user');
+        return;
+      }
+      socket.on('error', common.mustCall((err) => {
+        assert.strictEqual(err.message,
+                           'TLS renegotiation is not supported with kTLS');
+      }));
+      socket.write('kernel');
+    }));
+  }));
+
+  server.listen(0, common.mustCall(() => {
+    const client = tls.connect({
+      port: server.address().port,
+      rejectUnauthorized: false
+    });
+    let received = '';
+    client.on('data', (data) => {
+      received += data;
+      if (received === 'hellokernel')
+        client.renegotiate({}, common.mustNotCall());
+    });
+    // The server drops the connection.
+    client.on('error', () => {});
+    client.on('close', common.mustCall(() => {
+      server.close(cb);
+    }));
+  }));
+}
+
+test('ECDHE-RSA-AES128-GCM-SHA256', common.mustCall(() => {
+  test('ECDHE-RSA-AES256-GCM-SHA384', common.mustCall(() => {
+    // Not supported by the kernel, so OpenSSL keeps encrypting.
+    test('AES128-SHA', common.mustCall(() => {
+      testRenegotiation(common.mustCall());
+    }));
+  }));
+}));
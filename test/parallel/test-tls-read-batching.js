@@ -0,0 +1,45 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// Records that arrive together are decrypted into one buffer and emitted with
+// a single 'data' event, rather than one event per record.
+
+const assert = require('assert');
+const tls = require('tls');
+
+const records = 8;
+const recordSize = 1000;
+
+const server = tls.createServer({
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  coalesceWrites: false
+}, common.mustCall((socket) => {
+  socket.cork();
+  for (let i = 0; i < records; i++)
+    socket.write(Buffer.alloc(recordSize, i));
+  socket.uncork();
+  socket.end();
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false
+  });
+  const chunks = [];
+  client.on('data', (data) => chunks.push(data));
+  client.on('end', common.mustCall(() => {
+    const data = Buffer.concat(chunks);
+    assert.strictEqual(data.length, records * recordSize);
+    for (let i = 0; i < records; i++)
+      assert.strictEqual(data[i * recordSize], i);
+    assert(chunks.length < records,
+           `${records} records were emitted in ${chunks.length} chunks`);
+    server.close();
+  }));
+}));
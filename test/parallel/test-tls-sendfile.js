@@ -0,0 +1,41 @@
+'use strict';
+const common = require('../common');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// TLS sockets cannot use sendfile(2), socket.sendFile() reads the file and
+// writes it through the TLS layer instead.
+
+const assert = require('assert');
+const fs = require('fs');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+
+const file = fixtures.path('elipses.txt');
+const contents = fs.readFileSync(file);
+const fd = fs.openSync(file, 'r');
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem')
+};
+
+const server = tls.createServer(options, common.mustCall((socket) => {
+  socket.sendFile(fd, 100, common.mustCall());
+  socket.end();
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false
+  });
+  const chunks = [];
+  client.on('data', (chunk) => chunks.push(chunk));
+  client.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(chunks), contents.slice(100));
+    server.close();
+    fs.closeSync(fd);
+  }));
+}));
@@ -0,0 +1,87 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (common.isWindows)
+  common.skip('sharedSessionCache is not supported on Windows');
+
+// Two servers that use the same sharedSessionCache file resume each other's
+// sessions, as the workers of a cluster would.
+
+const assert = require('assert');
+const path = require('path');
+const tls = require('tls');
+const { SSL_OP_NO_TICKET } = require('crypto').constants;
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  // Sessions that are resumed by tickets do not use the cache.
+  secureOptions: SSL_OP_NO_TICKET,
+  sharedSessionCache: { path: path.join(tmpdir.path, 'tls-sessions') }
+};
+
+assert.strictEqual(tls.createServer({}).getSessionCacheStats(), null);
+
+common.expectsError(
+  () => tls.createServer(Object.assign({}, options, {
+    sharedSessionCache: { path: 42 }
+  })),
+  { code: 'ERR_INVALID_ARG_TYPE', type: TypeError });
+common.expectsError(
+  () => tls.createServer(Object.assign({}, options, {
+    sharedSessionCache: { path: options.sharedSessionCache.path, size: -1 }
+  })),
+  { code: 'ERR_OUT_OF_RANGE', type: RangeError });
+
+const serverA = tls.createServer(options, common.mustCall((socket) => {
+  socket.end();
+}));
+const serverB = tls.createServer(options, common.mustCall((socket) => {
+  socket.end();
+}));
+
+function connect(server, session, cb) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    session
+  }, common.mustCall(() => {
+    const reused = client.isSessionReused();
+    const session = client.getSession();
+    client.on('end', common.mustCall(() => cb(reused, session)));
+    client.resume();
+  }));
+}
+
+serverA.listen(0, common.mustCall(() => {
+  serverB.listen(0, common.mustCall(() => {
+    connect(serverA, undefined, common.mustCall((reused, session) => {
+      assert.strictEqual(reused, false);
+
+      connect(serverB, session, common.mustCall((reused) => {
+        assert.strictEqual(reused, true);
+
+        // Both servers see the counters of the file.
+        const stats = serverA.getSessionCacheStats();
+        assert.deepStrictEqual(stats, serverB.getSessionCacheStats());
+        assert.strictEqual(stats.hits, 1);
+        assert.strictEqual(stats.misses, 0);
+        assert.strictEqual(stats.stores, 1);
+        assert.strictEqual(stats.evictions, 0);
+        assert.strictEqual(stats.oversized, 0);
+        assert.strictEqual(stats.entries, 1);
+        assert(stats.capacity > 0);
+        assert.strictEqual(stats.hitRatio, 1);
+
+        serverA.close();
+        serverB.close();
+      }));
+    }));
+  }));
+}));
@@ -0,0 +1,35 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cp = require('child_process');
+const fs = require('fs');
+
+const CODE = 'require("fs").stat(__filename, () => {})';
+const FILE_NAME = 'node_trace.1.log';
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+process.chdir(tmpdir.path);
+
+const proc = cp.spawn(process.execPath,
+                      [ '--trace-events-enabled',
+                        '--trace-event-categories', 'node.threadpool',
+                        '-e', CODE ]);
+
+proc.once('exit', common.mustCall(() => {
+  assert(common.fileExists(FILE_NAME));
+  fs.readFile(FILE_NAME, common.mustCall((err, data) => {
+    const traces = JSON.parse(data.toString()).traceEvents
+      .filter((trace) => trace.pid === proc.pid &&
+                         trace.cat === 'node.threadpool' &&
+                         trace.name === 'fs');
+    // An instant event with the timing of every job.
+    assert(traces.some((trace) => {
+      return trace.ph === 'I' &&
+             trace.args.waitTime >= 0 &&
+             trace.args.runTime >= 0;
+    }));
+    // A counter with the depth of the queue the job was added to.
+    assert(traces.some((trace) => trace.ph === 'C'));
+  }));
+}));
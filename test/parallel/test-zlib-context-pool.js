@@ -0,0 +1,74 @@
+'use strict';
+// Closed zlib streams are reset and kept in a per-Environment pool, from
+// which new streams with the same parameters are initialized. A reused
+// stream must behave exactly like a new one.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const binding = process.binding('zlib');
+
+function getStats() {
+  const fields = new Float64Array(4);
+  binding.getContextPoolStats(fields);
+  return {
+    hits: fields[0],
+    misses: fields[1],
+    evictions: fields[2],
+    idle: fields[3]
+  };
+}
+
+const input = Buffer.from('hello hello hello pool '.repeat(1000));
+const dictionary = Buffer.from('hello pool');
+
+binding.setContextPoolEnabled(false);
+const expected = {
+  deflate: zlib.deflateSync(input),
+  gzip: zlib.gzipSync(input, { level: 9 }),
+  dictionary: zlib.deflateSync(input, { dictionary })
+};
+assert.strictEqual(getStats().idle, 0);
+binding.setContextPoolEnabled(true);
+
+// Each *Sync() call closes its stream, so the next one with the same
+// parameters reuses it.
+{
+  const before = getStats();
+  for (let i = 0; i < 3; i++) {
+    assert.deepStrictEqual(zlib.deflateSync(input), expected.deflate);
+    assert.deepStrictEqual(zlib.gzipSync(input, { level: 9 }), expected.gzip);
+    // A dictionary does not stick to the pooled stream.
+    assert.deepStrictEqual(zlib.deflateSync(input, { dictionary }),
+                           expected.dictionary);
+    assert.deepStrictEqual(zlib.deflateSync(input), expected.deflate);
+  }
+  const after = getStats();
+  assert.ok(after.hits >= before.hits + 9);
+  assert.ok(after.idle > 0);
+}
+
+// Streams that failed are reset before they are reused.
+assert.throws(() => zlib.inflateSync(Buffer.from('not deflate data')),
+              /incorrect header check/);
+assert.deepStrictEqual(zlib.inflateSync(expected.deflate), input);
+
+// Asynchronous streams go back to the pool when they are closed.
+zlib.gzip(input, { level: 9 }, common.mustCall((err, result) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(result, expected.gzip);
+
+  // The pool is bounded.
+  const streams = [];
+  for (let i = 0; i < 100; i++)
+    streams.push(zlib.createDeflate({ level: 1 + i % 9 }));
+  for (const stream of streams)
+    stream.close();
+  const stats = getStats();
+  assert.ok(stats.idle <= 32);
+  assert.ok(stats.evictions > 0);
+
+  binding.setContextPoolEnabled(false);
+  assert.strictEqual(getStats().idle, 0);
+}));
@@ -0,0 +1,119 @@
+'use strict';
+// Gzip streams with the `parallel` option compress blocks of the input on
+// several threads and stitch them together. The output must be a regular gzip
+// stream.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const { Z_FINISH, Z_SYNC_FLUSH } = zlib.constants;
+
+[0, -1, 1.5, 129, '4', null].forEach((parallel) => {
+  common.expectsError(() => {
+    zlib.createGzip({ parallel });
+  }, {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: RangeError
+  });
+});
+
+// Compressible input that spans a number of 128 KiB blocks.
+const input = Buffer.alloc(1024 * 1024 + 123);
+for (let i = 0; i < input.length; i++)
+  input[i] = 'abcdefgh'.charCodeAt((i * 7 + (i >> 10)) % 8);
+
+function gzipStream(opts, chunks, callback) {
+  const gzip = zlib.createGzip(opts);
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+  gzip.on('end', common.mustCall(() => {
+    callback(gzip, Buffer.concat(out));
+  }));
+  for (const chunk of chunks)
+    gzip.write(chunk);
+  gzip.end();
+}
+
+// Many small writes.
+{
+  const chunks = [];
+  for (let i = 0; i < input.length; i += 10000)
+    chunks.push(input.slice(i, i + 10000));
+
+  gzipStream({ parallel: 4 }, chunks, (gzip, result) => {
+    assert.strictEqual(gzip.bytesRead, input.length);
+    assert.strictEqual(result[0], 0x1f);
+    assert.strictEqual(result[1], 0x8b);
+    assert.deepStrictEqual(zlib.gunzipSync(result), input);
+    // Priming every block with the previous window keeps the ratio close to
+    // that of a single stream.
+    assert.ok(result.length < zlib.gzipSync(input).length * 1.1);
+  });
+}
+
+// One large write, more blocks than threads.
+gzipStream({ parallel: 2, level: 1 }, [input], (gzip, result) => {
+  assert.deepStrictEqual(zlib.gunzipSync(result), input);
+});
+
+// Empty input.
+gzipStream({ parallel: 2 }, [], (gzip, result) => {
+  assert.strictEqual(zlib.gunzipSync(result).length, 0);
+});
+
+// Convenience methods.
+zlib.gzip(input, { parallel: 3 }, common.mustCall((err, result) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(zlib.gunzipSync(result), input);
+}));
+assert.deepStrictEqual(
+  zlib.gunzipSync(zlib.gzipSync(input, { parallel: 3 })), input);
+
+// Flushing emits everything that was written so far.
+{
+  const gzip = zlib.createGzip({ parallel: 2 });
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+  gzip.write(input.slice(0, 300000));
+  gzip.flush(Z_SYNC_FLUSH, common.mustCall(() => {
+    const partial = zlib.gunzipSync(Buffer.concat(out),
+                                    { finishFlush: Z_SYNC_FLUSH });
+    assert.deepStrictEqual(partial, input.slice(0, 300000));
+
+    // Changing the parameters applies to the following blocks.
+    gzip.params(9, zlib.constants.Z_FILTERED, common.mustCall(() => {
+      gzip.end(input.slice(300000));
+    }));
+  }));
+  gzip.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(out)), input);
+  }));
+}
+
+// Ending a stream that was already finished by a flush does nothing.
+{
+  const gzip = zlib.createGzip({ parallel: 2 });
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+  gzip.on('error', common.mustNotCall());
+  gzip.write(input.slice(0, 1000));
+  gzip.flush(Z_FINISH);
+  gzip.end();
+  gzip.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(out)),
+                           input.slice(0, 1000));
+  }));
+}
+
+// Input after the stream was finished is an error, not a crash.
+{
+  const gzip = zlib.createGzip({ parallel: 2 });
+  gzip.resume();
+  gzip.flush(Z_FINISH, common.mustCall(() => {
+    gzip.write('more');
+  }));
+  gzip.on('error', common.mustCall((err) => {
+    assert.strictEqual(err.code, 'Z_STREAM_ERROR');
+  }));
+}
@@ -0,0 +1,76 @@
+'use strict';
+// Chunks below `inlineThreshold` are processed on the main thread, larger
+// chunks on the threadpool. Both kinds of writes are counted.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const { writeStats } = process.binding('zlib');
+
+function getStats() {
+  return {
+    inlineWrites: writeStats[0],
+    inlineBytes: writeStats[1],
+    offloadedWrites: writeStats[2],
+    offloadedBytes: writeStats[3]
+  };
+}
+
+[-1, 1.5, '1024', null, Infinity].forEach((inlineThreshold) => {
+  common.expectsError(() => {
+    zlib.createDeflate({ inlineThreshold });
+  }, {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: RangeError
+  });
+});
+
+const small = Buffer.from(JSON.stringify({ id: 42, name: 'small response' }));
+const large = Buffer.alloc(64 * 1024, 'large ');
+
+{
+  const before = getStats();
+  const gzip = zlib.createGzip({ inlineThreshold: 1024 });
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+
+  // The write callback runs without a trip through the threadpool.
+  let called = false;
+  gzip.write(small, common.mustCall(() => {
+    called = true;
+  }));
+  gzip.flush(common.mustCall(() => {
+    assert.ok(called);
+    const stats = getStats();
+    assert.ok(stats.inlineWrites >= before.inlineWrites + 1);
+    assert.ok(stats.inlineBytes >= before.inlineBytes + small.length);
+
+    gzip.end(large);
+  }));
+
+  gzip.on('end', common.mustCall(() => {
+    const stats = getStats();
+    assert.ok(stats.offloadedWrites >= before.offloadedWrites + 1);
+    assert.ok(stats.offloadedBytes >= before.offloadedBytes + large.length);
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(out)),
+                           Buffer.concat([small, large]));
+  }));
+}
+
+// Decompressing inline with an output that is larger than chunkSize.
+{
+  const compressed = zlib.deflateSync(large);
+  assert.ok(compressed.length < 1024);
+  zlib.inflate(compressed, { inlineThreshold: 1024 },
+               common.mustCall((err, result) => {
+                 assert.ifError(err);
+                 assert.deepStrictEqual(result, large);
+               }));
+}
+
+// Errors are reported the same way as for offloaded writes.
+zlib.inflate(Buffer.from('not deflate data'), { inlineThreshold: 1024 },
+             common.mustCall((err) => {
+               assert.strictEqual(err.code, 'Z_DATA_ERROR');
+             }));
@@ -171,6 +171,7 @@ if (common.hasCrypto) { // eslint-disable-line crypto-check
 {
   const binding = process.binding('stream_wrap');
   testUninitialized(new binding.WriteWrap(), 'WriteWrap');
+  testUninitialized(new binding.SendFileWrap(), 'SendFileWrap');
 }
 
 {
@@ -0,0 +1,153 @@
+// Creates the V8 code cache of the built-in modules, see
+// src/node_code_cache.h, and writes it to a C++ source file that defines
+// node::code_cache::GetEntries() and GetVersionTag().
+//
+// Usage: node_mkcodecache <output.cc>
+
+#include "node_code_cache.h"
+#include "node_i18n.h"
+#include "node_javascript.h"
+#include "libplatform/libplatform.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <string>
+
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::TryCatch;
+using v8::UnboundScript;
+using v8::Value;
+
+// The configuration is not a script, and bootstrap_node.js is not compiled
+// as a module.
+static bool SkipNative(const char* id) {
+  return strcmp(id, "config") == 0 ||
+         strcmp(id, "internal/bootstrap_node") == 0;
+}
+
+
+static bool WriteCodeCache(FILE* file,
+                           Isolate* isolate,
+                           Local<Context> context) {
+  Local<Object> sources = Object::New(isolate);
+  node::DefineJavaScript(isolate, context, sources);
+  Local<v8::Array> ids =
+      sources->GetOwnPropertyNames(context).ToLocalChecked();
+
+  fprintf(file,
+          "// This file is generated by tools/code_cache/mkcodecache.cc.\n"
+          "// Do not edit.\n\n"
+          "#include \"node_code_cache.h\"\n\n"
+          "namespace node {\n"
+          "namespace code_cache {\n\n");
+
+  std::string entries;
+  for (uint32_t i = 0; i < ids->Length(); i++) {
+    Local<Value> id = ids->Get(context, i).ToLocalChecked();
+    node::Utf8Value id_value(isolate, id);
+    if (SkipNative(*id_value))
+      continue;
+
+    Local<String> code = node::WrapNativeSource(
+        isolate, sources->Get(context, id).ToLocalChecked().As<String>());
+    std::string filename = std::string(*id_value) + ".js";
+    ScriptOrigin origin(node::OneByteString(isolate, filename.c_str()));
+    ScriptCompiler::Source source(code, origin);
+    TryCatch try_catch(isolate);
+    Local<UnboundScript> script;
+    // Compile every function eagerly, so that the cache also covers the
+    // functions inside the module and not only its top-level wrapper.
+    if (!ScriptCompiler::CompileUnboundScript(
+            isolate, &source, ScriptCompiler::kProduceFullCodeCache)
+            .ToLocal(&script)) {
+      node::Utf8Value exception(isolate, try_catch.Exception());
+      fprintf(stderr, "%s: %s\n", filename.c_str(), *exception);
+      return false;
+    }
+    const ScriptCompiler::CachedData* cached_data = source.GetCachedData();
+    if (cached_data == nullptr)
+      continue;
+
+    std::string var = "data_" + std::to_string(i);
+    fprintf(file, "static const uint8_t %s[] = {\n", var.c_str());
+    for (int j = 0; j < cached_data->length; j++) {
+      fprintf(file, "%u,%s", cached_data->data[j], j % 32 == 31 ? "\n" : "");
+    }
+    fprintf(file, "\n};\n\n");
+    entries += "  { \"" + std::string(*id_value) + "\", " +
+               var + ", sizeof(" + var + ") },\n";
+  }
+
+  fprintf(file,
+          "static const Entry entries[] = {\n%s};\n\n"
+          "const Entry* GetEntries(size_t* count) {\n"
+          "  *count = sizeof(entries) / sizeof(entries[0]);\n"
+          "  return entries;\n"
+          "}\n\n"
+          "uint32_t GetVersionTag() {\n"
+          "  return %uu;\n"
+          "}\n\n"
+          "}  // namespace code_cache\n"
+          "}  // namespace node\n",
+          entries.c_str(),
+          ScriptCompiler::CachedDataVersionTag());
+  return ferror(file) == 0;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <output.cc>\n", argv[0]);
+    return 1;
+  }
+
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  if (!node::i18n::InitializeICUDirectory("")) {
+    fprintf(stderr, "%s: could not initialize ICU\n", argv[0]);
+    return 1;
+  }
+#endif
+
+  std::unique_ptr<v8::Platform> platform = v8::platform::NewDefaultPlatform();
+  v8::V8::InitializePlatform(platform.get());
+  v8::V8::Initialize();
+
+  std::unique_ptr<ArrayBuffer::Allocator> allocator(
+      ArrayBuffer::Allocator::NewDefaultAllocator());
+  Isolate::CreateParams params;
+  params.array_buffer_allocator = allocator.get();
+  Isolate* isolate = Isolate::New(params);
+
+  int exit_code = 1;
+  {
+    Isolate::Scope isolate_scope(isolate);
+    HandleScope handle_scope(isolate);
+    Local<Context> context = Context::New(isolate);
+    Context::Scope context_scope(context);
+
+    FILE* file = fopen(argv[1], "w");
+    if (file == nullptr) {
+      perror(argv[1]);
+    } else {
+      bool ok = WriteCodeCache(file, isolate, context);
+      if (fclose(file) != 0)
+        ok = false;
+      exit_code = ok ? 0 : 1;
+    }
+  }
+
+  isolate->Dispose();
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  return exit_code;
+}
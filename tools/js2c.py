@@ -175,14 +175,33 @@ namespace node {{
 
 {definitions}
 
+v8::Local<v8::String> MainSource(v8::Isolate* isolate) {{
+  return internal_bootstrap_node_value.ToStringChecked(isolate);
+}}
+
 v8::Local<v8::String> MainSource(Environment* env) {{
-  return internal_bootstrap_node_value.ToStringChecked(env->isolate());
+  return MainSource(env->isolate());
 }}
 
-void DefineJavaScript(Environment* env, v8::Local<v8::Object> target) {{
+// Keep in sync with NativeModule.wrapper in lib/internal/bootstrap_node.js.
+v8::Local<v8::String> WrapNativeSource(v8::Isolate* isolate,
+                                       v8::Local<v8::String> source) {{
+  v8::Local<v8::String> head = FIXED_ONE_BYTE_STRING(isolate,
+      "(function (exports, require, module, internalBinding, process) {{");
+  v8::Local<v8::String> tail = FIXED_ONE_BYTE_STRING(isolate, "\\n}});");
+  return v8::String::Concat(v8::String::Concat(head, source), tail);
+}}
+
+void DefineJavaScript(v8::Isolate* isolate,
+                      v8::Local<v8::Context> context,
+                      v8::Local<v8::Object> target) {{
   {initializers}
 }}
 
+void DefineJavaScript(Environment* env, v8::Local<v8::Object> target) {{
+  DefineJavaScript(env->isolate(), env->context(), target);
+}}
+
 }}  // namespace node
 """
 
@@ -213,9 +232,9 @@ static struct : public v8::String::ExternalStringResource {{
 """
 
 INITIALIZER = """\
-CHECK(target->Set(env->context(),
-                  {key}.ToStringChecked(env->isolate()),
-                  {value}.ToStringChecked(env->isolate())).FromJust());
+CHECK(target->Set(context,
+                  {key}.ToStringChecked(isolate),
+                  {value}.ToStringChecked(isolate)).FromJust());
 """
 
 DEPRECATED_DEPS = """\
@@ -0,0 +1,72 @@
+// Creates the startup snapshot of src/node_snapshot.h and writes it to a C++
+// source file that defines node::snapshot::GetBlob().
+//
+// Usage: node_mksnapshot <output.cc>
+
+#include "node_i18n.h"
+#include "node_snapshot.h"
+#include "libplatform/libplatform.h"
+#include "v8.h"
+
+#include <stdio.h>
+#include <memory>
+
+static int WriteBlob(FILE* file, const v8::StartupData& blob) {
+  fprintf(file,
+          "// This file is generated by tools/snapshot/node_mksnapshot.cc.\n"
+          "// Do not edit.\n\n"
+          "#include \"node_snapshot.h\"\n\n"
+          "namespace node {\n"
+          "namespace snapshot {\n\n"
+          "static const char blob_data[] = {\n");
+  for (int i = 0; i < blob.raw_size; i++) {
+    fprintf(file, "%d,%s", blob.data[i], i % 32 == 31 ? "\n" : "");
+  }
+  fprintf(file,
+          "\n};\n\n"
+          "static v8::StartupData blob = { blob_data, %d };\n\n"
+          "v8::StartupData* GetBlob() {\n"
+          "  return &blob;\n"
+          "}\n\n"
+          "}  // namespace snapshot\n"
+          "}  // namespace node\n",
+          blob.raw_size);
+  return ferror(file);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <output.cc>\n", argv[0]);
+    return 1;
+  }
+
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  if (!node::i18n::InitializeICUDirectory("")) {
+    fprintf(stderr, "%s: could not initialize ICU\n", argv[0]);
+    return 1;
+  }
+#endif
+
+  std::unique_ptr<v8::Platform> platform = v8::platform::NewDefaultPlatform();
+  v8::V8::InitializePlatform(platform.get());
+  v8::V8::Initialize();
+
+  v8::StartupData blob = node::snapshot::CreateBlob();
+  int exit_code = 1;
+  if (blob.data != nullptr) {
+    FILE* file = fopen(argv[1], "w");
+    if (file == nullptr) {
+      perror(argv[1]);
+    } else {
+      int err = WriteBlob(file, blob);
+      if (fclose(file) != 0)
+        err = 1;
+      exit_code = err == 0 ? 0 : 1;
+    }
+    delete[] blob.data;
+  }
+
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  return exit_code;
+}